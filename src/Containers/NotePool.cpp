@@ -12,6 +12,8 @@
 #include "NotePool.h"
 #include "../Misc/Allocator.h"
 #include "../Synth/SynthNote.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <cassert>
 #include <iostream>
@@ -45,10 +47,47 @@ const char *getStatus(int status)
 }
 
 NotePool::NotePool(void)
-    :needs_cleaning(0)
+    :needs_cleaning(0), nused(0), soff_valid(0), offmask(0)
 {
     memset(ndesc, 0, sizeof(ndesc));
     memset(sdesc, 0, sizeof(sdesc));
+    memset(soff, 0, sizeof(soff));
+    memset(notemask, 0, sizeof(notemask));
+}
+
+static uint64_t descBit(int desc_id)
+{
+    return (uint64_t)1 << desc_id;
+}
+
+//Rebuild all lookup tables from the descriptors
+void NotePool::reindex(void)
+{
+    nused = 0;
+    while(nused < POLYPHONY && ndesc[nused].status != 0)
+        nused++;
+
+    offmask = 0;
+    memset(notemask, 0, sizeof(notemask));
+    for(int i=0; i<nused; ++i) {
+        notemask[ndesc[i].note] |= descBit(i);
+        if(ndesc[i].off())
+            offmask |= descBit(i);
+    }
+}
+
+int NotePool::synthOffset(int desc_id)
+{
+    for(; soff_valid < desc_id; ++soff_valid)
+        soff[soff_valid+1] = soff[soff_valid] + ndesc[soff_valid].size;
+    return soff[desc_id];
+}
+
+void NotePool::setNote(int desc_id, note_t note)
+{
+    notemask[ndesc[desc_id].note] &= ~descBit(desc_id);
+    notemask[note]                |= descBit(desc_id);
+    ndesc[desc_id].note            = note;
 }
 
 bool NotePool::NoteDescriptor::playing(void) const
@@ -112,10 +151,8 @@ void NotePool::NoteDescriptor::makeUnsustainable(void)
 NotePool::activeNotesIter NotePool::activeNotes(NoteDescriptor &n)
 {
     const int off_d1 = &n-ndesc;
-    int off_d2 = 0;
     assert(off_d1 <= POLYPHONY);
-    for(int i=0; i<off_d1; ++i)
-        off_d2 += ndesc[i].size;
+    const int off_d2 = synthOffset(off_d1);
     return NotePool::activeNotesIter{sdesc+off_d2,sdesc+off_d2+n.size};
 }
 
@@ -127,14 +164,9 @@ bool NotePool::NoteDescriptor::operator==(NoteDescriptor nd)
 //return either the first unused descriptor or the last valid descriptor which
 //matches note/sendto
 static int getMergeableDescriptor(note_t note, uint8_t sendto, bool legato,
-        NotePool::NoteDescriptor *ndesc)
+        NotePool::NoteDescriptor *ndesc, int first_off)
 {
-    int desc_id;
-
-    for(desc_id = 0; desc_id != POLYPHONY; ++desc_id) {
-        if(ndesc[desc_id].off())
-            break;
-    }
+    int desc_id = first_off;
 
     if(desc_id != 0) {
         auto &nd = ndesc[desc_id-1];
@@ -163,6 +195,13 @@ NotePool::constActiveDescIter NotePool::activeDesc(void) const
     return constActiveDescIter{*this};
 }
 
+NotePool::noteDescIter NotePool::activeDesc(note_t note)
+{
+    cleanup();
+    const uint64_t used = nused == 64 ? ~(uint64_t)0 : descBit(nused) - 1;
+    return noteDescIter{*this, note, notemask[note] & used};
+}
+
 int NotePool::usedNoteDesc(void) const
 {
     if(needs_cleaning)
@@ -188,12 +227,20 @@ int NotePool::usedSynthDesc(void) const
 void NotePool::insertNote(note_t note, uint8_t sendto, SynthDescriptor desc, bool legato)
 {
     //Get first free note descriptor
-    int desc_id = getMergeableDescriptor(note, sendto, legato, ndesc);
+    const int first_off = offmask ? __builtin_ctzll(offmask) : nused;
+    int desc_id = getMergeableDescriptor(note, sendto, legato, ndesc,
+                                         first_off);
     int sdesc_id = 0;
     if(desc_id < 0)
         goto error;
 
-    //Get first free synth descriptor
+    //Get first free synth descriptor, without any dead ones the synth
+    //descriptors are packed and the first free one follows the last note
+    if(!needs_cleaning) {
+        const int packed_end = synthOffset(nused);
+        if(packed_end < POLYPHONY*EXPECTED_USAGE && sdesc[packed_end].note == 0)
+            sdesc_id = packed_end;
+    }
     while(1) {
         if (sdesc_id == POLYPHONY*EXPECTED_USAGE)
                 goto error;
@@ -202,13 +249,24 @@ void NotePool::insertNote(note_t note, uint8_t sendto, SynthDescriptor desc, boo
         sdesc_id++;
     }
 
-    ndesc[desc_id].note         = note;
+    setNote(desc_id, note);
     ndesc[desc_id].sendto       = sendto;
     ndesc[desc_id].size        += 1;
     ndesc[desc_id].status       = KEY_PLAYING;
     ndesc[desc_id].legatoMirror = legato;
 
     sdesc[sdesc_id] = desc;
+
+    //Update the lookup tables, appending a new descriptor or growing the
+    //last one are the common cases
+    offmask &= ~descBit(desc_id);
+    if(soff_valid > desc_id)
+        soff_valid = desc_id;
+    if(desc_id == nused
+            && (nused+1 == POLYPHONY || ndesc[nused+1].status == 0))
+        nused++;
+    else if(desc_id != nused-1)
+        reindex();
     return;
 error:
     //Avoid leaking note
@@ -240,7 +298,7 @@ void NotePool::insertLegatoNote(note_t note, uint8_t sendto, SynthDescriptor des
 void NotePool::applyLegato(note_t note, const LegatoParams &par)
 {
     for(auto &desc:activeDesc()) {
-        desc.note = note;
+        setNote(&desc-ndesc, note);
         for(auto &synth:activeNotes(desc))
             try {
                 synth.note->legatonote(par);
@@ -252,19 +310,24 @@ void NotePool::applyLegato(note_t note, const LegatoParams &par)
 
 void NotePool::makeUnsustainable(note_t note)
 {
-    for(auto &desc:activeDesc()) {
-        if(desc.note == note) {
-            desc.makeUnsustainable();
-            if(desc.sustained())
-                release(desc);
-        }
+    for(auto &desc:activeDesc(note)) {
+        desc.makeUnsustainable();
+        if(desc.sustained())
+            release(desc);
     }
 }
 
 bool NotePool::full(void) const
+{
+    //all descriptors before nused are in use unless marked in offmask and
+    //the one at nused is free
+    return nused == POLYPHONY && !offmask;
+}
+
+bool NotePool::empty(void) const
 {
     for(int i=0; i<POLYPHONY; ++i)
-        if(ndesc[i].off())
+        if(ndesc[i].size)
             return false;
     return true;
 }
@@ -425,6 +488,25 @@ void NotePool::limitVoice(int preferred_note)
     }
 }
 
+NotePool::NoteDescriptor *NotePool::quietestVoice(float &level)
+{
+    NoteDescriptor *quietest = NULL;
+    level = 0.0f;
+    for(auto &nd : activeDesc()) {
+        if(nd.entombed() || nd.off())
+            continue;
+        float amp = 0.0f;
+        for(auto &s:activeNotes(nd))
+            amp = std::max(amp, fabsf(s.note->amplitude()));
+        if(!quietest || amp < level
+                || (amp == level && nd.age > quietest->age)) {
+            quietest = &nd;
+            level    = amp;
+        }
+    }
+    return quietest;
+}
+
 void NotePool::enforceVoiceLimit(int limit, int preferred_note)
 {
     int notes_to_kill = getRunningVoices() - limit;
@@ -473,10 +555,8 @@ void NotePool::killAllNotes(void)
 
 void NotePool::killNote(note_t note)
 {
-    for(auto &d:activeDesc()) {
-        if(d.note == note)
-            kill(d);
-    }
+    for(auto &d:activeDesc(note))
+        kill(d);
 }
 
 void NotePool::kill(NoteDescriptor &d)
@@ -484,6 +564,16 @@ void NotePool::kill(NoteDescriptor &d)
     d.setStatus(KEY_OFF);
     for(auto &s:activeNotes(d))
         kill(s);
+
+    const int desc_id = &d-ndesc;
+    if(desc_id >= nused)
+        return;
+    if(d.status != 0)
+        offmask |= descBit(desc_id);
+    else if(desc_id == nused-1)
+        nused--;
+    else
+        reindex(); //the active range ends here now
 }
 
 void NotePool::kill(SynthDescriptor &s)
@@ -555,6 +645,9 @@ void NotePool::cleanup(void)
                 sdesc[cum_new++] = sdesc[i];
         memset(sdesc+cum_new, 0, sizeof(*sdesc)*(POLYPHONY*EXPECTED_USAGE-cum_new));
     }
+
+    soff_valid = 0;
+    reindex();
     //printf("Cleanup Done\n");
     //dump();
 }
@@ -17,6 +17,8 @@
 //Expected upper bound of synths given that max polyphony is hit
 #define EXPECTED_USAGE 3
 
+static_assert(POLYPHONY <= 64, "NotePool indexes descriptors with 64 bit masks");
+
 namespace zyn {
 
 typedef uint8_t note_t; //Global MIDI note definition
@@ -82,11 +84,7 @@ class NotePool
         struct activeDescIter {
             activeDescIter(NotePool &_np):np(_np)
             {
-                int off=0;
-                for(int i=0; i<POLYPHONY; ++i, ++off)
-                    if(np.ndesc[i].status == 0)
-                        break;
-                _end = np.ndesc+off;
+                _end = np.ndesc+np.nused;
             }
             NoteDescriptor *begin() {return np.ndesc;};
             NoteDescriptor *end() { return _end; };
@@ -97,11 +95,7 @@ class NotePool
         struct constActiveDescIter {
             constActiveDescIter(const NotePool &_np):np(_np)
             {
-                int off=0;
-                for(int i=0; i<POLYPHONY; ++i, ++off)
-                    if(np.ndesc[i].status == 0)
-                        break;
-                _end = np.ndesc+off;
+                _end = np.ndesc+np.nused;
             }
             const NoteDescriptor *begin() const {return np.ndesc;};
             const NoteDescriptor *end() const { return _end; };
@@ -109,10 +103,39 @@ class NotePool
             const NotePool &np;
         };
 
+        //Active descriptors of one MIDI note, in pool order
+        struct noteDescIter {
+            struct iterator {
+                NotePool &np;
+                note_t    note;
+                uint64_t  mask;
+                NoteDescriptor &operator*() {
+                    return np.ndesc[__builtin_ctzll(mask)];
+                }
+                iterator &operator++() {
+                    mask &= mask-1;
+                    skip();
+                    return *this;
+                }
+                bool operator!=(const iterator &o) const {return mask != o.mask;}
+                //descriptors may change their note while iterating
+                void skip() {
+                    while(mask && np.ndesc[__builtin_ctzll(mask)].note != note)
+                        mask &= mask-1;
+                }
+            };
+            iterator begin() {iterator it{np, note, mask}; it.skip(); return it;}
+            iterator end() {return iterator{np, note, 0};}
+            NotePool &np;
+            note_t    note;
+            uint64_t  mask;
+        };
+
         activeNotesIter activeNotes(NoteDescriptor &n);
 
         activeDescIter activeDesc(void);
         constActiveDescIter activeDesc(void) const;
+        noteDescIter activeDesc(note_t note);
 
         //Counts of descriptors used for tests
         int usedNoteDesc(void) const;
@@ -132,6 +155,8 @@ class NotePool
         void releaseLatched();
 
         bool full(void) const;
+        //No note descriptor holds any synth notes
+        bool empty(void) const;
         bool synthFull(int sdesc_count) const;
 
         //Note that isn't KEY_PLAYING or KEY_RELEASED_AND_SUSTAINING
@@ -141,6 +166,9 @@ class NotePool
         int getRunningVoices(void) const;
         void enforceVoiceLimit(int limit, int preferred_note);
         void limitVoice(int preferred_note);
+        //Voice with the lowest amplitude (the oldest among equals) which is
+        //not already entombed, NULL if there is none
+        NoteDescriptor *quietestVoice(float &level);
 
         void releasePlayingNotes(void);
         void releaseNote(note_t note);
@@ -157,6 +185,24 @@ class NotePool
         void cleanup(void);
 
         void dump(void);
+
+    private:
+        //Lookup tables over ndesc/sdesc, kept up to date by the operations
+        //above so that handling an event does not need to scan the pool.
+        //Descriptors before nused are active (nonzero status).
+        int      nused;
+        //Offset of the synth descriptors of each note descriptor, computed
+        //lazily up to and including soff_valid
+        uint16_t soff[POLYPHONY+1];
+        int      soff_valid;
+        //Bit i is set when descriptor i may hold the note
+        uint64_t notemask[256];
+        //Active descriptors with an off status (killed, not yet cleaned up)
+        uint64_t offmask;
+
+        void reindex(void);
+        int synthOffset(int desc_id);
+        void setNote(int desc_id, note_t note);
 };
 
 }
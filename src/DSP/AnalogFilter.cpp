@@ -16,6 +16,7 @@
 #include <cstring> //memcpy
 #include <cmath>
 #include <cassert>
+#include <algorithm>
 
 #include "../Misc/Util.h"
 #include "AnalogFilter.h"
@@ -358,8 +359,6 @@ inline void AnalogBiquadFilterB(const float coeff[5], float &src, float work[4])
 
 void AnalogFilter::singlefilterout(float *smp, fstage &hist, float f, unsigned int bufsize)
 {
-    assert((buffersize % 8) == 0);
-
     if ( recompute )
     {
         computefiltercoefs(f,q);
@@ -377,7 +376,8 @@ void AnalogFilter::singlefilterout(float *smp, fstage &hist, float f, unsigned i
     } else if(order == 2) {//Second order filter
         const float coeff_[5] = {coeff.c[0], coeff.c[1], coeff.c[2],  coeff.d[1], coeff.d[2]};
         float work[4]  = {hist.x1, hist.x2, hist.y1, hist.y2};
-        for(unsigned int i = 0; i < bufsize; i+=8) {
+        unsigned int i = 0;
+        for(; i + 8 <= bufsize; i+=8) {
             AnalogBiquadFilterA(coeff_, smp[i + 0], work);
             AnalogBiquadFilterB(coeff_, smp[i + 1], work);
             AnalogBiquadFilterA(coeff_, smp[i + 2], work);
@@ -387,6 +387,18 @@ void AnalogFilter::singlefilterout(float *smp, fstage &hist, float f, unsigned i
             AnalogBiquadFilterA(coeff_, smp[i + 6], work);
             AnalogBiquadFilterB(coeff_, smp[i + 7], work);
         }
+        //The A and B steps swap the roles of the history slots, so a
+        //remainder of odd length leaves them swapped
+        for(; i < bufsize; ++i) {
+            if(i % 2 == 0)
+                AnalogBiquadFilterA(coeff_, smp[i], work);
+            else
+                AnalogBiquadFilterB(coeff_, smp[i], work);
+        }
+        if(bufsize % 2) {
+            std::swap(work[0], work[1]);
+            std::swap(work[2], work[3]);
+        }
         hist.x1 = work[0];
         hist.x2 = work[1];
         hist.y1 = work[2];
@@ -394,28 +406,31 @@ void AnalogFilter::singlefilterout(float *smp, fstage &hist, float f, unsigned i
     }
 }
 
-void AnalogFilter::filterout(float *smp)
+void AnalogFilter::filterout(float *smp, int nsamples)
 {
-    float freqbuf[freqbufsize];
+    //One frequency per 8 samples, the last block may be shorter
+    const int nfreqs = (nsamples + 7) / 8;
+    float freqbuf[freqbufsize + 1];
 
-    if ( freq_smoothing.apply( freqbuf, freqbufsize, freq ) )
+    if ( freq_smoothing.apply( freqbuf, nfreqs, freq ) )
     {
         /* in transition, need to do fine grained interpolation */
         for(int i = 0; i < stages + 1; ++i)
-            for(int j = 0; j < freqbufsize; ++j)
+            for(int j = 0; j < nfreqs; ++j)
             {
                 recompute = true;
-                singlefilterout(&smp[j*8], history[i], freqbuf[j], 8);
+                singlefilterout(&smp[j*8], history[i], freqbuf[j],
+                                std::min(8, nsamples - j*8));
             }
     }
     else
     {
         /* stable state, just use one coeff */
         for(int i = 0; i < stages + 1; ++i)
-            singlefilterout(smp, history[i], freq, buffersize);
+            singlefilterout(smp, history[i], freq, nsamples);
     }
 
-    for(int i = 0; i < buffersize; ++i)
+    for(int i = 0; i < nsamples; ++i)
         smp[i] *= outgain;
 }
 
@@ -31,7 +31,7 @@ class AnalogFilter:public Filter
         AnalogFilter(unsigned char Ftype, float Ffreq, float Fq,
                      unsigned char Fstages, unsigned int srate, int bufsize);
         ~AnalogFilter();
-        void filterout(float *smp);
+        void filterout(float *smp, int nsamples);
         void setfreq(float frequency);
         void setfreq_and_q(float frequency, float q_);
         void setq(float q_);
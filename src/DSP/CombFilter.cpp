@@ -16,8 +16,7 @@ CombFilter::CombFilter(Allocator *alloc, unsigned char Ftype, float Ffreq, float
     unsigned int srate, int bufsize)
     :Filter(srate, bufsize), gain(1.0f), type(Ftype), memory(*alloc)
 {
-    //worst case: looking back from smps[0] at 25Hz using higher order interpolation
-    mem_size = (int)ceilf((float)samplerate/25.0) + buffersize + 2; // 2178 at 48000Hz and 256Samples
+    mem_size = memorySize(srate, bufsize);
     input = (float*)memory.alloc_mem(mem_size*sizeof(float));
     output = (float*)memory.alloc_mem(mem_size*sizeof(float));
     memset(input, 0, mem_size*sizeof(float));
@@ -27,6 +26,12 @@ CombFilter::CombFilter(Allocator *alloc, unsigned char Ftype, float Ffreq, float
     settype(type);
 }
 
+int CombFilter::memorySize(unsigned int srate, int bufsize)
+{
+    //worst case: looking back from smps[0] at 25Hz using higher order interpolation
+    return (int)ceilf((float)srate/25.0) + bufsize + 2; // 2178 at 48000Hz and 256Samples
+}
+
 CombFilter::~CombFilter(void)
 {
     memory.dealloc(input);
@@ -49,27 +54,28 @@ inline float CombFilter::sampleLerp(float *smp, float pos) {
     return smp[poshi] + poslo * (smp[poshi+1]-smp[poshi]); 
 }
 
-void CombFilter::filterout(float *smp)
+void CombFilter::filterout(float *smp, int nsamples)
 {
     // shift the buffer content to the left
-    memmove(&input[0], &input[buffersize], (mem_size-buffersize)*sizeof(float));
+    memmove(&input[0], &input[nsamples], (mem_size-nsamples)*sizeof(float));
     // copy new input samples to the right end of the buffer
-    memcpy(&input[mem_size-buffersize], smp, buffersize*sizeof(float));
-    for (int i = 0; i < buffersize; i ++)
+    memcpy(&input[mem_size-nsamples], smp, nsamples*sizeof(float));
+    // shift the output the same way, so both buffers end at the sample
+    // before this call (the length of the calls may vary)
+    memmove(&output[0], &output[nsamples], (mem_size-nsamples)*sizeof(float));
+    for (int i = 0; i < nsamples; i ++)
     {
         // calculate the feedback sample positions in the buffer
-        float pos = float(mem_size-buffersize+i)-delay;
+        float pos = float(mem_size-nsamples+i)-delay;
         // add the fwd and bwd feedback samples to current sample
         smp[i] = smp[i]*gain + tanhX(
             gainfwd * sampleLerp( input, pos) - 
             gainbwd * sampleLerp(output, pos)); 
         // copy new sample to output buffer
-        output[mem_size-buffersize+i] = smp[i];
+        output[mem_size-nsamples+i] = smp[i];
         // apply output gain
         smp[i] *= outgain;
     }
-    // shift the buffer content one buffersize to the left
-    memmove(&output[0], &output[buffersize], (mem_size-buffersize)*sizeof(float));
 }
 
 void CombFilter::setfreq_and_q(float freq, float q)
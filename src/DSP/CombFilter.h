@@ -24,7 +24,9 @@ class CombFilter:public Filter
         CombFilter(Allocator *alloc, unsigned char Ftype, float Ffreq, float Fq,
                 unsigned int srate, int bufsize);
         ~CombFilter() override;
-        void filterout(float *smp) override;
+        //! length of the input and output histories
+        static int memorySize(unsigned int srate, int bufsize);
+        void filterout(float *smp, int nsamples) override;
         void setfreq(float freq) override;
         void setfreq_and_q(float freq, float q_) override;
         void setq(float q) override;
@@ -0,0 +1,131 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  Denormal.cpp - Protection against denormal numbers in the audio path
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include "Denormal.h"
+
+#if defined(__SSE__) || defined(__x86_64__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define DENORMAL_SSE
+//MXCSR flush-to-zero and denormals-are-zero bits
+#define DENORMAL_FTZ 0x8000
+#ifdef __x86_64__
+#define DENORMAL_DAZ 0x0040
+#else
+//DAZ is missing on the first SSE CPUs, setting it there would fault
+#define DENORMAL_DAZ 0
+#endif
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_FP))
+#define DENORMAL_ARM
+//FPCR/FPSCR flush-to-zero bit
+#define DENORMAL_FZ (1ul << 24)
+#endif
+
+namespace zyn {
+namespace denormal {
+
+static unsigned long getMode(void)
+{
+#if defined(DENORMAL_SSE)
+    return _mm_getcsr();
+#elif defined(DENORMAL_ARM) && defined(__aarch64__)
+    unsigned long fpcr;
+    __asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+    return fpcr;
+#elif defined(DENORMAL_ARM)
+    unsigned int fpscr;
+    __asm__ volatile("vmrs %0, fpscr" : "=r"(fpscr));
+    return fpscr;
+#else
+    return 0;
+#endif
+}
+
+static void setMode(unsigned long mode)
+{
+#if defined(DENORMAL_SSE)
+    _mm_setcsr((unsigned int)mode);
+#elif defined(DENORMAL_ARM) && defined(__aarch64__)
+    __asm__ volatile("msr fpcr, %0" : : "r"(mode));
+#elif defined(DENORMAL_ARM)
+    __asm__ volatile("vmsr fpscr, %0" : : "r"((unsigned int)mode));
+#else
+    (void)mode;
+#endif
+}
+
+static unsigned long flushMode(unsigned long mode)
+{
+#if defined(DENORMAL_SSE)
+    return mode | DENORMAL_FTZ | DENORMAL_DAZ;
+#elif defined(DENORMAL_ARM)
+    return mode | DENORMAL_FZ;
+#else
+    return mode;
+#endif
+}
+
+#if defined(DENORMAL_SSE) || defined(DENORMAL_ARM)
+static Policy current = POLICY_FLUSH;
+#else
+static Policy current = POLICY_NOISE;
+#endif
+
+bool flushSupported(void)
+{
+#if defined(DENORMAL_SSE) || defined(DENORMAL_ARM)
+    return true;
+#else
+    return false;
+#endif
+}
+
+Policy policy(void)
+{
+    return current;
+}
+
+void setPolicy(Policy p)
+{
+    current = (p == POLICY_FLUSH && !flushSupported()) ? POLICY_NOISE : p;
+}
+
+const char *policyName(Policy p)
+{
+    return p == POLICY_FLUSH ? "flush" : "noise";
+}
+
+void flushThread(void)
+{
+    if(current == POLICY_FLUSH)
+        setMode(flushMode(getMode()));
+}
+
+ScopedFlush::ScopedFlush(void)
+    :saved(0), active(current == POLICY_FLUSH)
+{
+    if(!active)
+        return;
+    saved = getMode();
+    const unsigned long mode = flushMode(saved);
+    if(mode == saved)
+        active = false; //already flushing, e.g. set by the host
+    else
+        setMode(mode);
+}
+
+ScopedFlush::~ScopedFlush(void)
+{
+    if(active)
+        setMode(saved);
+}
+
+}
+}
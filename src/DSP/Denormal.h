@@ -0,0 +1,63 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  Denormal.h - Protection against denormal numbers in the audio path
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#pragma once
+
+namespace zyn {
+
+/**
+ * Decaying feedback paths (reverbs, echos, filters) end up computing with
+ * denormal numbers, which are very slow on most CPUs.
+ *
+ * POLICY_FLUSH sets the flush-to-zero (and where available the
+ * denormals-are-zero) mode of the FPU on every thread computing audio.
+ * This protects all paths, including the feedback inside the effects.
+ *
+ * POLICY_NOISE is the classic approach: SYNTH_T::denormalkillbuf holds
+ * tiny noise which is mixed into the note and effect inputs. It is used
+ * on CPUs without a flush mode.
+ *
+ * The policy is process wide and has to be chosen before SYNTH_T::alias()
+ * builds the noise buffer.
+ */
+namespace denormal {
+
+enum Policy {
+    POLICY_NOISE,
+    POLICY_FLUSH
+};
+
+//Policy in effect
+Policy policy(void);
+//Select a policy, POLICY_FLUSH falls back to noise if it is not supported
+void setPolicy(Policy p);
+bool flushSupported(void);
+const char *policyName(Policy p);
+
+//Enable flushing on the calling thread for good (threads owned by zyn)
+void flushThread(void);
+
+/**Enables flushing for the lifetime of the object, if the policy asks for
+ * it, and restores the previous mode of the thread afterwards.
+ * Used where zyn is called from threads it does not own (audio callbacks
+ * of Nio or a plugin host).*/
+class ScopedFlush
+{
+    public:
+        ScopedFlush(void);
+        ~ScopedFlush(void);
+    private:
+        unsigned long saved;
+        bool          active;
+};
+
+}
+}
@@ -13,82 +13,229 @@
 
 #include <cmath>
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <stdint.h>
 #include <pthread.h>
+#include <unistd.h>
+#include <fftw3.h>
 #include "FFTwrapper.h"
+#include "MixKernels.h"
+
+#if ZYN_FLOAT_FFT
+#define FFTW(x) fftwf_##x
+#define FFTW_PRECISION "float"
+#else
+#define FFTW(x) fftw_##x
+#define FFTW_PRECISION "double"
+#endif
 
 namespace zyn {
 
+typedef FFTW(plan)    fftw_plan_t;
+typedef FFTW(complex) fftw_complex_t;
+
 static pthread_mutex_t *mutex = NULL;
 
-FFTwrapper::FFTwrapper(int fftsize_)
+static void lock(void)
 {
     //first one will spawn the mutex (yeah this may be a race itself)
     if(!mutex) {
         mutex = new pthread_mutex_t;
         pthread_mutex_init(mutex, NULL);
     }
+    pthread_mutex_lock(mutex);
+}
+
+/*
+ * Plans of one size, shared by all wrappers of that size.
+ * They are made for buffers from fftw_malloc() and run on the buffers of
+ * each wrapper with the new-array execute functions, which FFTW allows as
+ * all such buffers have the same alignment. Executing is thread safe,
+ * making and destroying plans is done under the mutex.
+ */
+struct FFTplan
+{
+    int         size;
+    int         users;
+    fftw_plan_t forward, inverse;
+    FFTplan    *next;
+};
+
+static FFTplan *plans = NULL;
+
+/*
+ * Measured plans are only used when the wisdom has them (see fft::measure),
+ * otherwise the plans are estimated: measuring a big transform takes
+ * seconds and would stall patch loading.
+ */
+static fftw_plan_t planForward(int size, fftw_real *time, fft_t *fft)
+{
+    fftw_plan_t p = FFTW(plan_dft_r2c_1d)(size, time, (fftw_complex_t *)fft,
+                                          FFTW_MEASURE | FFTW_WISDOM_ONLY);
+    if(!p)
+        p = FFTW(plan_dft_r2c_1d)(size, time, (fftw_complex_t *)fft,
+                                  FFTW_ESTIMATE);
+    return p;
+}
 
+static fftw_plan_t planInverse(int size, fftw_real *time, fft_t *fft)
+{
+    fftw_plan_t p = FFTW(plan_dft_c2r_1d)(size, (fftw_complex_t *)fft, time,
+                                          FFTW_MEASURE | FFTW_WISDOM_ONLY);
+    if(!p)
+        p = FFTW(plan_dft_c2r_1d)(size, (fftw_complex_t *)fft, time,
+                                  FFTW_ESTIMATE);
+    return p;
+}
 
+FFTwrapper::FFTwrapper(int fftsize_)
+{
     fftsize  = fftsize_;
-    time     = new fftw_real[fftsize];
-    fft      = new fftw_complex[fftsize + 1];
-    pthread_mutex_lock(mutex);
-    planfftw = fftw_plan_dft_r2c_1d(fftsize,
-                                    time,
-                                    fft,
-                                    FFTW_ESTIMATE);
-    planfftw_inv = fftw_plan_dft_c2r_1d(fftsize,
-                                        fft,
-                                        time,
-                                        FFTW_ESTIMATE);
+    time     = (fftw_real *)FFTW(malloc)(fftsize * sizeof(fftw_real));
+    fft      = (fft_t *)FFTW(malloc)((fftsize + 1) * sizeof(fft_t));
+    lock();
+    for(plan = plans; plan && plan->size != fftsize; plan = plan->next);
+    if(!plan) {
+        plan          = new FFTplan;
+        plan->size    = fftsize;
+        plan->users   = 0;
+        plan->forward = planForward(fftsize, time, fft);
+        plan->inverse = planInverse(fftsize, time, fft);
+        plan->next    = plans;
+        plans         = plan;
+    }
+    plan->users++;
     pthread_mutex_unlock(mutex);
 }
 
 FFTwrapper::~FFTwrapper()
 {
-    pthread_mutex_lock(mutex);
-    fftw_destroy_plan(planfftw);
-    fftw_destroy_plan(planfftw_inv);
+    lock();
+    if(--plan->users == 0) {
+        FFTplan **p = &plans;
+        while(*p != plan)
+            p = &(*p)->next;
+        *p = plan->next;
+        FFTW(destroy_plan)(plan->forward);
+        FFTW(destroy_plan)(plan->inverse);
+        delete plan;
+    }
     pthread_mutex_unlock(mutex);
 
-    delete [] time;
-    delete [] fft;
+    FFTW(free)(time);
+    FFTW(free)(fft);
 }
 
 void FFTwrapper::smps2freqs(const float *smps, fft_t *freqs)
 {
     //Load data
     for(int i = 0; i < fftsize; ++i)
-        time[i] = static_cast<double>(smps[i]);
+        time[i] = static_cast<fftw_real>(smps[i]);
 
     //DFT
-    fftw_execute(planfftw);
+    FFTW(execute_dft_r2c)(plan->forward, time, (fftw_complex_t *)fft);
 
     //Grab data
-    memcpy((void *)freqs, (const void *)fft, fftsize * sizeof(double));
+    memcpy((void *)freqs, (const void *)fft, fftsize / 2 * sizeof(fft_t));
 }
 
 void FFTwrapper::freqs2smps(const fft_t *freqs, float *smps)
 {
     //Load data
-    memcpy((void *)fft, (const void *)freqs, fftsize * sizeof(double));
+    memcpy((void *)fft, (const void *)freqs, fftsize / 2 * sizeof(fft_t));
 
     //clear unused freq channel
-    fft[fftsize / 2][0] = 0.0f;
-    fft[fftsize / 2][1] = 0.0f;
+    fft[fftsize / 2] = 0.0f;
 
     //IDFT
-    fftw_execute(planfftw_inv);
+    FFTW(execute_dft_c2r)(plan->inverse, (fftw_complex_t *)fft, time);
 
     //Grab data
     for(int i = 0; i < fftsize; ++i)
         smps[i] = static_cast<float>(time[i]);
 }
 
+namespace fft {
+
+std::string wisdomFile(void)
+{
+    //The home directory, else the working directory as for the PADsynth
+    //cache (see padcache::directory())
+    const char *home = getenv("HOME");
+    const std::string dir = home ? home : ".";
+    if(access(dir.c_str(), X_OK))
+        return "";
+
+    //FFTW wisdom is only valid for the machine that measured it
+    std::string cpu;
+#ifdef __linux__
+    if(FILE *f = fopen("/proc/cpuinfo", "r")) {
+        char line[256];
+        while(fgets(line, sizeof(line), f))
+            if(!strncmp(line, "model name", 10)) {
+                cpu = line;
+                break;
+            }
+        fclose(f);
+    }
+#endif
+    uint32_t hash = 2166136261U; //FNV-1a
+    for(char c : cpu)
+        hash = (hash ^ (unsigned char)c) * 16777619U;
+
+    mix::Isa best = mix::ISA_SCALAR;
+    for(int i = mix::ISA_SCALAR + 1; i < mix::ISA_COUNT; ++i)
+        if(mix::supported((mix::Isa)i))
+            best = (mix::Isa)i;
+
+    char name[512] = {};
+    snprintf(name, sizeof(name), "%s/.zynaddsubfx-fftw-" FFTW_PRECISION
+             "-%s-%08x.wisdom", dir.c_str(), mix::isaName(best),
+             (unsigned)hash);
+    return name;
+}
+
+bool loadWisdom(const std::string &file)
+{
+    if(file.empty())
+        return false;
+    lock();
+    const bool ok = FFTW(import_wisdom_from_filename)(file.c_str());
+    pthread_mutex_unlock(mutex);
+    return ok;
+}
+
+bool saveWisdom(const std::string &file)
+{
+    if(file.empty())
+        return false;
+    lock();
+    const bool ok = FFTW(export_wisdom_to_filename)(file.c_str());
+    pthread_mutex_unlock(mutex);
+    return ok;
+}
+
+void measure(int size)
+{
+    fftw_real *time = (fftw_real *)FFTW(malloc)(size * sizeof(fftw_real));
+    fft_t     *fft  = (fft_t *)FFTW(malloc)((size + 1) * sizeof(fft_t));
+    lock();
+    FFTW(destroy_plan)(FFTW(plan_dft_r2c_1d)(size, time,
+                (fftw_complex_t *)fft, FFTW_MEASURE));
+    FFTW(destroy_plan)(FFTW(plan_dft_c2r_1d)(size, (fftw_complex_t *)fft,
+                time, FFTW_MEASURE));
+    pthread_mutex_unlock(mutex);
+    FFTW(free)(time);
+    FFTW(free)(fft);
+}
+
+}
+
 void FFT_cleanup()
 {
-    fftw_cleanup();
+    FFTW(cleanup)();
     pthread_mutex_destroy(mutex);
     delete mutex;
     mutex = NULL;
@@ -13,13 +13,20 @@
 
 #ifndef FFT_WRAPPER_H
 #define FFT_WRAPPER_H
-#include <fftw3.h>
 #include <complex>
+#include <string>
 #include "../globals.h"
 
 namespace zyn {
 
-/**A wrapper for the FFTW library (Fast Fourier Transforms)*/
+struct FFTplan;
+
+/**A wrapper for the FFTW library (Fast Fourier Transforms)
+ *
+ * The transforms are done in double precision (fftw3), or in single
+ * precision (fftw3f) when built with ZYN_FLOAT_FFT, fftw_real and fft_t
+ * follow the choice. The FFTW plans are shared by all wrappers of the same
+ * size, each wrapper only owns its buffers.*/
 class FFTwrapper
 {
     public:
@@ -34,10 +41,10 @@ class FFTwrapper
         void smps2freqs(const float *smps, fft_t *freqs);
         void freqs2smps(const fft_t *freqs, float *smps);
     private:
-        int fftsize;
-        fftw_real    *time;
-        fftw_complex *fft;
-        fftw_plan     planfftw, planfftw_inv;
+        int        fftsize;
+        fftw_real *time;
+        fft_t     *fft;
+        FFTplan   *plan;
 };
 
 /*
@@ -61,6 +68,28 @@ FFTpolar(const _Tp& __rho, const _Tp& __theta = _Tp(0))
 
 void FFT_cleanup();
 
+/**
+ * FFTW wisdom: plans measured once (zynaddsubfx --fft-wisdom) and kept in
+ * a file in the home directory. Wrappers use the measured plans of the
+ * loaded wisdom and estimate plans for sizes it does not cover.
+ */
+namespace fft {
+
+//Wisdom file of this CPU and FFT precision, empty if there is no
+//directory to keep it in
+std::string wisdomFile(void);
+//Return false if the file could not be read or written (or is empty)
+bool loadWisdom(const std::string &file);
+bool saveWisdom(const std::string &file);
+//Measure the plans of a transform size and add them to the wisdom
+void measure(int size);
+
+//Sizes the engine transforms: oscillators and PADsynth samples
+const int MIN_SIZE = 256;
+const int MAX_SIZE = 1 << 20;
+
+}
+
 }
 
 #endif
@@ -73,6 +73,26 @@ Filter *Filter::generate(Allocator &memory, const FilterParams *pars,
     return filter;
 }
 
+size_t Filter::footprint(const FilterParams *pars,
+        unsigned int srate, int bufsize)
+{
+    switch(pars->Pcategory) {
+        case 1:
+            return NoteArena::footprint<FormantFilter>()
+                + pars->Pnumformants * NoteArena::footprint<AnalogFilter>();
+        case 2:
+            return NoteArena::footprint<SVFilter>();
+        case 3:
+            return NoteArena::footprint<MoogFilter>();
+        case 4:
+            return NoteArena::footprint<CombFilter>()
+                + 2 * NoteArena::footprint<float>(
+                        CombFilter::memorySize(srate, bufsize));
+        default:
+            return NoteArena::footprint<AnalogFilter>();
+    }
+}
+
 float Filter::getrealfreq(float freqpitch)
 {
     return powf(2.0f, freqpitch + 9.96578428f); //log2(1000)=9.95748f
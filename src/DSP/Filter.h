@@ -14,6 +14,7 @@
 #ifndef FILTER_H
 #define FILTER_H
 
+#include <cstddef>
 #include "../globals.h"
 
 namespace zyn {
@@ -24,10 +25,15 @@ class Filter
         static float getrealfreq(float freqpitch);
         static Filter *generate(Allocator &memory, const FilterParams *pars,
                 unsigned int srate, int bufsize);
+        //Bytes generate() takes from a NoteArena
+        static size_t footprint(const FilterParams *pars,
+                unsigned int srate, int bufsize);
 
         Filter(unsigned int srate, int bufsize);
         virtual ~Filter() {}
-        virtual void filterout(float *smp)    = 0;
+        /**Filter nsamples samples in place, at most the bufsize the
+         * filter was made for*/
+        virtual void filterout(float *smp, int nsamples) = 0;
         virtual void setfreq(float frequency) = 0;
         virtual void setfreq_and_q(float frequency, float q_) = 0;
         virtual void setq(float q_) = 0;
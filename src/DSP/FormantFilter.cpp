@@ -194,12 +194,12 @@ void FormantFilter::setfreq_and_q(float frequency, float q_)
 }
 
 
-void FormantFilter::filterout(float *smp)
+void FormantFilter::filterout(float *smp, int nsamples)
 {
     float inbuffer[buffersize];
 
-    memcpy(inbuffer, smp, bufferbytes);
-    memset(smp, 0, bufferbytes);
+    memcpy(inbuffer, smp, nsamples * sizeof(float));
+    memset(smp, 0, nsamples * sizeof(float));
 
     float formantbuf[buffersize];
 
@@ -207,19 +207,19 @@ void FormantFilter::filterout(float *smp)
 
         float tmpbuf[buffersize];
 
-        for(int i = 0; i < buffersize; ++i)
+        for(int i = 0; i < nsamples; ++i)
             tmpbuf[i] = inbuffer[i] * outgain;
 
-        formant[j]->filterout(tmpbuf);
+        formant[j]->filterout(tmpbuf, nsamples);
 
-        if ( formant_amp_smoothing[j].apply( formantbuf, buffersize, currentformants[j].amp ) )
+        if ( formant_amp_smoothing[j].apply( formantbuf, nsamples, currentformants[j].amp ) )
         {
-            for(int i = 0; i < buffersize; ++i)
+            for(int i = 0; i < nsamples; ++i)
                 smp[i] += tmpbuf[i] * formantbuf[i];
         }
         else
         {
-            for(int i = 0; i < buffersize; ++i)
+            for(int i = 0; i < nsamples; ++i)
                 smp[i] += tmpbuf[i] * currentformants[j].amp;
         }
     }
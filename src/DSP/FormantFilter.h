@@ -25,7 +25,7 @@ class FormantFilter:public Filter
     public:
         FormantFilter(const FilterParams *pars, Allocator *alloc, unsigned int srate, int bufsize);
         ~FormantFilter();
-        void filterout(float *smp);
+        void filterout(float *smp, int nsamples);
         void setfreq(float frequency);
         void setfreq_and_q(float frequency, float q_);
         void setq(float q_);
@@ -0,0 +1,361 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  MixKernels.cpp - Vectorized buffer mixing primitives
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include "MixKernels.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MIX_X86 1
+#include <immintrin.h>
+//Compile the vector versions regardless of the baseline -m flags, they
+//are only called after the CPU has been checked
+#define MIX_SSE2 __attribute__((target("sse2")))
+#define MIX_AVX2 __attribute__((target("avx2")))
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MIX_ARM 1
+#include <arm_neon.h>
+#endif
+
+namespace zyn {
+namespace mix {
+
+struct Kernels
+{
+    void (*add)(float *, const float *, int);
+    void (*addScaled)(float *, const float *, float, int);
+    void (*scale)(float *, float, int);
+    void (*scaleBuf)(float *, const float *, int);
+    void (*crossfade)(float *, const float *, float, float, int);
+};
+
+/*
+ * Scalar
+ */
+static void add_scalar(float *dst, const float *src, int n)
+{
+    for(int i = 0; i < n; ++i)
+        dst[i] += src[i];
+}
+
+static void addScaled_scalar(float *dst, const float *src, float gain, int n)
+{
+    for(int i = 0; i < n; ++i)
+        dst[i] += src[i] * gain;
+}
+
+static void scale_scalar(float *dst, float gain, int n)
+{
+    for(int i = 0; i < n; ++i)
+        dst[i] *= gain;
+}
+
+static void scaleBuf_scalar(float *dst, const float *gain, int n)
+{
+    for(int i = 0; i < n; ++i)
+        dst[i] *= gain[i];
+}
+
+static void crossfade_scalar(float *dst, const float *wet, float dry,
+                             float wetgain, int n)
+{
+    for(int i = 0; i < n; ++i)
+        dst[i] = dst[i] * dry + wet[i] * wetgain;
+}
+
+static const Kernels scalar_kernels = {
+    add_scalar, addScaled_scalar, scale_scalar, scaleBuf_scalar,
+    crossfade_scalar
+};
+
+#ifdef MIX_X86
+/*
+ * SSE2
+ */
+MIX_SSE2 static void add_sse2(float *dst, const float *src, int n)
+{
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i),
+                                          _mm_loadu_ps(src + i)));
+    add_scalar(dst + i, src + i, n - i);
+}
+
+MIX_SSE2 static void addScaled_sse2(float *dst, const float *src, float gain,
+                                    int n)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+        _mm_storeu_ps(dst + i,
+                _mm_add_ps(_mm_loadu_ps(dst + i),
+                           _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+    addScaled_scalar(dst + i, src + i, gain, n - i);
+}
+
+MIX_SSE2 static void scale_sse2(float *dst, float gain, int n)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(dst + i), g));
+    scale_scalar(dst + i, gain, n - i);
+}
+
+MIX_SSE2 static void scaleBuf_sse2(float *dst, const float *gain, int n)
+{
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(dst + i),
+                                          _mm_loadu_ps(gain + i)));
+    scaleBuf_scalar(dst + i, gain + i, n - i);
+}
+
+MIX_SSE2 static void crossfade_sse2(float *dst, const float *wet, float dry,
+                                    float wetgain, int n)
+{
+    const __m128 d = _mm_set1_ps(dry);
+    const __m128 w = _mm_set1_ps(wetgain);
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+        _mm_storeu_ps(dst + i,
+                _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(dst + i), d),
+                           _mm_mul_ps(_mm_loadu_ps(wet + i), w)));
+    crossfade_scalar(dst + i, wet + i, dry, wetgain, n - i);
+}
+
+static const Kernels sse2_kernels = {
+    add_sse2, addScaled_sse2, scale_sse2, scaleBuf_sse2, crossfade_sse2
+};
+
+/*
+ * AVX2 (no FMA, so results match the scalar code bit for bit)
+ */
+MIX_AVX2 static void add_avx2(float *dst, const float *src, int n)
+{
+    int i = 0;
+    for(; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i),
+                                                _mm256_loadu_ps(src + i)));
+    add_scalar(dst + i, src + i, n - i);
+}
+
+MIX_AVX2 static void addScaled_avx2(float *dst, const float *src, float gain,
+                                    int n)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    int i = 0;
+    for(; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(dst + i,
+                _mm256_add_ps(_mm256_loadu_ps(dst + i),
+                              _mm256_mul_ps(_mm256_loadu_ps(src + i), g)));
+    addScaled_scalar(dst + i, src + i, gain, n - i);
+}
+
+MIX_AVX2 static void scale_avx2(float *dst, float gain, int n)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    int i = 0;
+    for(; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(dst + i), g));
+    scale_scalar(dst + i, gain, n - i);
+}
+
+MIX_AVX2 static void scaleBuf_avx2(float *dst, const float *gain, int n)
+{
+    int i = 0;
+    for(; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(dst + i),
+                                                _mm256_loadu_ps(gain + i)));
+    scaleBuf_scalar(dst + i, gain + i, n - i);
+}
+
+MIX_AVX2 static void crossfade_avx2(float *dst, const float *wet, float dry,
+                                    float wetgain, int n)
+{
+    const __m256 d = _mm256_set1_ps(dry);
+    const __m256 w = _mm256_set1_ps(wetgain);
+    int i = 0;
+    for(; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(dst + i,
+                _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(dst + i), d),
+                              _mm256_mul_ps(_mm256_loadu_ps(wet + i), w)));
+    crossfade_scalar(dst + i, wet + i, dry, wetgain, n - i);
+}
+
+static const Kernels avx2_kernels = {
+    add_avx2, addScaled_avx2, scale_avx2, scaleBuf_avx2, crossfade_avx2
+};
+#endif
+
+#ifdef MIX_ARM
+/*
+ * NEON
+ */
+static void add_neon(float *dst, const float *src, int n)
+{
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+        vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vld1q_f32(src + i)));
+    add_scalar(dst + i, src + i, n - i);
+}
+
+static void addScaled_neon(float *dst, const float *src, float gain, int n)
+{
+    const float32x4_t g = vdupq_n_f32(gain);
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+        vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i),
+                                     vmulq_f32(vld1q_f32(src + i), g)));
+    addScaled_scalar(dst + i, src + i, gain, n - i);
+}
+
+static void scale_neon(float *dst, float gain, int n)
+{
+    const float32x4_t g = vdupq_n_f32(gain);
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+        vst1q_f32(dst + i, vmulq_f32(vld1q_f32(dst + i), g));
+    scale_scalar(dst + i, gain, n - i);
+}
+
+static void scaleBuf_neon(float *dst, const float *gain, int n)
+{
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+        vst1q_f32(dst + i, vmulq_f32(vld1q_f32(dst + i), vld1q_f32(gain + i)));
+    scaleBuf_scalar(dst + i, gain + i, n - i);
+}
+
+static void crossfade_neon(float *dst, const float *wet, float dry,
+                           float wetgain, int n)
+{
+    const float32x4_t d = vdupq_n_f32(dry);
+    const float32x4_t w = vdupq_n_f32(wetgain);
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+        vst1q_f32(dst + i, vaddq_f32(vmulq_f32(vld1q_f32(dst + i), d),
+                                     vmulq_f32(vld1q_f32(wet + i), w)));
+    crossfade_scalar(dst + i, wet + i, dry, wetgain, n - i);
+}
+
+static const Kernels neon_kernels = {
+    add_neon, addScaled_neon, scale_neon, scaleBuf_neon, crossfade_neon
+};
+#endif
+
+/*
+ * Dispatch
+ */
+bool supported(Isa isa)
+{
+    switch(isa) {
+        case ISA_SCALAR:
+            return true;
+#ifdef MIX_X86
+        case ISA_SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+        case ISA_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+#ifdef MIX_ARM
+        case ISA_NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+static const Kernels *kernelsFor(Isa isa)
+{
+    switch(isa) {
+#ifdef MIX_X86
+        case ISA_SSE2:
+            return &sse2_kernels;
+        case ISA_AVX2:
+            return &avx2_kernels;
+#endif
+#ifdef MIX_ARM
+        case ISA_NEON:
+            return &neon_kernels;
+#endif
+        default:
+            return &scalar_kernels;
+    }
+}
+
+static Isa bestIsa(void)
+{
+    for(int i = ISA_COUNT - 1; i > ISA_SCALAR; --i)
+        if(supported((Isa)i))
+            return (Isa)i;
+    return ISA_SCALAR;
+}
+
+//Scalar until the dispatch below has run during static initialization
+static Isa            current = ISA_SCALAR;
+static const Kernels *active  = &scalar_kernels;
+
+Isa isa(void)
+{
+    return current;
+}
+
+bool setIsa(Isa isa)
+{
+    if(!supported(isa))
+        return false;
+    current = isa;
+    active  = kernelsFor(isa);
+    return true;
+}
+
+static const bool dispatched = setIsa(bestIsa());
+
+const char *isaName(Isa isa)
+{
+    switch(isa) {
+        case ISA_SCALAR: return "scalar";
+        case ISA_SSE2:   return "sse2";
+        case ISA_AVX2:   return "avx2";
+        case ISA_NEON:   return "neon";
+        default:         return "unknown";
+    }
+}
+
+void add(float *dst, const float *src, int n)
+{
+    active->add(dst, src, n);
+}
+
+void addScaled(float *dst, const float *src, float gain, int n)
+{
+    active->addScaled(dst, src, gain, n);
+}
+
+void scale(float *dst, float gain, int n)
+{
+    active->scale(dst, gain, n);
+}
+
+void scaleBuf(float *dst, const float *gain, int n)
+{
+    active->scaleBuf(dst, gain, n);
+}
+
+void crossfade(float *dst, const float *wet, float dry, float wetgain, int n)
+{
+    active->crossfade(dst, wet, dry, wetgain, n);
+}
+
+}
+}
@@ -0,0 +1,56 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  MixKernels.h - Vectorized buffer mixing primitives
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#pragma once
+
+namespace zyn {
+
+/**
+ * Buffer math shared by the mixing paths of Master, Part and EffectMgr.
+ *
+ * Every kernel has a scalar version and, where the platform offers them,
+ * SSE2, AVX2 and NEON versions. The fastest supported implementation is
+ * picked once at startup from the CPU features; setIsa() allows switching
+ * to another one (for tests and benchmarks).
+ *
+ * Buffers do not need any particular alignment and may have any length.
+ * dst may not overlap with the other buffers.
+ */
+namespace mix {
+
+enum Isa {
+    ISA_SCALAR,
+    ISA_SSE2,
+    ISA_AVX2,
+    ISA_NEON,
+    ISA_COUNT
+};
+
+//dst[i] += src[i]
+void add(float *dst, const float *src, int n);
+//dst[i] += src[i] * gain
+void addScaled(float *dst, const float *src, float gain, int n);
+//dst[i] *= gain
+void scale(float *dst, float gain, int n);
+//dst[i] *= gain[i] (e.g. a ramp from Value_Smoothing_Filter)
+void scaleBuf(float *dst, const float *gain, int n);
+//dst[i] = dst[i] * dry + wet[i] * wetgain
+void crossfade(float *dst, const float *wet, float dry, float wetgain, int n);
+
+//Implementation currently in use
+Isa isa(void);
+//Switch implementation, returns false if the CPU does not support it
+bool setIsa(Isa isa);
+bool supported(Isa isa);
+const char *isaName(Isa isa);
+
+}
+}
@@ -97,9 +97,9 @@ inline float MoogFilter::step(float input)
           + a4 * y3);
 }
 
-void MoogFilter::filterout(float *smp)
+void MoogFilter::filterout(float *smp, int nsamples)
 {
-    for (int i = 0; i < buffersize; i ++)
+    for (int i = 0; i < nsamples; i ++)
     {
         smp[i] = step(tanhX(smp[i]*gain));
         smp[i] *= outgain;
@@ -23,7 +23,7 @@ class MoogFilter:public Filter
         MoogFilter(unsigned char Ftype, float Ffreq, float Fq,
                 unsigned int srate, int bufsize);
         ~MoogFilter() override;
-        void filterout(float *smp) override;
+        void filterout(float *smp, int nsamples) override;
         void setfreq(float /*frequency*/) override;
         void setfreq_and_q(float frequency, float q_) override;
         void setq(float /*q_*/) override;
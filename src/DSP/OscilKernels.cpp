@@ -0,0 +1,500 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  OscilKernels.cpp - Vectorized unison oscillator kernels of ADnote
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <cassert>
+#include <cmath>
+#include "OscilKernels.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define OSCIL_X86 1
+#include <immintrin.h>
+//See MixKernels.cpp
+#define OSCIL_SSE2 __attribute__((target("sse2")))
+#define OSCIL_AVX2 __attribute__((target("avx2")))
+#endif
+
+#define LENGTHOF(x) ((int)(sizeof(x)/sizeof(x[0])))
+
+namespace zyn {
+namespace oscil {
+
+typedef void (*Kernel)(float *const *, const float *, int, int *, float *,
+                       const int *, const float *, int, int);
+
+// windowed sinc kernel factor Fs*0.3, rejection 80dB
+static const float_t sinc_kernel[] = {
+    0.0010596256917418426f,
+    0.004273442181254887f,
+    0.0035466063043375785f,
+    -0.014555483937137638f,
+    -0.04789321342588484f,
+    -0.050800020978553066f,
+    0.04679847159974432f,
+    0.2610646708018185f,
+    0.4964802251145513f,
+    0.6000513532962539f,
+    0.4964802251145513f,
+    0.2610646708018185f,
+    0.04679847159974432f,
+    -0.050800020978553066f,
+    -0.04789321342588484f,
+    -0.014555483937137638f,
+    0.0035466063043375785f,
+    0.004273442181254887f,
+    0.0010596256917418426f
+};
+#define SINC_HALF ((LENGTHOF(sinc_kernel) - 1) / 2)
+
+/*
+ * Scalar
+ *
+ * The fractional parts are known to be in [0.0, 1.0) and stored as single
+ * precision floats, so at most 24 bits are significant. Tracking them as
+ * integers (1 is 2^24) makes the overflow into the integer part cheap.
+ */
+static void linear_scalar(float *const *out, const float *smps,
+                          int oscilsize, int *poshi_, float *poslo_,
+                          const int *freqhi_, const float *freqlo_,
+                          int nunison, int n)
+{
+    for(int k = 0; k < nunison; ++k) {
+        int    poshi  = poshi_[k];
+        int    poslo  = (int)(poslo_[k] * 16777216.0f);
+        int    freqhi = freqhi_[k];
+        int    freqlo = (int)(freqlo_[k] * 16777216.0f);
+        float *tw     = out[k];
+        for(int i = 0; i < n; ++i) {
+            tw[i]  = (smps[poshi] * (0x01000000 - poslo) + smps[poshi + 1] * poslo)/(16777216.0f);
+            poslo += freqlo;                // increment fractional part (sample interval phase)
+            poshi += freqhi + (poslo>>24);  // add overflow over 24 bits in poslo to poshi
+            poslo &= 0xffffff;              // remove overflow from poslo
+            poshi &= oscilsize - 1;         // remove overflow
+        }
+        poshi_[k] = poshi;
+        poslo_[k] = poslo/(16777216.0f);
+    }
+}
+
+static void sinc_scalar(float *const *out, const float *smps,
+                        int oscilsize, int *poshi_, float *poslo_,
+                        const int *freqhi_, const float *freqlo_,
+                        int nunison, int n)
+{
+    for(int k = 0; k < nunison; ++k) {
+        int    poshi  = poshi_[k];
+        int    poslo  = (int)(poslo_[k] * (1<<24));
+        int    freqhi = freqhi_[k];
+        int    freqlo = (int)(freqlo_[k] * (1<<24));
+        int    ovsmpfreqhi = freqhi_[k] / 2;
+        int    ovsmpfreqlo = (int)((freqlo_[k] / 2) * (1<<24));
+
+        int    ovsmpposlo;
+        int    ovsmpposhi;
+        int    uflow;
+        float *tw     = out[k];
+        float  out_   = 0;
+
+        for(int i = 0; i < n; ++i) {
+            ovsmpposlo  = poslo - SINC_HALF * ovsmpfreqlo;
+            uflow = ovsmpposlo>>24;
+            ovsmpposhi  = poshi - SINC_HALF * ovsmpfreqhi - ((0x00 - uflow) & 0xff);
+            ovsmpposlo &= 0xffffff;
+            ovsmpposhi &= oscilsize - 1;
+            out_ = 0;
+            for (int l = 0; l<LENGTHOF(sinc_kernel); l++) {
+                out_ += sinc_kernel[l] * (
+                    smps[ovsmpposhi]     * ((1<<24) - ovsmpposlo) +
+                    smps[ovsmpposhi + 1] * ovsmpposlo)/(1.0f*(1<<24));
+                // advance to next kernel sample
+                ovsmpposlo += ovsmpfreqlo;
+                ovsmpposhi += ovsmpfreqhi + (ovsmpposlo>>24); // add the 24-bit overflow
+                ovsmpposlo &= 0xffffff;
+                ovsmpposhi &= oscilsize - 1;
+            }
+
+            // advance to next sample
+            poslo += freqlo;
+            poshi += freqhi + (poslo>>24);
+            poslo &= 0xffffff;
+            poshi &= oscilsize - 1;
+
+            tw[i] = out_;
+        }
+        poshi_[k] = poshi;
+        poslo_[k] = poslo/(1.0f*(1<<24));
+    }
+}
+
+#ifdef OSCIL_X86
+/*
+ * SSE2, 4 subvoices per vector
+ *
+ * Without gathers the wavetable samples are loaded one lane at a time.
+ */
+struct Lanes4
+{
+    __m128i hi, lo;     //phase
+    __m128i fhi, flo;   //increment
+    __m128i ohi, olo;   //increment at the oversampled rate (sinc)
+    __m128i shi, slo;   //SINC_HALF times that
+};
+
+OSCIL_SSE2 static inline __m128 lerp4(const float *smps, __m128i hi,
+                                      __m128i lo)
+{
+    alignas(16) int idx[4];
+    _mm_store_si128((__m128i*)idx, hi);
+    const __m128 s0 = _mm_setr_ps(smps[idx[0]], smps[idx[1]],
+                                  smps[idx[2]], smps[idx[3]]);
+    const __m128 s1 = _mm_setr_ps(smps[idx[0] + 1], smps[idx[1] + 1],
+                                  smps[idx[2] + 1], smps[idx[3] + 1]);
+    const __m128 a  = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_set1_epi32(1<<24),
+                                                    lo));
+    return _mm_add_ps(_mm_mul_ps(s0, a), _mm_mul_ps(s1, _mm_cvtepi32_ps(lo)));
+}
+
+//Advance a phase by one (possibly oversampled) step
+OSCIL_SSE2 static inline void step4(__m128i &hi, __m128i &lo, __m128i fhi,
+                                    __m128i flo, __m128i mask)
+{
+    lo = _mm_add_epi32(lo, flo);
+    hi = _mm_add_epi32(hi, _mm_add_epi32(fhi, _mm_srai_epi32(lo, 24)));
+    lo = _mm_and_si128(lo, _mm_set1_epi32(0xffffff));
+    hi = _mm_and_si128(hi, mask);
+}
+
+OSCIL_SSE2 static inline __m128 linearSample4(const float *smps, Lanes4 &l,
+                                              __m128i mask)
+{
+    const __m128 y = _mm_mul_ps(lerp4(smps, l.hi, l.lo),
+                                _mm_set1_ps(1.0f/16777216.0f));
+    step4(l.hi, l.lo, l.fhi, l.flo, mask);
+    return y;
+}
+
+OSCIL_SSE2 static inline __m128 sincSample4(const float *smps, Lanes4 &l,
+                                            __m128i mask)
+{
+    __m128i olo         = _mm_sub_epi32(l.lo, l.slo);
+    const __m128i uflow = _mm_srai_epi32(olo, 24);
+    __m128i ohi = _mm_sub_epi32(_mm_sub_epi32(l.hi, l.shi),
+            _mm_and_si128(_mm_sub_epi32(_mm_setzero_si128(), uflow),
+                          _mm_set1_epi32(0xff)));
+    olo = _mm_and_si128(olo, _mm_set1_epi32(0xffffff));
+    ohi = _mm_and_si128(ohi, mask);
+
+    __m128 y = _mm_setzero_ps();
+    for(int k = 0; k < LENGTHOF(sinc_kernel); ++k) {
+        const __m128 t = _mm_mul_ps(_mm_set1_ps(sinc_kernel[k]),
+                                    lerp4(smps, ohi, olo));
+        y = _mm_add_ps(y, _mm_mul_ps(t, _mm_set1_ps(1.0f/16777216.0f)));
+        step4(ohi, olo, l.ohi, l.olo, mask);
+    }
+    step4(l.hi, l.lo, l.fhi, l.flo, mask);
+    return y;
+}
+
+//Write samples i..i+3 of four subvoices
+OSCIL_SSE2 static inline void store4x4(float *const *out, int i, __m128 v0,
+                                       __m128 v1, __m128 v2, __m128 v3)
+{
+    _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+    _mm_storeu_ps(out[0] + i, v0);
+    _mm_storeu_ps(out[1] + i, v1);
+    _mm_storeu_ps(out[2] + i, v2);
+    _mm_storeu_ps(out[3] + i, v3);
+}
+
+OSCIL_SSE2 static inline void store4(float *const *out, int i, __m128 v)
+{
+    alignas(16) float y[4];
+    _mm_store_ps(y, v);
+    for(int k = 0; k < 4; ++k)
+        out[k][i] = y[k];
+}
+
+OSCIL_SSE2 static void load4(Lanes4 &l, const int *poshi, const float *poslo,
+                             const int *freqhi, const float *freqlo)
+{
+    alignas(16) int ohi[4], olo[4], shi[4], slo[4];
+    for(int k = 0; k < 4; ++k) {
+        ohi[k] = freqhi[k] / 2;
+        olo[k] = (int)((freqlo[k] / 2) * (1<<24));
+        shi[k] = SINC_HALF * ohi[k];
+        slo[k] = SINC_HALF * olo[k];
+    }
+    const __m128 one = _mm_set1_ps(16777216.0f);
+    l.hi  = _mm_loadu_si128((const __m128i*)poshi);
+    l.lo  = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(poslo), one));
+    l.fhi = _mm_loadu_si128((const __m128i*)freqhi);
+    l.flo = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(freqlo), one));
+    l.ohi = _mm_load_si128((const __m128i*)ohi);
+    l.olo = _mm_load_si128((const __m128i*)olo);
+    l.shi = _mm_load_si128((const __m128i*)shi);
+    l.slo = _mm_load_si128((const __m128i*)slo);
+}
+
+OSCIL_SSE2 static void save4(const Lanes4 &l, int *poshi, float *poslo)
+{
+    _mm_storeu_si128((__m128i*)poshi, l.hi);
+    _mm_storeu_ps(poslo, _mm_mul_ps(_mm_cvtepi32_ps(l.lo),
+                                    _mm_set1_ps(1.0f/16777216.0f)));
+}
+
+#define OSCIL_KERNEL4(name, sample, tail)                                   \
+OSCIL_SSE2 static void name(float *const *out, const float *smps,           \
+                            int oscilsize, int *poshi, float *poslo,        \
+                            const int *freqhi, const float *freqlo,         \
+                            int nunison, int n)                             \
+{                                                                           \
+    const __m128i mask = _mm_set1_epi32(oscilsize - 1);                     \
+    int k = 0;                                                              \
+    for(; k + 4 <= nunison; k += 4) {                                       \
+        Lanes4 l;                                                           \
+        load4(l, poshi + k, poslo + k, freqhi + k, freqlo + k);             \
+        int i = 0;                                                          \
+        for(; i + 4 <= n; i += 4) {                                         \
+            const __m128 v0 = sample(smps, l, mask);                        \
+            const __m128 v1 = sample(smps, l, mask);                        \
+            const __m128 v2 = sample(smps, l, mask);                        \
+            const __m128 v3 = sample(smps, l, mask);                        \
+            store4x4(out + k, i, v0, v1, v2, v3);                           \
+        }                                                                   \
+        for(; i < n; ++i)                                                   \
+            store4(out + k, i, sample(smps, l, mask));                      \
+        save4(l, poshi + k, poslo + k);                                     \
+    }                                                                       \
+    tail(out + k, smps, oscilsize, poshi + k, poslo + k, freqhi + k,        \
+         freqlo + k, nunison - k, n);                                       \
+}
+
+OSCIL_KERNEL4(linear_sse2, linearSample4, linear_scalar)
+OSCIL_KERNEL4(sinc_sse2,   sincSample4,   sinc_scalar)
+
+/*
+ * AVX2, 8 subvoices per vector, the wavetable is read with gathers
+ */
+struct Lanes8
+{
+    __m256i hi, lo, fhi, flo, ohi, olo, shi, slo; //as in Lanes4
+};
+
+OSCIL_AVX2 static inline __m256 lerp8(const float *smps, __m256i hi,
+                                      __m256i lo)
+{
+    const __m256 s0 = _mm256_i32gather_ps(smps, hi, 4);
+    const __m256 s1 = _mm256_i32gather_ps(smps + 1, hi, 4);
+    const __m256 a  = _mm256_cvtepi32_ps(
+            _mm256_sub_epi32(_mm256_set1_epi32(1<<24), lo));
+    return _mm256_add_ps(_mm256_mul_ps(s0, a),
+                         _mm256_mul_ps(s1, _mm256_cvtepi32_ps(lo)));
+}
+
+OSCIL_AVX2 static inline void step8(__m256i &hi, __m256i &lo, __m256i fhi,
+                                    __m256i flo, __m256i mask)
+{
+    lo = _mm256_add_epi32(lo, flo);
+    hi = _mm256_add_epi32(hi, _mm256_add_epi32(fhi, _mm256_srai_epi32(lo, 24)));
+    lo = _mm256_and_si256(lo, _mm256_set1_epi32(0xffffff));
+    hi = _mm256_and_si256(hi, mask);
+}
+
+OSCIL_AVX2 static inline __m256 linearSample8(const float *smps, Lanes8 &l,
+                                              __m256i mask)
+{
+    const __m256 y = _mm256_mul_ps(lerp8(smps, l.hi, l.lo),
+                                   _mm256_set1_ps(1.0f/16777216.0f));
+    step8(l.hi, l.lo, l.fhi, l.flo, mask);
+    return y;
+}
+
+OSCIL_AVX2 static inline __m256 sincSample8(const float *smps, Lanes8 &l,
+                                            __m256i mask)
+{
+    __m256i olo         = _mm256_sub_epi32(l.lo, l.slo);
+    const __m256i uflow = _mm256_srai_epi32(olo, 24);
+    __m256i ohi = _mm256_sub_epi32(_mm256_sub_epi32(l.hi, l.shi),
+            _mm256_and_si256(_mm256_sub_epi32(_mm256_setzero_si256(), uflow),
+                             _mm256_set1_epi32(0xff)));
+    olo = _mm256_and_si256(olo, _mm256_set1_epi32(0xffffff));
+    ohi = _mm256_and_si256(ohi, mask);
+
+    __m256 y = _mm256_setzero_ps();
+    for(int k = 0; k < LENGTHOF(sinc_kernel); ++k) {
+        const __m256 t = _mm256_mul_ps(_mm256_set1_ps(sinc_kernel[k]),
+                                       lerp8(smps, ohi, olo));
+        y = _mm256_add_ps(y, _mm256_mul_ps(t,
+                    _mm256_set1_ps(1.0f/16777216.0f)));
+        step8(ohi, olo, l.ohi, l.olo, mask);
+    }
+    step8(l.hi, l.lo, l.fhi, l.flo, mask);
+    return y;
+}
+
+OSCIL_AVX2 static inline void store8x4(float *const *out, int i, __m256 v0,
+                                       __m256 v1, __m256 v2, __m256 v3)
+{
+    store4x4(out, i, _mm256_castps256_ps128(v0), _mm256_castps256_ps128(v1),
+                     _mm256_castps256_ps128(v2), _mm256_castps256_ps128(v3));
+    store4x4(out + 4, i,
+             _mm256_extractf128_ps(v0, 1), _mm256_extractf128_ps(v1, 1),
+             _mm256_extractf128_ps(v2, 1), _mm256_extractf128_ps(v3, 1));
+}
+
+OSCIL_AVX2 static inline void store8(float *const *out, int i, __m256 v)
+{
+    alignas(32) float y[8];
+    _mm256_store_ps(y, v);
+    for(int k = 0; k < 8; ++k)
+        out[k][i] = y[k];
+}
+
+OSCIL_AVX2 static void load8(Lanes8 &l, const int *poshi, const float *poslo,
+                             const int *freqhi, const float *freqlo)
+{
+    alignas(32) int ohi[8], olo[8], shi[8], slo[8];
+    for(int k = 0; k < 8; ++k) {
+        ohi[k] = freqhi[k] / 2;
+        olo[k] = (int)((freqlo[k] / 2) * (1<<24));
+        shi[k] = SINC_HALF * ohi[k];
+        slo[k] = SINC_HALF * olo[k];
+    }
+    const __m256 one = _mm256_set1_ps(16777216.0f);
+    l.hi  = _mm256_loadu_si256((const __m256i*)poshi);
+    l.lo  = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_loadu_ps(poslo), one));
+    l.fhi = _mm256_loadu_si256((const __m256i*)freqhi);
+    l.flo = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_loadu_ps(freqlo), one));
+    l.ohi = _mm256_load_si256((const __m256i*)ohi);
+    l.olo = _mm256_load_si256((const __m256i*)olo);
+    l.shi = _mm256_load_si256((const __m256i*)shi);
+    l.slo = _mm256_load_si256((const __m256i*)slo);
+}
+
+OSCIL_AVX2 static void save8(const Lanes8 &l, int *poshi, float *poslo)
+{
+    _mm256_storeu_si256((__m256i*)poshi, l.hi);
+    _mm256_storeu_ps(poslo, _mm256_mul_ps(_mm256_cvtepi32_ps(l.lo),
+                                          _mm256_set1_ps(1.0f/16777216.0f)));
+}
+
+#define OSCIL_KERNEL8(name, sample, tail)                                   \
+OSCIL_AVX2 static void name(float *const *out, const float *smps,           \
+                            int oscilsize, int *poshi, float *poslo,        \
+                            const int *freqhi, const float *freqlo,         \
+                            int nunison, int n)                             \
+{                                                                           \
+    const __m256i mask = _mm256_set1_epi32(oscilsize - 1);                  \
+    int k = 0;                                                              \
+    for(; k + 8 <= nunison; k += 8) {                                       \
+        Lanes8 l;                                                           \
+        load8(l, poshi + k, poslo + k, freqhi + k, freqlo + k);             \
+        int i = 0;                                                          \
+        for(; i + 4 <= n; i += 4) {                                         \
+            const __m256 v0 = sample(smps, l, mask);                        \
+            const __m256 v1 = sample(smps, l, mask);                        \
+            const __m256 v2 = sample(smps, l, mask);                        \
+            const __m256 v3 = sample(smps, l, mask);                        \
+            store8x4(out + k, i, v0, v1, v2, v3);                           \
+        }                                                                   \
+        for(; i < n; ++i)                                                   \
+            store8(out + k, i, sample(smps, l, mask));                      \
+        save8(l, poshi + k, poslo + k);                                     \
+    }                                                                       \
+    tail(out + k, smps, oscilsize, poshi + k, poslo + k, freqhi + k,        \
+         freqlo + k, nunison - k, n);                                       \
+}
+
+OSCIL_KERNEL8(linear_avx2, linearSample8, linear_sse2)
+OSCIL_KERNEL8(sinc_avx2,   sincSample8,   sinc_sse2)
+#endif
+
+/*
+ * Dispatch
+ */
+static bool hasKernels(mix::Isa isa)
+{
+    switch(isa) {
+        case mix::ISA_SCALAR:
+#ifdef OSCIL_X86
+        case mix::ISA_SSE2:
+        case mix::ISA_AVX2:
+#endif
+            return mix::supported(isa);
+        default:
+            return false;
+    }
+}
+
+static mix::Isa current         = mix::ISA_SCALAR;
+static Kernel   active_linear   = linear_scalar;
+static Kernel   active_sinc     = sinc_scalar;
+
+mix::Isa isa(void)
+{
+    return current;
+}
+
+bool setIsa(mix::Isa isa)
+{
+    if(!hasKernels(isa))
+        return false;
+    current = isa;
+    switch(isa) {
+#ifdef OSCIL_X86
+        case mix::ISA_SSE2:
+            active_linear = linear_sse2;
+            active_sinc   = sinc_sse2;
+            break;
+        case mix::ISA_AVX2:
+            active_linear = linear_avx2;
+            active_sinc   = sinc_avx2;
+            break;
+#endif
+        default:
+            active_linear = linear_scalar;
+            active_sinc   = sinc_scalar;
+            break;
+    }
+    return true;
+}
+
+static mix::Isa bestIsa(void)
+{
+    for(int i = mix::ISA_COUNT - 1; i > mix::ISA_SCALAR; --i)
+        if(hasKernels((mix::Isa)i))
+            return (mix::Isa)i;
+    return mix::ISA_SCALAR;
+}
+
+static const bool dispatched = oscil::setIsa(bestIsa());
+
+void linear(float *const *out, const float *smps, int oscilsize,
+            int *poshi, float *poslo, const int *freqhi, const float *freqlo,
+            int nunison, int n)
+{
+    for(int k = 0; k < nunison; ++k)
+        assert(freqlo[k] < 1.0f);
+    active_linear(out, smps, oscilsize, poshi, poslo, freqhi, freqlo,
+                  nunison, n);
+}
+
+void sinc(float *const *out, const float *smps, int oscilsize,
+          int *poshi, float *poslo, const int *freqhi, const float *freqlo,
+          int nunison, int n)
+{
+    for(int k = 0; k < nunison; ++k)
+        assert(freqlo[k] < 1.0f);
+    active_sinc(out, smps, oscilsize, poshi, poslo, freqhi, freqlo,
+                nunison, n);
+}
+
+}
+}
@@ -0,0 +1,64 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  OscilKernels.h - Vectorized unison oscillator kernels of ADnote
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#pragma once
+#include "MixKernels.h"
+
+namespace zyn {
+
+/**
+ * Wavetable readers for the unison subvoices of an ADnote voice.
+ *
+ * The phase of every subvoice is the sample index poshi into the wavetable
+ * plus the fraction poslo (in [0, 1), handled as 24 bit fixed point), the
+ * increments per sample are freqhi and freqlo. The vector versions keep
+ * one subvoice per lane (4 with SSE2, 8 with AVX2, gathering the wavetable
+ * samples) and transpose blocks of four output samples to write the
+ * per-subvoice buffers; remaining subvoices use the scalar code.
+ *
+ * The vector code performs exactly the operations of the scalar code in
+ * the same order and without FMA. The output is identical to the scalar
+ * output as long as the compiler keeps the scalar code as written
+ * (single precision, no FMA contraction; true for the default x86-64
+ * flags), otherwise it differs by float rounding only (< 1e-5). The phases
+ * always match exactly.
+ *
+ * The fastest supported implementation is picked at startup, setIsa()
+ * switches it for tests and benchmarks. NEON uses the scalar code.
+ */
+namespace oscil {
+
+/**
+ * Linear interpolation
+ * @param out       one buffer of n samples per subvoice
+ * @param smps      wavetable of oscilsize samples, followed by at least 1
+ *                  copy of its start (OSCIL_SMP_EXTRA_SAMPLES)
+ * @param oscilsize wavetable size, a power of two
+ * @param poshi     integer phase per subvoice, advanced by n samples
+ * @param poslo     fractional phase per subvoice, advanced by n samples
+ * @param freqhi    integer phase increment per subvoice
+ * @param freqlo    fractional phase increment per subvoice (< 1)
+ */
+void linear(float *const *out, const float *smps, int oscilsize,
+            int *poshi, float *poslo, const int *freqhi, const float *freqlo,
+            int nunison, int n);
+
+/**Windowed sinc interpolation (anti-aliased), same parameters*/
+void sinc(float *const *out, const float *smps, int oscilsize,
+          int *poshi, float *poslo, const int *freqhi, const float *freqlo,
+          int nunison, int n);
+
+mix::Isa isa(void);
+//Returns false if the CPU does not support isa
+bool setIsa(mix::Isa isa);
+
+}
+}
@@ -0,0 +1,476 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  PadKernels.cpp - Vectorized sample playback of PADnote
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "PadKernels.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PAD_X86 1
+#include <immintrin.h>
+//See MixKernels.cpp
+#define PAD_SSE2 __attribute__((target("sse2")))
+#define PAD_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace zyn {
+namespace pad {
+
+/*
+ * Positions
+ *
+ * As in OscilKernels.cpp the fraction is tracked as an integer, 1 is 2^24.
+ * The positions of a span then follow exactly from its start, no matter in
+ * how many steps they are computed.
+ */
+static inline void step(int &hi_l, int &hi_r, int &lo, int freqhi, int freqlo)
+{
+    lo   += freqlo;
+    hi_l += freqhi + (lo >> 24);
+    hi_r += freqhi + (lo >> 24);
+    lo   &= 0xffffff;
+}
+
+static inline float fraction(int lo)
+{
+    return lo * (1.0f / 16777216.0f);
+}
+
+//Computes n samples starting at hi_l, hi_r and lo, without passing the end
+//of the sample
+template<class T>
+using Span = void (*)(float *, float *, const T *, float, int, int, int,
+                      int, int, int);
+
+/*
+ * Interpolation, of float or 16 bit values
+ */
+#ifdef PAD_X86
+//Values idx and idx + 1 of every lane. Without gathers the lanes are read
+//one at a time
+PAD_SSE2 static inline void pair4(const float *smps, __m128i idx,
+                                  __m128 &a, __m128 &b)
+{
+    alignas(16) int i[4];
+    _mm_store_si128((__m128i*)i, idx);
+    a = _mm_setr_ps(smps[i[0]], smps[i[1]], smps[i[2]], smps[i[3]]);
+    b = _mm_setr_ps(smps[i[0] + 1], smps[i[1] + 1],
+                    smps[i[2] + 1], smps[i[3] + 1]);
+}
+
+//Both 16 bit values come with one 32 bit load (little endian)
+PAD_SSE2 static inline void pair4(const int16_t *smps, __m128i idx,
+                                  __m128 &a, __m128 &b)
+{
+    alignas(16) int i[4];
+    int32_t w[4];
+    _mm_store_si128((__m128i*)i, idx);
+    for(int k = 0; k < 4; ++k)
+        memcpy(&w[k], smps + i[k], sizeof(int32_t));
+    const __m128i v = _mm_setr_epi32(w[0], w[1], w[2], w[3]);
+    a = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(v, 16), 16));
+    b = _mm_cvtepi32_ps(_mm_srai_epi32(v, 16));
+}
+
+PAD_AVX2 static inline void pair8(const float *smps, __m256i idx,
+                                  __m256 &a, __m256 &b)
+{
+    a = _mm256_i32gather_ps(smps, idx, 4);
+    b = _mm256_i32gather_ps(smps + 1, idx, 4);
+}
+
+//Both 16 bit values come with one 32 bit gather (little endian)
+PAD_AVX2 static inline void pair8(const int16_t *smps, __m256i idx,
+                                  __m256 &a, __m256 &b)
+{
+    const __m256i v = _mm256_i32gather_epi32((const int *)smps, idx, 2);
+    a = _mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16));
+    b = _mm256_cvtepi32_ps(_mm256_srai_epi32(v, 16));
+}
+#endif
+
+struct Linear
+{
+    template<class T>
+    static inline float at(const T *smps, int hi, float f)
+    {
+        return smps[hi] * (1.0f - f) + smps[hi + 1] * f;
+    }
+
+#ifdef PAD_X86
+    template<class T>
+    PAD_SSE2 static inline __m128 at4(const T *smps, __m128i hi, __m128 f)
+    {
+        __m128 x0, x1;
+        pair4(smps, hi, x0, x1);
+        return _mm_add_ps(_mm_mul_ps(x0, _mm_sub_ps(_mm_set1_ps(1.0f), f)),
+                          _mm_mul_ps(x1, f));
+    }
+
+    template<class T>
+    PAD_AVX2 static inline __m256 at8(const T *smps, __m256i hi, __m256 f)
+    {
+        __m256 x0, x1;
+        pair8(smps, hi, x0, x1);
+        return _mm256_add_ps(
+                _mm256_mul_ps(x0, _mm256_sub_ps(_mm256_set1_ps(1.0f), f)),
+                _mm256_mul_ps(x1, f));
+    }
+#endif
+};
+
+struct Cubic
+{
+    template<class T>
+    static inline float at(const T *smps, int hi, float f)
+    {
+        const float xm1 = smps[hi];
+        const float x0  = smps[hi + 1];
+        const float x1  = smps[hi + 2];
+        const float x2  = smps[hi + 3];
+        const float a   = (3.0f * (x0 - x1) - xm1 + x2) * 0.5f;
+        const float b   = 2.0f * x1 + xm1 - (5.0f * x0 + x2) * 0.5f;
+        const float c   = (x1 - xm1) * 0.5f;
+        return (((a * f) + b) * f + c) * f + x0;
+    }
+
+#ifdef PAD_X86
+    PAD_SSE2 static inline __m128 spline4(__m128 xm1, __m128 x0, __m128 x1,
+                                          __m128 x2, __m128 f)
+    {
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 a = _mm_mul_ps(_mm_add_ps(_mm_sub_ps(
+                        _mm_mul_ps(_mm_set1_ps(3.0f), _mm_sub_ps(x0, x1)),
+                        xm1), x2), half);
+        const __m128 b = _mm_sub_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.0f), x1), xm1),
+                _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(5.0f), x0), x2),
+                           half));
+        const __m128 c = _mm_mul_ps(_mm_sub_ps(x1, xm1), half);
+        return _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(
+                                _mm_mul_ps(a, f), b), f), c), f), x0);
+    }
+
+    template<class T>
+    PAD_SSE2 static inline __m128 at4(const T *smps, __m128i hi, __m128 f)
+    {
+        __m128 xm1, x0, x1, x2;
+        pair4(smps, hi, xm1, x0);
+        pair4(smps + 2, hi, x1, x2);
+        return spline4(xm1, x0, x1, x2, f);
+    }
+
+    PAD_AVX2 static inline __m256 spline8(__m256 xm1, __m256 x0, __m256 x1,
+                                          __m256 x2, __m256 f)
+    {
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256 a = _mm256_mul_ps(_mm256_add_ps(_mm256_sub_ps(
+                        _mm256_mul_ps(_mm256_set1_ps(3.0f),
+                                      _mm256_sub_ps(x0, x1)),
+                        xm1), x2), half);
+        const __m256 b = _mm256_sub_ps(
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(2.0f), x1), xm1),
+                _mm256_mul_ps(_mm256_add_ps(
+                        _mm256_mul_ps(_mm256_set1_ps(5.0f), x0), x2), half));
+        const __m256 c = _mm256_mul_ps(_mm256_sub_ps(x1, xm1), half);
+        return _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(
+                                _mm256_add_ps(_mm256_mul_ps(a, f), b), f), c),
+                                           f), x0);
+    }
+
+    template<class T>
+    PAD_AVX2 static inline __m256 at8(const T *smps, __m256i hi, __m256 f)
+    {
+        __m256 xm1, x0, x1, x2;
+        pair8(smps, hi, xm1, x0);
+        pair8(smps + 2, hi, x1, x2);
+        return spline8(xm1, x0, x1, x2, f);
+    }
+#endif
+};
+
+/*
+ * Scalar
+ */
+template<class T, class I>
+static void span_scalar(float *outl, float *outr, const T *smps, float scale,
+                        int hi_l, int hi_r, int lo, int freqhi, int freqlo,
+                        int n)
+{
+    for(int i = 0; i < n; ++i) {
+        step(hi_l, hi_r, lo, freqhi, freqlo);
+        const float f = fraction(lo);
+        outl[i] = I::at(smps, hi_l, f) * scale;
+        outr[i] = I::at(smps, hi_r, f) * scale;
+    }
+}
+
+#ifdef PAD_X86
+/*
+ * SSE2, 4 output samples per vector
+ *
+ * Lane k holds the position of output sample i + k, a vector advances by
+ * four steps at once. The right channel is the left one plus a constant
+ * within a span.
+ */
+template<class T, class I>
+PAD_SSE2 static void span_sse2(float *outl, float *outr, const T *smps,
+                               float scale, int hi_l, int hi_r, int lo,
+                               int freqhi, int freqlo, int n)
+{
+    const int d = hi_r - hi_l;
+    alignas(16) int h[4], l[4];
+    for(int k = 0; k < 4; ++k) {
+        step(hi_l, hi_r, lo, freqhi, freqlo);
+        h[k] = hi_l;
+        l[k] = lo;
+    }
+
+    __m128i       hi    = _mm_load_si128((const __m128i*)h);
+    __m128i       lov   = _mm_load_si128((const __m128i*)l);
+    const __m128i fhi   = _mm_set1_epi32(4 * freqhi);
+    const __m128i flo   = _mm_set1_epi32(4 * freqlo);
+    const __m128i dv    = _mm_set1_epi32(d);
+    const __m128  s     = _mm_set1_ps(scale);
+    const __m128  unit  = _mm_set1_ps(1.0f / 16777216.0f);
+    int i = 0;
+    for(; i + 4 <= n; i += 4) {
+        const __m128 f = _mm_mul_ps(_mm_cvtepi32_ps(lov), unit);
+        _mm_storeu_ps(outl + i, _mm_mul_ps(I::at4(smps, hi, f), s));
+        _mm_storeu_ps(outr + i,
+                      _mm_mul_ps(I::at4(smps, _mm_add_epi32(hi, dv), f), s));
+
+        lov = _mm_add_epi32(lov, flo);
+        hi  = _mm_add_epi32(hi, _mm_add_epi32(fhi, _mm_srai_epi32(lov, 24)));
+        lov = _mm_and_si128(lov, _mm_set1_epi32(0xffffff));
+    }
+
+    //The rest starts at the position of lane 0
+    _mm_store_si128((__m128i*)h, hi);
+    _mm_store_si128((__m128i*)l, lov);
+    hi_l = h[0];
+    lo   = l[0];
+    for(; i < n; ++i) {
+        const float f = fraction(lo);
+        outl[i] = I::at(smps, hi_l, f) * scale;
+        outr[i] = I::at(smps, hi_l + d, f) * scale;
+        lo   += freqlo;
+        hi_l += freqhi + (lo >> 24);
+        lo   &= 0xffffff;
+    }
+}
+
+/*
+ * AVX2, 8 output samples per vector, the sample is read with gathers
+ */
+template<class T, class I>
+PAD_AVX2 static void span_avx2(float *outl, float *outr, const T *smps,
+                               float scale, int hi_l, int hi_r, int lo,
+                               int freqhi, int freqlo, int n)
+{
+    const int d = hi_r - hi_l;
+    alignas(32) int h[8], l[8];
+    for(int k = 0; k < 8; ++k) {
+        step(hi_l, hi_r, lo, freqhi, freqlo);
+        h[k] = hi_l;
+        l[k] = lo;
+    }
+
+    __m256i       hi    = _mm256_load_si256((const __m256i*)h);
+    __m256i       lov   = _mm256_load_si256((const __m256i*)l);
+    const __m256i fhi   = _mm256_set1_epi32(8 * freqhi);
+    const __m256i flo   = _mm256_set1_epi32(8 * freqlo);
+    const __m256i dv    = _mm256_set1_epi32(d);
+    const __m256  s     = _mm256_set1_ps(scale);
+    const __m256  unit  = _mm256_set1_ps(1.0f / 16777216.0f);
+    int i = 0;
+    for(; i + 8 <= n; i += 8) {
+        const __m256 f = _mm256_mul_ps(_mm256_cvtepi32_ps(lov), unit);
+        _mm256_storeu_ps(outl + i, _mm256_mul_ps(I::at8(smps, hi, f), s));
+        _mm256_storeu_ps(outr + i, _mm256_mul_ps(
+                    I::at8(smps, _mm256_add_epi32(hi, dv), f), s));
+
+        lov = _mm256_add_epi32(lov, flo);
+        hi  = _mm256_add_epi32(hi, _mm256_add_epi32(fhi,
+                                   _mm256_srai_epi32(lov, 24)));
+        lov = _mm256_and_si256(lov, _mm256_set1_epi32(0xffffff));
+    }
+
+    //The rest starts at the position of lane 0
+    _mm256_store_si256((__m256i*)h, hi);
+    _mm256_store_si256((__m256i*)l, lov);
+    hi_l = h[0];
+    lo   = l[0];
+    for(; i < n; ++i) {
+        const float f = fraction(lo);
+        outl[i] = I::at(smps, hi_l, f) * scale;
+        outr[i] = I::at(smps, hi_l + d, f) * scale;
+        lo   += freqlo;
+        hi_l += freqhi + (lo >> 24);
+        lo   &= 0xffffff;
+    }
+}
+#endif
+
+/*
+ * Spans and wrapping, the same for every implementation
+ */
+template<class T, class I, Span<T> span>
+static void play(float *outl, float *outr, const T *smps, int size,
+                 float scale, int &poshi_l, int &poshi_r, float &poslo,
+                 int freqhi, float freqlo_, int n)
+{
+    int       hi_l   = poshi_l;
+    int       hi_r   = poshi_r;
+    int       lo     = (int)(poslo * 16777216.0f);
+    const int freqlo = (int)(freqlo_ * 16777216.0f);
+
+    int i = 0;
+    while(i < n) {
+        //A step advances by freqhi + 1 at most
+        const int room = size - 1 - std::max(hi_l, hi_r);
+        const int m    = std::min(n - i, room / (std::max(freqhi, 0) + 1));
+        if(m > 0) {
+            span(outl + i, outr + i, smps, scale, hi_l, hi_r, lo,
+                 freqhi, freqlo, m);
+            const int64_t l = lo + (int64_t)m * freqlo;
+            hi_l += m * freqhi + (int)(l >> 24);
+            hi_r += m * freqhi + (int)(l >> 24);
+            lo    = (int)(l & 0xffffff);
+            i    += m;
+            continue;
+        }
+
+        //The step around the end of the sample
+        step(hi_l, hi_r, lo, freqhi, freqlo);
+        if(hi_l >= size)
+            hi_l %= size;
+        if(hi_r >= size)
+            hi_r %= size;
+        const float f = fraction(lo);
+        outl[i] = I::at(smps, hi_l, f) * scale;
+        outr[i] = I::at(smps, hi_r, f) * scale;
+        ++i;
+    }
+
+    poshi_l = hi_l;
+    poshi_r = hi_r;
+    poslo   = fraction(lo);
+}
+
+template<class T>
+using Kernel = void (*)(float *, float *, const T *, int, float, int &,
+                        int &, float &, int, float, int);
+
+template<class T, class I>
+static Kernel<T> kernel(mix::Isa isa)
+{
+    switch(isa) {
+#ifdef PAD_X86
+        case mix::ISA_SSE2:
+            return play<T, I, span_sse2<T, I>>;
+        case mix::ISA_AVX2:
+            return play<T, I, span_avx2<T, I>>;
+#endif
+        default:
+            return play<T, I, span_scalar<T, I>>;
+    }
+}
+
+/*
+ * Dispatch
+ */
+static bool hasKernels(mix::Isa isa)
+{
+    switch(isa) {
+        case mix::ISA_SCALAR:
+#ifdef PAD_X86
+        case mix::ISA_SSE2:
+        case mix::ISA_AVX2:
+#endif
+            return mix::supported(isa);
+        default:
+            return false;
+    }
+}
+
+static mix::Isa        current         = mix::ISA_SCALAR;
+static Kernel<float>   active_linear   = kernel<float, Linear>(current);
+static Kernel<int16_t> active_linear16 = kernel<int16_t, Linear>(current);
+static Kernel<float>   active_cubic    = kernel<float, Cubic>(current);
+static Kernel<int16_t> active_cubic16  = kernel<int16_t, Cubic>(current);
+
+mix::Isa isa(void)
+{
+    return current;
+}
+
+bool setIsa(mix::Isa isa)
+{
+    if(!hasKernels(isa))
+        return false;
+    current         = isa;
+    active_linear   = kernel<float, Linear>(isa);
+    active_linear16 = kernel<int16_t, Linear>(isa);
+    active_cubic    = kernel<float, Cubic>(isa);
+    active_cubic16  = kernel<int16_t, Cubic>(isa);
+    return true;
+}
+
+static mix::Isa bestIsa(void)
+{
+    for(int i = mix::ISA_COUNT - 1; i > mix::ISA_SCALAR; --i)
+        if(hasKernels((mix::Isa)i))
+            return (mix::Isa)i;
+    return mix::ISA_SCALAR;
+}
+
+static const bool dispatched = pad::setIsa(bestIsa());
+
+void linear(float *outl, float *outr, const float *smps, int size,
+            float scale, int &poshi_l, int &poshi_r, float &poslo,
+            int freqhi, float freqlo, int n)
+{
+    assert(freqlo < 1.0f);
+    active_linear(outl, outr, smps, size, scale, poshi_l, poshi_r, poslo,
+                  freqhi, freqlo, n);
+}
+
+void linear(float *outl, float *outr, const int16_t *smps, int size,
+            float scale, int &poshi_l, int &poshi_r, float &poslo,
+            int freqhi, float freqlo, int n)
+{
+    assert(freqlo < 1.0f);
+    active_linear16(outl, outr, smps, size, scale, poshi_l, poshi_r, poslo,
+                    freqhi, freqlo, n);
+}
+
+void cubic(float *outl, float *outr, const float *smps, int size,
+           float scale, int &poshi_l, int &poshi_r, float &poslo,
+           int freqhi, float freqlo, int n)
+{
+    assert(freqlo < 1.0f);
+    active_cubic(outl, outr, smps, size, scale, poshi_l, poshi_r, poslo,
+                 freqhi, freqlo, n);
+}
+
+void cubic(float *outl, float *outr, const int16_t *smps, int size,
+           float scale, int &poshi_l, int &poshi_r, float &poslo,
+           int freqhi, float freqlo, int n)
+{
+    assert(freqlo < 1.0f);
+    active_cubic16(outl, outr, smps, size, scale, poshi_l, poshi_r, poslo,
+                   freqhi, freqlo, n);
+}
+
+}
+}
@@ -0,0 +1,80 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  PadKernels.h - Vectorized sample playback of PADnote
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#pragma once
+#include <stdint.h>
+#include "MixKernels.h"
+
+namespace zyn {
+
+/**
+ * Interpolating readers of the PADsynth samples, writing both channels of
+ * a note at once.
+ *
+ * The channels share the fractional position poslo (in [0, 1), handled as
+ * 24 bit fixed point) and the increments freqhi and freqlo per sample; only
+ * their sample index (poshi_l, poshi_r) differs. Every buffer is split into
+ * spans in which neither channel reaches the end of the sample. A span is
+ * computed without any branch, several output samples per vector (4 with
+ * SSE2, 8 with AVX2), the sample index of each output being derived from
+ * the start of the span. The few steps that wrap around the end are
+ * computed one at a time.
+ *
+ * Samples are floats or 16 bit integers with a scale (see
+ * PADnoteParameters::Sample). 16 bit values are converted to floats a
+ * vector at a time; AVX2 gathers two neighbouring values with one 32 bit
+ * load.
+ *
+ * As with OscilKernels.h, the vector code performs exactly the operations
+ * of the scalar code in the same order and without FMA, so the output is
+ * identical unless the compiler contracts the scalar code. The positions
+ * always match exactly.
+ *
+ * The fastest supported implementation is picked at startup, setIsa()
+ * switches it for tests and benchmarks. NEON uses the scalar code.
+ */
+namespace pad {
+
+/**
+ * Linear interpolation
+ * @param outl    left output, n samples
+ * @param outr    right output, n samples
+ * @param smps    sample of size values, followed by at least 3 copies of
+ *                its start
+ * @param scale   factor of the values (1 for float samples)
+ * @param poshi_l integer position of the left channel, < size, advanced by
+ *                n samples
+ * @param poshi_r integer position of the right channel, likewise
+ * @param poslo   fractional position, advanced by n samples
+ * @param freqhi  integer increment per sample, < size
+ * @param freqlo  fractional increment per sample (< 1)
+ */
+void linear(float *outl, float *outr, const float *smps, int size,
+            float scale, int &poshi_l, int &poshi_r, float &poslo,
+            int freqhi, float freqlo, int n);
+void linear(float *outl, float *outr, const int16_t *smps, int size,
+            float scale, int &poshi_l, int &poshi_r, float &poslo,
+            int freqhi, float freqlo, int n);
+
+/**Cubic interpolation, same parameters*/
+void cubic(float *outl, float *outr, const float *smps, int size,
+           float scale, int &poshi_l, int &poshi_r, float &poslo,
+           int freqhi, float freqlo, int n);
+void cubic(float *outl, float *outr, const int16_t *smps, int size,
+           float scale, int &poshi_l, int &poshi_r, float &poslo,
+           int freqhi, float freqlo, int n);
+
+mix::Isa isa(void);
+//Returns false if the CPU does not support isa
+bool setIsa(mix::Isa isa);
+
+}
+}
@@ -14,7 +14,7 @@
 #include <cmath>
 #include <cstdio>
 #include <cstring>
-#include <cassert>
+#include <algorithm>
 #include "../Misc/Util.h"
 #include "SVFilter.h"
 
@@ -203,32 +203,30 @@ void SVFilter::singlefilterout(float *smp, SVFilter::fstage &x, SVFilter::parame
     }
 }
 
-void SVFilter::filterout(float *smp)
+void SVFilter::filterout(float *smp, int nsamples)
 {
-    assert((buffersize % 8) == 0);
-
     float freqbuf[buffersize];
 
-    if ( freq_smoothing.apply( freqbuf, buffersize, freq ) )
+    if ( freq_smoothing.apply( freqbuf, nsamples, freq ) )
     {
         /* 8 sample chunks seems to work OK for AnalogFilter, so do that here too. */
-        for ( int i = 0; i < buffersize; i += 8 )
+        for ( int i = 0; i < nsamples; i += 8 )
         {
             freq = freqbuf[i];
             computefiltercoefs();
 
             for(int j = 0; j < stages + 1; ++j)
-                singlefilterout(smp + i, st[j], par, 8 );
+                singlefilterout(smp + i, st[j], par, std::min(8, nsamples - i) );
         }
 
-        freq = freqbuf[buffersize - 1];
+        freq = freqbuf[nsamples - 1];
         computefiltercoefs();
     }
     else
         for(int i = 0; i < stages + 1; ++i)
-            singlefilterout(smp, st[i], par, buffersize );
+            singlefilterout(smp, st[i], par, nsamples );
 
-    for(int i = 0; i < buffersize; ++i)
+    for(int i = 0; i < nsamples; ++i)
         smp[i] *= outgain;
 }
 
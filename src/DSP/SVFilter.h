@@ -29,7 +29,7 @@ class SVFilter:public Filter
                  unsigned char Fstages,
                  unsigned int srate, int bufsize);
         ~SVFilter();
-        void filterout(float *smp);
+        void filterout(float *smp, int nsamples);
         void setfreq(float frequency);
         void setfreq_and_q(float frequency, float q_);
         void setq(float q_);
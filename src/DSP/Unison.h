@@ -15,6 +15,7 @@
 #define UNISON_H
 
 #include "../Misc/Util.h"
+#include "../Misc/Rng.h"
 
 //how much the unison frequencies varies (always >= 1.0)
 #define UNISON_FREQ_SPAN 2.0f
@@ -26,7 +27,8 @@ class Allocator;
 class Unison
 {
     public:
-        Unison(Allocator *alloc_, int update_period_samples_, float max_delay_sec_, float srate_f);
+        Unison(Allocator *alloc_, int update_period_samples_, float max_delay_sec_, float srate_f,
+               uint32_t seed);
         ~Unison();
 
         void setSize(int new_size);
@@ -50,7 +52,7 @@ class Unison
             float lin_fpos;
             float lin_ffreq;
             UnisonVoice() {
-                position = RND * 1.8f - 0.9f;
+                position = 0.0f;
                 realpos1 = 0.0f;
                 realpos2 = 0.0f;
                 step     = 0.0f;
@@ -65,6 +67,8 @@ class Unison
         float *delay_buffer;
         float  unison_amplitude_samples;
         float  unison_bandwidth_cents;
+        //Randomness of the voices, it does not use the global generator
+        RngStream rng;
 
         // current setup
         float samplerate_f;
@@ -135,11 +135,11 @@ void Distorsion::cleanup(void)
 //Apply the filters
 void Distorsion::applyfilters(float *efxoutl, float *efxoutr)
 {
-    if(Plpf!=127) lpfl->filterout(efxoutl);
-    if(Phpf!=0) hpfl->filterout(efxoutl);
+    if(Plpf!=127) lpfl->filterout(efxoutl, buffersize);
+    if(Phpf!=0) hpfl->filterout(efxoutl, buffersize);
     if(Pstereo != 0) { //stereo
-        if(Plpf!=127) lpfr->filterout(efxoutr);
-        if(Phpf!=0) hpfr->filterout(efxoutr);
+        if(Plpf!=127) lpfr->filterout(efxoutr, buffersize);
+        if(Phpf!=0) hpfr->filterout(efxoutr, buffersize);
     }
 }
 
@@ -117,8 +117,8 @@ void DynamicFilter::out(const Stereo<float *> &smp)
     filterl->setfreq_and_q(frl, q);
     filterr->setfreq_and_q(frr, q);
 
-    filterl->filterout(efxoutl);
-    filterr->filterout(efxoutr);
+    filterl->filterout(efxoutl, buffersize);
+    filterr->filterout(efxoutr, buffersize);
 
     //panning
     for(int i = 0; i < buffersize; ++i) {
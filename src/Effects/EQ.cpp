@@ -138,8 +138,8 @@ void EQ::out(const Stereo<float *> &smp)
     for(int i = 0; i < MAX_EQ_BANDS; ++i) {
         if(filter[i].Ptype == 0)
             continue;
-        filter[i].l->filterout(efxoutl);
-        filter[i].r->filterout(efxoutr);
+        filter[i].l->filterout(efxoutl, buffersize);
+        filter[i].r->filterout(efxoutr, buffersize);
     }
 }
 
@@ -31,6 +31,8 @@
 #include "../Misc/Time.h"
 #include "../Params/FilterParams.h"
 #include "../Misc/Allocator.h"
+#include "../DSP/Denormal.h"
+#include "../DSP/MixKernels.h"
 
 namespace zyn {
 
@@ -503,12 +505,12 @@ void EffectMgr::out(float *smpsl, float *smpsr)
             }
         return;
     }
-    for(int i = 0; i < synth.buffersize; ++i) {
-        smpsl[i]  += synth.denormalkillbuf[i];
-        smpsr[i]  += synth.denormalkillbuf[i];
-        efxoutl[i] = 0.0f;
-        efxoutr[i] = 0.0f;
+    if(denormal::policy() == denormal::POLICY_NOISE) {
+        mix::add(smpsl, synth.denormalkillbuf, synth.buffersize);
+        mix::add(smpsr, synth.denormalkillbuf, synth.buffersize);
     }
+    memset(efxoutl, 0, synth.bufferbytes);
+    memset(efxoutr, 0, synth.bufferbytes);
     efx->out(smpsl, smpsr);
 
     float volume = efx->volume;
@@ -533,26 +535,23 @@ void EffectMgr::out(float *smpsl, float *smpsr)
         if((nefx == 1) || (nefx == 2))
             v2 *= v2;  //for Reverb and Echo, the wet function is not liniar
 
-        if(dryonly)   //this is used for instrument effect only
-            for(int i = 0; i < synth.buffersize; ++i) {
-                smpsl[i]   *= v1;
-                smpsr[i]   *= v1;
-                efxoutl[i] *= v2;
-                efxoutr[i] *= v2;
-            }
-        else // normal instrument/insertion effect
-            for(int i = 0; i < synth.buffersize; ++i) {
-                smpsl[i] = smpsl[i] * v1 + efxoutl[i] * v2;
-                smpsr[i] = smpsr[i] * v1 + efxoutr[i] * v2;
-            }
-    }
-    else // System effect
-        for(int i = 0; i < synth.buffersize; ++i) {
-            efxoutl[i] *= 2.0f * volume;
-            efxoutr[i] *= 2.0f * volume;
-            smpsl[i]    = efxoutl[i];
-            smpsr[i]    = efxoutr[i];
+        if(dryonly) { //this is used for instrument effect only
+            mix::scale(smpsl, v1, synth.buffersize);
+            mix::scale(smpsr, v1, synth.buffersize);
+            mix::scale(efxoutl, v2, synth.buffersize);
+            mix::scale(efxoutr, v2, synth.buffersize);
+        }
+        else { // normal instrument/insertion effect
+            mix::crossfade(smpsl, efxoutl, v1, v2, synth.buffersize);
+            mix::crossfade(smpsr, efxoutr, v1, v2, synth.buffersize);
         }
+    }
+    else { // System effect
+        mix::scale(efxoutl, 2.0f * volume, synth.buffersize);
+        mix::scale(efxoutr, 2.0f * volume, synth.buffersize);
+        memcpy(smpsl, efxoutl, synth.bufferbytes);
+        memcpy(smpsr, efxoutr, synth.bufferbytes);
+    }
 }
 
 
@@ -212,9 +212,9 @@ void Reverb::out(const Stereo<float *> &smp)
         bandwidth->process(buffersize, inputbuf);
 
     if(lpf)
-        lpf->filterout(inputbuf);
+        lpf->filterout(inputbuf, buffersize);
     if(hpf)
-        hpf->filterout(inputbuf);
+        hpf->filterout(inputbuf, buffersize);
 
     processmono(0, efxoutl, inputbuf); //left
     processmono(1, efxoutr, inputbuf); //right
@@ -404,7 +404,8 @@ void Reverb::settype(unsigned char _Ptype)
         //not been verified yet.
         //As this cannot be resized in a RT context, a good upper bound should
         //be found
-        bandwidth = memory.alloc<Unison>(&memory, buffersize / 4 + 1, 2.0f, samplerate_f);
+        bandwidth = memory.alloc<Unison>(&memory, buffersize / 4 + 1, 2.0f, samplerate_f,
+                                         prng());
         bandwidth->setSize(50);
         bandwidth->setBaseFrequency(1.0f);
     }
@@ -14,6 +14,7 @@
 #include <cassert>
 #include <utility>
 #include <cstdio>
+#include <atomic>
 #include "../../tlsf/tlsf.h"
 #include "Allocator.h"
 
@@ -44,9 +45,26 @@ struct AllocatorImpl
     //nice values
     next_t *pools = 0;
     unsigned long long totalAlloced = 0;
+
+    //TLSF itself is not thread safe, so when several realtime threads
+    //allocate from one pool the (short) critical sections get spun on
+    bool concurrent = false;
+    std::atomic_flag busy = ATOMIC_FLAG_INIT;
+
+    void lock(void)
+    {
+        if(concurrent)
+            while(busy.test_and_set(std::memory_order_acquire))
+                ;
+    }
+    void unlock(void)
+    {
+        if(concurrent)
+            busy.clear(std::memory_order_release);
+    }
 };
 
-Allocator::Allocator(void) : transaction_active()
+Allocator::Allocator(void) : transaction_active(), owns_impl(true)
 {
     impl = new AllocatorImpl;
     size_t default_size = 10*1024*1024;
@@ -59,8 +77,14 @@ Allocator::Allocator(void) : transaction_active()
     //printf("Allocator(%p)\n", impl);
 }
 
+Allocator::Allocator(AllocatorImpl *shared)
+    : impl(shared), transaction_active(), owns_impl(false)
+{}
+
 Allocator::~Allocator(void)
 {
+    if(!owns_impl)
+        return;
     next_t *n = impl->pools;
     while(n) {
         next_t *nn = n->next;
@@ -72,8 +96,10 @@ Allocator::~Allocator(void)
 
 void *AllocatorClass::alloc_mem(size_t mem_size)
 {
+    impl->lock();
     impl->totalAlloced += mem_size;
     void *mem = tlsf_malloc(impl->tlsf, mem_size);
+    impl->unlock();
     //printf("Allocator.malloc(%p, %d) = %p\n", impl, mem_size, mem);
     //void *mem = malloc(mem_size);
     //printf("Allocator result = %p\n", mem);
@@ -82,7 +108,9 @@ void *AllocatorClass::alloc_mem(size_t mem_size)
 void AllocatorClass::dealloc_mem(void *memory)
 {
     //printf("dealloc_mem(%d)\n", tlsf_block_size(memory));
+    impl->lock();
     tlsf_free(impl->tlsf, memory);
+    impl->unlock();
     //free(memory);
 }
 
@@ -120,6 +148,71 @@ void AllocatorClass::addMemory(void *v, size_t mem_size)
         printf("FAILED TO INSERT MEMORY POOL\n");
 };//{(void)mem_size;};
 
+static const size_t arena_align = alignof(std::max_align_t);
+
+NoteArena::NoteArena(Allocator &parent_, char *begin_, char *end_)
+    :Allocator(parent_.impl), parent(parent_), begin(begin_), next(begin_),
+    end(end_), live(0)
+{}
+
+size_t NoteArena::align(size_t size)
+{
+    return (size + arena_align - 1) & ~(arena_align - 1);
+}
+
+NoteArena *NoteArena::create(Allocator &memory, size_t size)
+{
+    NoteArena *outer = dynamic_cast<NoteArena*>(&memory);
+    Allocator &root  = outer ? outer->parent : memory;
+
+    size = align(size);
+    const size_t header = align(sizeof(NoteArena));
+    char *block = (char*)root.alloc_mem(header + arena_align + size);
+    if(!block)
+        return NULL;
+    char *begin = (char*)align((size_t)(block + header));
+    return new (block) NoteArena(root, begin, begin + size);
+}
+
+void *NoteArena::alloc_mem(size_t mem_size)
+{
+    const size_t size = align(mem_size);
+    if(size > (size_t)(end - next))
+        return parent.alloc_mem(mem_size);
+    void *mem = next;
+    next += size;
+    live++;
+    return mem;
+}
+
+void NoteArena::dealloc_mem(void *memory)
+{
+    //end itself is still inside the block (see create())
+    if((char*)memory < begin || (char*)memory > end) {
+        parent.dealloc_mem(memory);
+        return;
+    }
+    if(--live == 0)
+        discard();
+}
+
+void NoteArena::addMemory(void *v, size_t mem_size)
+{
+    parent.addMemory(v, mem_size);
+}
+
+bool NoteArena::lowMemory(unsigned n, size_t chunk_size) const
+{
+    return parent.lowMemory(n, chunk_size);
+}
+
+void NoteArena::discard(void)
+{
+    Allocator &root = parent;
+    this->~NoteArena();
+    root.dealloc_mem(this);
+}
+
 #ifndef INCLUDED_tlsfbits
 //From tlsf internals
 typedef struct block_header_t
@@ -200,6 +293,11 @@ unsigned long long Allocator::totalAlloced() const
     return impl->totalAlloced;
 }
 
+void Allocator::setConcurrent(bool concurrent)
+{
+    impl->concurrent = concurrent;
+}
+
 void Allocator::rollbackTransaction() {
 
     // if a transaction is active
@@ -120,14 +120,23 @@ class Allocator
 
     unsigned long long totalAlloced() const;
 
+    //Serialize alloc_mem/dealloc_mem between threads sharing this pool
+    //(e.g. parts rendered by a RenderPool). Off by default.
+    void setConcurrent(bool concurrent);
+
     struct AllocatorImpl *impl;
 
+protected:
+    //Use the pools of another allocator instead of creating new ones
+    explicit Allocator(struct AllocatorImpl *shared);
+
 private:
     const static size_t max_transaction_length = 256;
 
     void* transaction_alloc_content[max_transaction_length];
     size_t transaction_alloc_index;
     bool transaction_active;
+    bool owns_impl;
 
     void rollbackTransaction();
 
@@ -176,6 +185,53 @@ public:
 
 extern DummyAllocator DummyAlloc;
 
+//! one block taken from another allocator, holding a note and all of its
+//! subcomponents
+//!
+//! Allocations are placed one after another in the block and the whole
+//! block is returned once everything in it has been freed, so building and
+//! destroying a note costs one allocation and one free of the parent.
+//! Allocations that do not fit into the block (a too low size estimate,
+//! filters swapped while the note plays) fall back to the parent.
+class NoteArena : public Allocator
+{
+    public:
+        /**
+         * Take a block for a new note from memory
+         * Arenas are always taken from the root allocator, also when memory
+         * is the arena of another note (e.g. for legato clones).
+         * @param size bytes needed, see footprint()
+         * @return the arena or NULL if memory is exhausted
+         */
+        static NoteArena *create(Allocator &memory, size_t size);
+
+        //! bytes n objects of type T take in an arena
+        template <typename T>
+        static size_t footprint(size_t n = 1)
+        {
+            return align(n*sizeof(T));
+        }
+
+        void *alloc_mem(size_t mem_size);
+        void dealloc_mem(void *memory);
+        void addMemory(void *, size_t mem_size);
+        bool lowMemory(unsigned n, size_t chunk_size) const;
+
+        //! return the block to the parent, whatever is left in it
+        void discard(void);
+
+        size_t used(void) const {return next - begin;}
+        size_t capacity(void) const {return end - begin;}
+
+    private:
+        NoteArena(Allocator &parent, char *begin, char *end);
+        static size_t align(size_t size);
+
+        Allocator &parent;
+        char     *begin, *next, *end;
+        unsigned  live; //allocations within the block not freed yet
+};
+
 /**
  * General notes on Memory Allocation Within ZynAddSubFX
  * -----------------------------------------------------
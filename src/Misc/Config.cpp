@@ -51,6 +51,11 @@ static const rtosc::Ports ports = {
     rToggle(cfg.BankUIAutoClose, "Automatic Closing of BackUI After Patch Selection"),
     rParamI(cfg.GzipCompression, "Level of Gzip Compression For Save Files"),
     rParamI(cfg.Interpolation, "Level of Interpolation, Linear/Cubic"),
+    rParamI(cfg.RenderThreads, "Number of additional threads rendering parts in parallel (0 = off)"),
+    rParamI(cfg.DenormalPolicy, "Denormal protection, 0 = noise injection, 1 = flush to zero"),
+    rParamI(cfg.LoadTarget, "DSP load in percent above which voices are shed (0 = off)"),
+    rParamI(cfg.AudibleFloor, "Default level in dB below which released notes are retired (0 = off)"),
+    rParamI(cfg.PadCacheSize, "MB of generated PADsynth samples cached on disk (0 = off)"),
     rToggle(cfg.SaveFullXml, "Include Disabled parts in save"),
     {"cfg.presetsDirList", rDoc("list of preset search directories"), 0,
         [](const char *msg, rtosc::RtData &d)
@@ -210,6 +215,11 @@ void Config::init()
     cfg.GzipCompression = 3;
 
     cfg.Interpolation = 0;
+    cfg.RenderThreads = 0;
+    cfg.DenormalPolicy = 1;
+    cfg.LoadTarget = 0;
+    cfg.AudibleFloor = 0;
+    cfg.PadCacheSize = 0;
     cfg.SaveFullXml = 0;
     cfg.CheckPADsynth = 1;
     cfg.IgnoreProgramChange = 0;
@@ -344,6 +354,31 @@ void Config::readConfig(const char *filename)
                                            0,
                                            1);
 
+        cfg.RenderThreads = xmlcfg.getpar("render_threads",
+                                          cfg.RenderThreads,
+                                          0,
+                                          NUM_MIDI_PARTS);
+
+        cfg.DenormalPolicy = xmlcfg.getpar("denormal_policy",
+                                           cfg.DenormalPolicy,
+                                           0,
+                                           1);
+
+        cfg.LoadTarget = xmlcfg.getpar("load_target",
+                                       cfg.LoadTarget,
+                                       0,
+                                       100);
+
+        cfg.AudibleFloor = xmlcfg.getpar("audible_floor",
+                                         cfg.AudibleFloor,
+                                         -150,
+                                         0);
+
+        cfg.PadCacheSize = xmlcfg.getpar("pad_cache_size",
+                                         cfg.PadCacheSize,
+                                         0,
+                                         1 << 20);
+
         cfg.SaveFullXml  = xmlcfg.getpar("SaveFullXml",
                                            cfg.SaveFullXml,
                                            0,
@@ -460,6 +495,11 @@ void Config::saveConfig(const char *filename) const
         }
 
     xmlcfg->addpar("interpolation", cfg.Interpolation);
+    xmlcfg->addpar("render_threads", cfg.RenderThreads);
+    xmlcfg->addpar("denormal_policy", cfg.DenormalPolicy);
+    xmlcfg->addpar("load_target", cfg.LoadTarget);
+    xmlcfg->addpar("audible_floor", cfg.AudibleFloor);
+    xmlcfg->addpar("pad_cache_size", cfg.PadCacheSize);
     xmlcfg->addpar("SaveFullXml", cfg.SaveFullXml);
 
     //linux stuff
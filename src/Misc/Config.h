@@ -47,6 +47,11 @@ class Config
             int   BankUIAutoClose;
             int   GzipCompression;
             int   Interpolation;
+            int   RenderThreads; //additional threads rendering parts, 0 = off
+            int   DenormalPolicy; //0 = noise injection, 1 = flush to zero
+            int   LoadTarget; //DSP load in percent above which voices are shed, 0 = off
+            int   AudibleFloor; //dB below which released notes are retired, 0 = off
+            int   PadCacheSize; //MB of generated PADsynth samples kept on disk, 0 = off
             int   SaveFullXml; // when saving to a file save entire tree including disabled parts (Zynmuse)
             std::string bankRootDirList[MAX_BANK_ROOT_DIRS], currentBankDir;
             std::string presetsDirList[MAX_BANK_ROOT_DIRS];
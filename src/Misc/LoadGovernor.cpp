@@ -0,0 +1,51 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  LoadGovernor.cpp - Keeps the DSP load within a budget by shedding voices
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include "LoadGovernor.h"
+
+namespace zyn {
+
+//Weight of the newest buffer in the smoothed load
+#define GOVERNOR_SMOOTHING 0.1f
+//Buffers to wait after shedding, so the load can settle
+#define GOVERNOR_HOLDOFF   4
+//Voices shed at once when a buffer overruns its period
+#define GOVERNOR_OVERRUN   4
+
+LoadGovernor::LoadGovernor(const SYNTH_T &synth)
+    :target(0.0f), load(0.0f), lastload(0.0f), shed(0),
+     period(synth.buffersize_f / synth.samplerate_f), holdoff(0)
+{}
+
+void LoadGovernor::begin(void)
+{
+    start = clock::now();
+}
+
+int LoadGovernor::end(void)
+{
+    const float elapsed =
+        std::chrono::duration<float>(clock::now() - start).count();
+    lastload = elapsed / period;
+    load    += (lastload - load) * GOVERNOR_SMOOTHING;
+
+    if(target <= 0.0f || load <= target)
+        return 0;
+    if(holdoff > 0 && !overrun()) {
+        holdoff--;
+        return 0;
+    }
+
+    holdoff = GOVERNOR_HOLDOFF;
+    return overrun() ? GOVERNOR_OVERRUN : 1;
+}
+
+}
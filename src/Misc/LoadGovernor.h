@@ -0,0 +1,53 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  LoadGovernor.h - Keeps the DSP load within a budget by shedding voices
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#pragma once
+#include <chrono>
+#include "../globals.h"
+
+namespace zyn {
+
+/**
+ * Measures how long rendering a buffer takes compared to the length of the
+ * buffer and decides when voices have to be shed to avoid xruns.
+ *
+ * The load is a fraction of the period (1.0 = the buffer took as long to
+ * render as it takes to play it). While the smoothed load is above the
+ * target one voice is shed every few buffers, when a buffer overruns its
+ * period several voices are shed at once. Master picks the voices.
+ */
+class LoadGovernor
+{
+    public:
+        LoadGovernor(const SYNTH_T &synth);
+
+        /**Start timing a buffer*/
+        void begin(void) REALTIME;
+        /**Stop timing a buffer
+         * @return number of voices to shed, 0 within budget*/
+        int end(void) REALTIME;
+
+        //Load of the last buffer was above the period
+        bool overrun(void) const {return lastload >= 1.0f;}
+
+        float    target;   //load target, 0 disables shedding
+        float    load;     //smoothed load
+        float    lastload; //load of the last buffer
+        unsigned shed;     //voices shed since startup
+
+    private:
+        typedef std::chrono::steady_clock clock;
+        clock::time_point start;
+        float period;  //seconds per buffer
+        int   holdoff; //buffers to wait before shedding again
+};
+
+}
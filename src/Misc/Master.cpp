@@ -22,8 +22,12 @@
 #include "../Params/LFOParams.h"
 #include "../Effects/EffectMgr.h"
 #include "../DSP/FFTwrapper.h"
+#include "../DSP/Denormal.h"
+#include "../DSP/MixKernels.h"
 #include "../Misc/Allocator.h"
 #include "../Containers/ScratchString.h"
+#include "RenderPool.h"
+#include "WorkPool.h"
 #include "../Nio/Nio.h"
 #include "PresetExtractor.h"
 
@@ -428,6 +432,26 @@ static const Ports master_ports = {
     {"reset-vu:", rDoc("Grab VU Data"), 0, [](const char *, RtData &d) {
        Master *m = (Master*)d.obj;
        m->vuresetpeaks();}},
+    {"load:", rProp(read-only) rDoc("DSP load, smoothed and of the last buffer "
+        "(1.0 = the whole period)"), 0, [](const char *, RtData &d) {
+       Master *m = (Master*)d.obj;
+       d.reply(d.loc, "ff", m->governor.load, m->governor.lastload);}},
+    {"voices-shed:", rProp(read-only) rDoc("Voices released or killed to keep "
+        "the load below load-target"), 0, [](const char *, RtData &d) {
+       Master *m = (Master*)d.obj;
+       d.reply(d.loc, "i", (int)m->governor.shed);}},
+    {"load-target::i", rShort("load") rLinear(0,100)
+        rMap(unit, percent) rDoc("DSP load above which voices are shed, "
+        "in percent of the period (0 = off)"), 0,
+        [](const char *m, RtData &d) {
+        Master *master = (Master*)d.obj;
+        if(rtosc_narguments(m)==0) {
+            d.reply(d.loc, "i", (int)roundf(master->governor.target * 100.0f));
+        } else if(rtosc_narguments(m)==1 && rtosc_type(m,0)=='i') {
+            const int target = limit(rtosc_argument(m, 0).i, 0, 100);
+            master->governor.target = target / 100.0f;
+            d.broadcast(d.loc, "i", target);
+        }}},
     {"load-part:ib", rProp(internal) rDoc("Load Part From Middleware"), 0, [](const char *msg, RtData &d) {
        Master *m =  (Master*)d.obj;
        Part   *p = *(Part**)rtosc_argument(msg, 1).b.data;
@@ -764,9 +788,10 @@ void Master::loadAutomation(XMLwrapper &xml, rtosc::AutomationMgr &midi)
 Master::Master(const SYNTH_T &synth_, Config* config)
     :HDDRecorder(synth_), time(synth_), ctl(synth_, &time),
     microtonal(config->cfg.GzipCompression), bank(config),
-    automate(16,4,8),
+    governor(synth_), automate(16,4,8),
     frozenState(false), pendingMemory(false),
-    synth(synth_), gzip_compression(config->cfg.GzipCompression)
+    synth(synth_), gzip_compression(config->cfg.GzipCompression),
+    audible_floor(config->cfg.AudibleFloor)
 {
     SaveFullXml=(config->cfg.SaveFullXml==1);
     bToU = NULL;
@@ -786,6 +811,7 @@ Master::Master(const SYNTH_T &synth_, Config* config)
     swaplr = 0;
     off  = 0;
     smps = 0;
+    midiQueued = 0;
     bufl = new float[synth.buffersize];
     bufr = new float[synth.buffersize];
 
@@ -825,6 +851,19 @@ Master::Master(const SYNTH_T &synth_, Config* config)
 
     //Note Visualization
     memset(activeNotes, 0, sizeof(activeNotes));
+    memset(silentpart, 0, sizeof(silentpart));
+    memset(&routingState, 0, sizeof(routingState));
+
+    governor.target = config->cfg.LoadTarget / 100.0f;
+
+    //Parallel part rendering
+    renderPool = NULL;
+    renderpos  = 0;
+    rendern    = synth.buffersize;
+    if(config->cfg.RenderThreads > 0) {
+        renderPool = new RenderPool(config->cfg.RenderThreads, renderPart, this);
+        memory->setConcurrent(renderPool->threads() > 0);
+    }
 
     defaults();
 
@@ -929,6 +968,7 @@ void Master::defaults()
         part[npart]->defaults();
         part[npart]->partno  = npart % NUM_MIDI_CHANNELS;
         part[npart]->Prcvchn = npart % NUM_MIDI_CHANNELS;
+        part[npart]->Paudiblefloor = audible_floor;
     }
 
     partonoff(0, 1); //enable the first part
@@ -1246,6 +1286,15 @@ bool Master::runOSC(float *outl, float *outr, bool offline,
  * Master audio out (the final sound)
  */
 bool Master::AudioOut(float *outr, float *outl)
+{
+    denormal::ScopedFlush flush;
+    if(!beginBlock(outr, outl))
+        return false;
+    renderBuffer(outr, outl, 0);
+    return true;
+}
+
+bool Master::beginBlock(float *outr, float *outl)
 {
     //Danger Limits
     if(memory->lowMemory(2,1024*1024))
@@ -1261,12 +1310,18 @@ bool Master::AudioOut(float *outr, float *outl)
     if(!runOSC(outl, outr, false))
         return false;
 
-
     //Handle watch points
     if(bToU)
         watcher.write_back = bToU;
     watcher.tick();
 
+    updateRouting();
+    return true;
+}
+
+void Master::renderBuffer(float *outr, float *outl, uint32_t start)
+{
+    governor.begin();
 
     //Swaps the Left channel with Right Channel
     if(swaplr)
@@ -1277,26 +1332,36 @@ bool Master::AudioOut(float *outr, float *outl)
     memset(outr, 0, synth.bufferbytes);
 
     //Compute part samples and store them part[npart]->partoutl,partoutr
-    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
-        if(part[npart]->Penabled)
-            part[npart]->ComputePartSmps();
+    //The queued MIDI splits the buffer, so each message lands on its frame
+    for(int pos = 0; pos < synth.buffersize;) {
+        applyQueuedMidi(start + pos);
+        int end = synth.buffersize;
+        if(midiQueued && midiQueue[0].frame - start < (uint32_t)end)
+            end = midiQueue[0].frame - start;
+        renderParts(pos, end - pos);
+        pos = end;
+    }
+
+    //Idle parts can be left out of the mix, unless an insertion effect
+    //may still be ringing out on their output
+    memset(silentpart, 0, sizeof(silentpart));
+    for(int i = 0; i < routing.nparts; ++i)
+        silentpart[routing.parts[i]] = part[routing.parts[i]]->idle();
 
     //Insertion effects
-    for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx)
-        if(Pinsparts[nefx] >= 0) {
-            int efxpart = Pinsparts[nefx];
-            if(part[efxpart]->Penabled)
-                insefx[nefx]->out(part[efxpart]->partoutl,
-                                  part[efxpart]->partoutr);
-        }
+    for(int i = 0; i < routing.npartins; ++i) {
+        const RoutingGraph::InsertionEdge &edge = routing.partins[i];
+        silentpart[edge.part] = false;
+        insefx[edge.efx]->out(part[edge.part]->partoutl,
+                              part[edge.part]->partoutr);
+    }
 
 
     float gainbuf[synth.buffersize];
 
     //Apply the part volumes and pannings (after insertion effects)
-    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart) {
-        if(!part[npart]->Penabled)
-            continue;
+    for(int i = 0; i < routing.nparts; ++i) {
+        const int npart = routing.parts[i];
 
         Stereo<float> newvol(part[npart]->gain);
 
@@ -1308,36 +1373,28 @@ bool Master::AudioOut(float *outr, float *outl)
         //if(npart==0)
         //printf("[%d]vol = %f->%f\n", npart, oldvol.l, newvol.l);
 
+        //Scaling silence only matters for the smoothing state
+        if(silentpart[npart]
+                && smoothing_part_l[npart].target_reached(newvol.l)
+                && smoothing_part_r[npart].target_reached(newvol.r))
+            continue;
 
 
         /* This is where the part volume (and pan) smoothing and application happens */
         if ( smoothing_part_l[npart].apply( gainbuf, synth.buffersize, newvol.l ) )
-        {
-            for ( int i = 0; i < synth.buffersize; ++i )
-                part[npart]->partoutl[i] *= gainbuf[i];
-        }
+            mix::scaleBuf(part[npart]->partoutl, gainbuf, synth.buffersize);
         else
-        {
-            for ( int i = 0; i < synth.buffersize; ++i )
-                part[npart]->partoutl[i] *= newvol.l;
-        }
+            mix::scale(part[npart]->partoutl, newvol.l, synth.buffersize);
 
         if ( smoothing_part_r[npart].apply( gainbuf, synth.buffersize, newvol.r ) )
-        {
-            for ( int i = 0; i < synth.buffersize; ++i )
-                part[npart]->partoutr[i] *= gainbuf[i];
-        }
+            mix::scaleBuf(part[npart]->partoutr, gainbuf, synth.buffersize);
         else
-        {
-            for ( int i = 0; i < synth.buffersize; ++i )
-                part[npart]->partoutr[i] *= newvol.r;
-        }
+            mix::scale(part[npart]->partoutr, newvol.r, synth.buffersize);
     }
 
-    //System effects
-    for(int nefx = 0; nefx < NUM_SYS_EFX; ++nefx) {
-        if(sysefx[nefx]->geteffect() == 0)
-            continue;  //the effect is disabled
+    //System effects, in effect order (which is also level order)
+    for(int i = 0; i < routing.nsysefx; ++i) {
+        const RoutingGraph::SysefxNode &node = routing.sysefx[i];
 
         float tmpmixl[synth.buffersize];
         float tmpmixr[synth.buffersize];
@@ -1345,56 +1402,44 @@ bool Master::AudioOut(float *outr, float *outl)
         memset(tmpmixl, 0, synth.bufferbytes);
         memset(tmpmixr, 0, synth.bufferbytes);
 
-        //Mix the channels according to the part settings about System Effect
-        for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart) {
-            //skip if the part has no output to effect
-            if(Psysefxvol[nefx][npart] == 0)
-                continue;
-
-            //skip if the part is disabled
-            if(part[npart]->Penabled == 0)
+        //Mix the parts sending to this effect
+        for(int j = 0; j < node.nparts; ++j) {
+            const int npart = node.part[j];
+            if(silentpart[npart])
                 continue;
-
-            //the output volume of each part to system effect
-            const float vol = sysefxvol[nefx][npart];
-            for(int i = 0; i < synth.buffersize; ++i) {
-                tmpmixl[i] += part[npart]->partoutl[i] * vol;
-                tmpmixr[i] += part[npart]->partoutr[i] * vol;
-            }
+            const float vol = node.partgain[j];
+            mix::addScaled(tmpmixl, part[npart]->partoutl, vol, synth.buffersize);
+            mix::addScaled(tmpmixr, part[npart]->partoutr, vol, synth.buffersize);
         }
 
-        // system effect send to next ones
-        for(int nefxfrom = 0; nefxfrom < nefx; ++nefxfrom)
-            if(Psysefxsend[nefxfrom][nefx] != 0) {
-                const float vol = sysefxsend[nefxfrom][nefx];
-                for(int i = 0; i < synth.buffersize; ++i) {
-                    tmpmixl[i] += sysefx[nefxfrom]->efxoutl[i] * vol;
-                    tmpmixr[i] += sysefx[nefxfrom]->efxoutr[i] * vol;
-                }
-            }
+        //Mix the earlier system effects sending to this one
+        for(int j = 0; j < node.nsends; ++j) {
+            const EffectMgr *from = sysefx[node.from[j]];
+            const float      vol  = node.fromgain[j];
+            mix::addScaled(tmpmixl, from->efxoutl, vol, synth.buffersize);
+            mix::addScaled(tmpmixr, from->efxoutr, vol, synth.buffersize);
+        }
 
-        sysefx[nefx]->out(tmpmixl, tmpmixr);
+        sysefx[node.efx]->out(tmpmixl, tmpmixr);
 
         //Add the System Effect to sound output
-        const float outvol = sysefx[nefx]->sysefxgetvolume();
-        for(int i = 0; i < synth.buffersize; ++i) {
-            outl[i] += tmpmixl[i] * outvol;
-            outr[i] += tmpmixr[i] * outvol;
-        }
+        const float outvol = sysefx[node.efx]->sysefxgetvolume();
+        mix::addScaled(outl, tmpmixl, outvol, synth.buffersize);
+        mix::addScaled(outr, tmpmixr, outvol, synth.buffersize);
     }
 
     //Mix all parts
-    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
-        if(part[npart]->Penabled)   //only mix active parts
-            for(int i = 0; i < synth.buffersize; ++i) { //the volume did not changed
-                outl[i] += part[npart]->partoutl[i];
-                outr[i] += part[npart]->partoutr[i];
-            }
+    for(int i = 0; i < routing.nparts; ++i) {
+        const int npart = routing.parts[i];
+        if(!silentpart[npart]) { //only mix active parts
+            mix::add(outl, part[npart]->partoutl, synth.buffersize);
+            mix::add(outr, part[npart]->partoutr, synth.buffersize);
+        }
+    }
 
     //Insertion effects for Master Out
-    for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx)
-        if(Pinsparts[nefx] == -2)
-            insefx[nefx]->out(outl, outr);
+    for(int i = 0; i < routing.nmasterins; ++i)
+        insefx[routing.masterins[i]]->out(outl, outr);
 
     float vol = dB2rap(Volume);
 
@@ -1402,19 +1447,13 @@ bool Master::AudioOut(float *outr, float *outl)
     /* this is where the master volume smoothing and application happens */
     if ( smoothing.apply( gainbuf, synth.buffersize, vol ) )
     {
-        for ( int i = 0; i < synth.buffersize; ++i )
-        {
-            outl[i] *= gainbuf[i];
-            outr[i] *= gainbuf[i];
-        }
+        mix::scaleBuf(outl, gainbuf, synth.buffersize);
+        mix::scaleBuf(outr, gainbuf, synth.buffersize);
     }
     else
     {
-        for ( int i = 0; i < synth.buffersize; ++i )
-        {
-            outl[i] *= vol;
-            outr[i] *= vol;
-        }
+        mix::scale(outl, vol, synth.buffersize);
+        mix::scale(outr, vol, synth.buffersize);
     }
 
     vuUpdate(outl, outr);
@@ -1447,8 +1486,68 @@ bool Master::AudioOut(float *outr, float *outl)
     //Update pulse
     last_ack = last_beat;
 
+    //Lighten the next buffers if this one was too expensive
+    const int shed = governor.end();
+    if(shed)
+        shedVoices(shed, governor.overrun());
+}
 
-    return true;
+void Master::shedVoices(int count, bool hard)
+{
+    while(count-- > 0) {
+        Part *victim   = NULL;
+        float quietest = 0.0f;
+        for(int i = 0; i < routing.nparts; ++i) {
+            Part *p = part[routing.parts[i]];
+            const float level = p->quietestVoice();
+            if(level >= 0.0f && (!victim || level < quietest)) {
+                victim   = p;
+                quietest = level;
+            }
+        }
+        if(!victim)
+            return;
+
+        victim->shedVoice(hard);
+        governor.shed++;
+    }
+}
+
+void Master::updateRouting(void)
+{
+    RoutingGraph::State &s = routingState;
+    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+        s.partEnabled[npart] = part[npart]->Penabled;
+    for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx) {
+        s.insparts[nefx] = Pinsparts[nefx];
+        s.insefx[nefx]   = insefx[nefx]->geteffect();
+    }
+    for(int nefx = 0; nefx < NUM_SYS_EFX; ++nefx)
+        s.sysefx[nefx] = sysefx[nefx]->geteffect();
+    memcpy(s.sysvol, Psysefxvol, sizeof(s.sysvol));
+    memcpy(s.syssend, Psysefxsend, sizeof(s.syssend));
+
+    routing.update(s, sysefxvol, sysefxsend);
+}
+
+void Master::renderPart(void *master, int idx)
+{
+    Master &m = *(Master*)master;
+    m.part[m.routing.parts[idx]]->ComputePartSmps(m.renderpos, m.rendern);
+}
+
+void Master::renderParts(int pos, int nsamples)
+{
+    //Watch points report through a single ThreadLink, so stay serial while
+    //any of them are active
+    if(renderPool && !watcher.any_active()) {
+        renderpos = pos;
+        rendern   = nsamples;
+        renderPool->run(routing.nparts);
+    }
+    else
+        for(int i = 0; i < routing.nparts; ++i)
+            part[routing.parts[i]]->ComputePartSmps(pos, nsamples);
 }
 
 //TODO review the respective code from yoshimi for this
@@ -1458,41 +1557,108 @@ void Master::GetAudioOutSamples(size_t nsamples,
                                 float *outl,
                                 float *outr)
 {
+    denormal::ScopedFlush flush;
     off_t out_off = 0;
 
     //Fail when resampling rather than doing a poor job
     if(synth.samplerate != samplerate) {
         printf("darn it: %d vs %d\n", synth.samplerate, samplerate);
+        midiQueued = 0;
         return;
     }
 
-    while(nsamples) {
-        //use all available samples
-        if(nsamples >= smps) {
-            memcpy(outl + out_off, bufl + off, sizeof(float) * smps);
-            memcpy(outr + out_off, bufr + off, sizeof(float) * smps);
-            nsamples -= smps;
-
-            //generate samples
-            if (! AudioOut(bufl, bufr))
-                return;
+    //OSC, the watch points and the routing are handled once for the call
+    if(!beginBlock(bufl, bufr)) {
+        midiQueued = 0;
+        return;
+    }
 
+    while(nsamples) {
+        //generate samples once the previous buffer is used up
+        if(smps == 0) {
+            renderBuffer(bufl, bufr, out_off);
             off  = 0;
-            out_off  += smps;
             smps = synth.buffersize;
         }
-        else {   //use some samples
-            memcpy(outl + out_off, bufl + off, sizeof(float) * nsamples);
-            memcpy(outr + out_off, bufr + off, sizeof(float) * nsamples);
-            smps    -= nsamples;
-            off     += nsamples;
-            nsamples = 0;
-        }
+
+        const size_t n = nsamples < smps ? nsamples : smps;
+        memcpy(outl + out_off, bufl + off, sizeof(float) * n);
+        memcpy(outr + out_off, bufr + off, sizeof(float) * n);
+        smps     -= n;
+        off      += n;
+        out_off  += n;
+        nsamples -= n;
+    }
+
+    //Anything left over lands in the next buffer
+    applyQueuedMidi(UINT32_MAX);
+}
+
+bool Master::queueMidi(uint32_t frame, const uint8_t *data, int size)
+{
+    if(midiQueued == MAX_QUEUED_MIDI || size < 1 || size > 3)
+        return false;
+    const uint8_t status = data[0] & 0xf0;
+    if(status < 0x80 || status == 0xc0 || status == 0xd0 || status == 0xf0)
+        return false;
+    if(midiQueued && midiQueue[midiQueued - 1].frame > frame)
+        return false;
+
+    TimedMidi &ev = midiQueue[midiQueued++];
+    ev.frame = frame;
+    memset(ev.data, 0, sizeof(ev.data));
+    memcpy(ev.data, data, size);
+    return true;
+}
+
+void Master::applyQueuedMidi(uint32_t frame)
+{
+    int applied = 0;
+    while(applied < midiQueued && midiQueue[applied].frame <= frame) {
+        midiMessage(midiQueue[applied].data, 3);
+        applied++;
+    }
+    if(!applied)
+        return;
+    midiQueued -= applied;
+    memmove(midiQueue, midiQueue + applied, midiQueued * sizeof(TimedMidi));
+}
+
+bool Master::midiMessage(const uint8_t *data, int size)
+{
+    if(size < 1)
+        return false;
+    const uint8_t status  = data[0] & 0xf0;
+    const char    channel = data[0] & 0x0f;
+    const uint8_t d1      = size > 1 ? data[1] : 0;
+    const uint8_t d2      = size > 2 ? data[2] : 0;
+
+    switch(status) {
+        case 0x80:
+            noteOff(channel, d1);
+            return true;
+        case 0x90:
+            noteOn(channel, d1, d2);
+            return true;
+        case 0xa0:
+            polyphonicAftertouch(channel, d1, d2);
+            return true;
+        case 0xb0:
+            setController(channel, d1, d2);
+            return true;
+        case 0xe0:
+            setController(channel, C_pitchwheel, ((d2 << 7) | d1) - 8192);
+            return true;
+        default:
+            return false;
     }
 }
 
 Master::~Master()
 {
+    //join the render threads before the parts go away
+    delete renderPool;
+
     delete []bufl;
     delete []bufr;
 
@@ -1570,8 +1736,19 @@ void Master::vuresetpeaks()
 
 void Master::applyparameters(void)
 {
+#ifdef WIN32
     for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
         part[npart]->applyparameters();
+#else
+    //The parts are independent, they are prepared side by side
+    std::shared_ptr<WorkPool> pool = WorkPool::shared();
+    WorkPool::Group parts(*pool, WorkPool::priority());
+    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart) {
+        Part *p = part[npart];
+        parts.run([p]{p->applyparameters();});
+    }
+    parts.wait();
+#endif
 }
 
 void Master::initialize_rt(void)
@@ -24,6 +24,8 @@
 #include "Time.h"
 #include "Bank.h"
 #include "Recorder.h"
+#include "RoutingGraph.h"
+#include "LoadGovernor.h"
 
 #include "../Params/Controller.h"
 #include "../Synth/WatchPoint.h"
@@ -31,6 +33,9 @@
 
 namespace zyn {
 
+//Maximum number of MIDI messages queued for one GetAudioOutSamples() call
+#define MAX_QUEUED_MIDI 512
+
 class Allocator;
 
 struct vuData {
@@ -131,6 +136,18 @@ class Master
                                 unsigned samplerate,
                                 float *outl,
                                 float *outr) REALTIME;
+        /**Queue a MIDI channel message to be applied frame samples into
+         * the next GetAudioOutSamples() call.
+         * Messages have to be queued in frame order. Each one takes effect
+         * at its frame, unless an internal buffer carried over from the
+         * last call covers it already (the host block is not a multiple
+         * of the buffer size), then at the start of the next buffer.
+         * Program changes are not handled by Master.
+         * @return false if the message was not queued*/
+        bool queueMidi(uint32_t frame, const uint8_t *data, int size) REALTIME;
+        /**Apply a MIDI channel message right away
+         * @return false if the message is not handled by Master*/
+        bool midiMessage(const uint8_t *data, int size) REALTIME;
 
 
         void partonoff(int npart, int what);
@@ -200,6 +217,9 @@ class Master
         //Other watchers
         WatchManager watcher;
 
+        //DSP load measurement and voice shedding
+        LoadGovernor governor;
+
         //Midi Learn
         rtosc::AutomationMgr automate;
         rtosc::MidiMapperRT midi;
@@ -211,6 +231,7 @@ class Master
         bool pendingMemory;
         const SYNTH_T &synth;
         const int& gzip_compression; //!< value from config
+        const int& audible_floor; //!< value from config, given to the parts
         bool SaveFullXml; // value from config
 
         //Heartbeat for identifying plugin offline modes
@@ -243,6 +264,23 @@ class Master
         off_t  off;
         size_t smps;
 
+        //MIDI waiting for the next GetAudioOutSamples() call
+        struct TimedMidi {
+            uint32_t frame;
+            uint8_t  data[3];
+        };
+        TimedMidi midiQueue[MAX_QUEUED_MIDI];
+        int       midiQueued;
+        void applyQueuedMidi(uint32_t frame) REALTIME;
+
+        //AudioOut() in two steps, so GetAudioOutSamples() can handle OSC,
+        //the memory checks, the watch points and the routing once per call
+        //instead of once per buffer. renderBuffer() applies the queued MIDI
+        //at the frames start..start+buffersize of the call within the
+        //buffer. The arguments are in the order of the AudioOut() definition
+        bool beginBlock(float *outr, float *outl) REALTIME;
+        void renderBuffer(float *outr, float *outl, uint32_t start) REALTIME;
+
         //Callback When Master changes
         void(*mastercb)(void*,Master*);
         void* mastercb_ptr;
@@ -260,6 +298,24 @@ class Master
 
         Value_Smoothing_Filter smoothing_part_l[NUM_MIDI_PARTS];
         Value_Smoothing_Filter smoothing_part_r[NUM_MIDI_PARTS];
+
+        //Parts whose output is known to be silent this buffer
+        bool silentpart[NUM_MIDI_PARTS];
+
+        //Release or kill the quietest voices to bring the load down
+        void shedVoices(int count, bool hard) REALTIME;
+
+        //Live parts and effect edges, recompiled when the routing changes
+        RoutingGraph        routing;
+        RoutingGraph::State routingState;
+        void updateRouting(void) REALTIME;
+
+        //Parallel part rendering (NULL if single threaded)
+        class RenderPool *renderPool;
+        static void renderPart(void *master, int idx) REALTIME;
+        //Samples of the buffer renderPart() computes, see renderParts()
+        int renderpos, rendern;
+        void renderParts(int pos, int nsamples) REALTIME;
 };
 
 class master_dispatcher_t : public rtosc::savefile_dispatcher_t
@@ -40,17 +40,19 @@
 #include "MsgParsing.h"
 #include "Part.h"
 #include "PresetExtractor.h"
+#include "WorkPool.h"
 #include "../Containers/MultiPseudoStack.h"
 #include "../Params/PresetsStore.h"
 #include "../Params/ADnoteParameters.h"
 #include "../Params/SUBnoteParameters.h"
 #include "../Params/PADnoteParameters.h"
+#include "../Params/PADcache.h"
+#include "../Params/PADstore.h"
 #include "../DSP/FFTwrapper.h"
 #include "../Synth/OscilGen.h"
 #include "../Nio/Nio.h"
 
 #include <string>
-#include <future>
 #include <atomic>
 #include <list>
 
@@ -198,6 +200,8 @@ void deallocate(const char *str, void *v)
     else if(!strcmp(str, "Microtonal"))
         delete (Microtonal*)v;
     else if(!strcmp(str, "PADsample"))
+        padstore::release((float*)v);
+    else if(!strcmp(str, "OscilMips"))
         delete[] (float*)v;
     else
         fprintf(stderr, "Unknown type '%s', leaking pointer %p!!\n", str, v);
@@ -208,42 +212,79 @@ void deallocate(const char *str, void *v)
  *                    PadSynth Setup                                         *
  *****************************************************************************/
 
-// This lets MiddleWare compute non-realtime PAD synth data and send it to the backend
-void preparePadSynth(string path, PADnoteParameters *p, rtosc::RtData &d)
+// Hand sample N of the pad at path over to the backend
+static void writePadSample(const string &path, unsigned N,
+                           const PADnoteParameters::Sample &s,
+                           rtosc::ThreadLink &uToB)
 {
-    //printf("preparing padsynth parameters\n");
-    assert(!path.empty());
-    path += "sample";
+    // send non-realtime computed data to PADnoteParameters
+    uToB.write((path+"sample"+to_s(N)).c_str(), "ifbf",
+               s.size, s.basefreq, sizeof(float*), &s.smp, s.scale);
+}
+
+// Clear out the samples of a set of num samples that are not used
+static void clearPadSamples(const string &path, unsigned num,
+                            rtosc::ThreadLink &uToB)
+{
+    for(unsigned i = num; i < PAD_MAX_SAMPLES; ++i) {
+        uToB.write((path+"sample"+to_s(i)).c_str(), "ifbf",
+                   0, 440.0f, sizeof(float*), NULL, 0.0f);
+    }
+}
 
+// Generate one set of samples and write each of them to the backend as soon
+// as it is finished, broadcasting the progress on <path>progress
+static void sendPadSamples(const string &path, PADnoteParameters *p,
+                           rtosc::RtData &d, rtosc::ThreadLink &uToB,
+                           bool draft, std::function<bool()> do_abort)
+{
 #ifdef WIN32
-    unsigned num = p->sampleGenerator([&path,&d]
-                       (unsigned N, PADnoteParameters::Sample &&s)
-                       {
-                           //printf("sending info to '%s'\n",
-                           //       (path+to_s(N)).c_str());
-                           d.chain((path+to_s(N)).c_str(), "ifb",
-                                   s.size, s.basefreq, sizeof(float*), &s.smp);
-                       }, []{return false;}, 1);
+    //C++11 threads are broken on mingw cross compilation
+    const unsigned max_threads = 1;
 #else
+    const unsigned max_threads = 0;
+#endif
+    const string progress = path + "progress";
+    const int    total    = p->sampleCount(draft);
+    int          done     = 0;
+
     std::mutex rtdata_mutex;
-    unsigned num = p->sampleGenerator([&rtdata_mutex, &path,&d]
-                       (unsigned N, PADnoteParameters::Sample&& s)
+    unsigned num = p->sampleGenerator([&](unsigned N,
+                                          PADnoteParameters::Sample&& s)
                        {
-                           //printf("sending info to '%s'\n",
-                           //       (path+to_s(N)).c_str());
-                           rtdata_mutex.lock();
-                           // send non-realtime computed data to PADnoteParameters
-                           d.chain((path+to_s(N)).c_str(), "ifb",
-                                   s.size, s.basefreq, sizeof(float*), &s.smp);
-                           rtdata_mutex.unlock();
-                       }, []{return false;});
-#endif
+                           std::lock_guard<std::mutex> lock(rtdata_mutex);
+                           writePadSample(path, N, s, uToB);
+                           d.broadcast(progress.c_str(), "iii",
+                                       draft ? 0 : 1, ++done, total);
+                       }, do_abort, max_threads, draft);
+
+    //A draft has fewer samples than the full set. Notes keep playing the
+    //old samples above it until the full set replaces them
+    if(!draft)
+        clearPadSamples(path, num, uToB);
+}
 
-    //clear out unused samples
-    for(unsigned i = num; i < PAD_MAX_SAMPLES; ++i) {
-        d.chain((path+to_s(i)).c_str(), "ifb",
-                0, 440.0f, sizeof(float*), NULL);
+// This lets MiddleWare compute non-realtime PAD synth data and send it to the backend
+//
+// With progressive set, a pad whose samples take long to generate (see
+// PADnoteParameters::needsDraft()) first gets a quick low resolution draft
+// set, so it can be played right away. The full quality samples replace the
+// draft one by one as they are finished. Samples go straight to the backend
+// instead of being chained, as chained messages are only handled after the
+// whole generation.
+void preparePadSynth(string path, PADnoteParameters *p, rtosc::RtData &d,
+                     rtosc::ThreadLink &uToB, bool progressive,
+                     std::function<bool()> do_abort = []{return false;})
+{
+    //printf("preparing padsynth parameters\n");
+    assert(!path.empty());
+
+    if(progressive && p->needsDraft()) {
+        //The draft is played right away, it goes before anything else
+        WorkPool::PriorityScope urgent(WorkPool::PRIO_ACTIVE);
+        sendPadSamples(path, p, d, uToB, true, do_abort);
     }
+    sendPadSamples(path, p, d, uToB, false, do_abort);
 }
 
 /******************************************************************************
@@ -415,11 +456,13 @@ struct NonRtObjStore
             d.obj = nullptr; // tell walk_ports that there's nothing to recurse here...
         }
     }
-    void handlePad(const char *msg, rtosc::RtData &d) {
+    void handlePad(const char *msg, rtosc::RtData &d, rtosc::ThreadLink &uToB) {
         string obj_rl(d.message, msg);
         void *pad = get(obj_rl);
         if(!strcmp(msg, "prepare")) {
-            preparePadSynth(obj_rl, (PADnoteParameters*)pad, d);
+            //The user edits this pad and waits for it
+            WorkPool::PriorityScope urgent(WorkPool::PRIO_ACTIVE);
+            preparePadSynth(obj_rl, (PADnoteParameters*)pad, d, uToB, true);
             d.matches++;
             d.reply((obj_rl+"needPrepare").c_str(), "F");
         } else {
@@ -593,16 +636,18 @@ public:
         assert(actual_load[npart] <= pending_load[npart]);
         assert(filename);
 
-        //load part in async fashion when possible
+        //load part in async fashion when possible, ahead of any other
+        //loading work as the part is likely to be played next
 #ifndef WIN32
-        auto alloc = std::async(std::launch::async,
-                [master,filename,this,npart](){
-                Part *p = new Part(*master->memory, synth,
-                                   master->time,
-                                   config->cfg.GzipCompression,
-                                   config->cfg.Interpolation,
-                                   &master->microtonal, master->fft, &master->watcher,
-                                   ("/part"+to_s(npart)+"/").c_str());
+        Part *p = nullptr;
+        WorkPool::Group alloc(*workers, WorkPool::PRIO_ACTIVE);
+        alloc.run([master,filename,this,npart,&p](){
+                p = new Part(*master->memory, synth,
+                             master->time,
+                             config->cfg.GzipCompression,
+                             config->cfg.Interpolation,
+                             &master->microtonal, master->fft, &master->watcher,
+                             ("/part"+to_s(npart)+"/").c_str());
                 if(p->loadXMLinstrument(filename))
                     fprintf(stderr, "Warning: failed to load part<%s>!\n", filename);
 
@@ -610,17 +655,16 @@ public:
                 return actual_load[npart] != pending_load[npart];
                 };
 
-                p->applyparameters(isLateLoad);
-                return p;});
+                p->applyparameters(isLateLoad, true);});
 
         //Load the part
         if(idle) {
-            while(alloc.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            while(!alloc.done()) {
                 idle(idle_ptr);
             }
         }
 
-        Part *p = alloc.get();
+        alloc.wait();
 #else
         Part *p = new Part(*master->memory, synth, master->time,
                 config->cfg.GzipCompression,
@@ -634,7 +678,7 @@ public:
             return actual_load[npart] != pending_load[npart];
         };
 
-        p->applyparameters(isLateLoad);
+        p->applyparameters(isLateLoad, true);
 #endif
 
         obj_store.extractPart(p, npart);
@@ -644,6 +688,83 @@ public:
         //deallocation
         parent->transmitMsg("/load-part", "ib", npart, sizeof(Part*), &p);
         d.broadcast("/damage", "s", ("/part"+to_s(npart)+"/").c_str());
+
+        //The part plays with the draft sets, now replace them by the full
+        //samples (unless another part is loaded meanwhile)
+        auto isLateLoad = [this,npart]{
+            return actual_load[npart] != pending_load[npart];
+        };
+        const string part_path = "/part"+to_s(npart)+"/";
+#ifndef WIN32
+        //The sets are generated in the pool while this thread keeps the UI
+        //running, so a newer load can abort them. Finished samples are
+        //written to the backend from here, as uToB belongs to this thread.
+        struct Finished {
+            int      kit;
+            unsigned N;
+            PADnoteParameters::Sample s;
+        };
+        std::mutex            finished_mutex;
+        std::vector<Finished> finished;
+        int total[NUM_KIT_ITEMS] = {0};
+        int done[NUM_KIT_ITEMS]  = {0};
+        int num[NUM_KIT_ITEMS]   = {0};
+
+        WorkPool::Group full(*workers, WorkPool::PRIO_LOAD, isLateLoad);
+        for(int k = 0; k < NUM_KIT_ITEMS; ++k) {
+            PADnoteParameters *pad = p->kit[k].padpars;
+            if(!p->kit[k].Ppadenabled || !pad || !pad->needsDraft())
+                continue;
+            total[k] = pad->sampleCount();
+            full.run([pad,k,&num,&finished,&finished_mutex,isLateLoad]{
+                    num[k] = pad->sampleGenerator([&,k](unsigned N,
+                                PADnoteParameters::Sample&& s) {
+                            std::lock_guard<std::mutex> lock(finished_mutex);
+                            finished.push_back(Finished{k, N, s});
+                            }, isLateLoad);});
+        }
+
+        auto flush = [&]{
+            std::vector<Finished> ready;
+            {
+                std::lock_guard<std::mutex> lock(finished_mutex);
+                ready.swap(finished);
+            }
+            for(auto &f:ready) {
+                //the path belongs to the newer part now
+                if(isLateLoad()) {
+                    padstore::release(f.s.smp);
+                    continue;
+                }
+                const string path = part_path+"kit"+to_s(f.kit)+"/padpars/";
+                writePadSample(path, f.N, f.s, *uToB);
+                d.broadcast((path+"progress").c_str(), "iii",
+                            1, ++done[f.kit], total[f.kit]);
+            }
+        };
+
+        while(!full.done()) {
+            if(idle)
+                idle(idle_ptr);
+            else
+                os_usleep(1000);
+            flush();
+        }
+        full.wait();
+        flush();
+
+        for(int k = 0; k < NUM_KIT_ITEMS; ++k)
+            if(total[k] && !isLateLoad())
+                clearPadSamples(part_path+"kit"+to_s(k)+"/padpars/", num[k],
+                                *uToB);
+#else
+        for(int k = 0; k < NUM_KIT_ITEMS; ++k) {
+            PADnoteParameters *pad = p->kit[k].padpars;
+            if(p->kit[k].Ppadenabled && pad && pad->needsDraft())
+                preparePadSynth(part_path+"kit"+to_s(k)+"/padpars/",
+                                pad, d, *uToB, false, isLateLoad);
+        }
+#endif
     }
 
     //Load a new cleared Part instance
@@ -973,6 +1094,10 @@ public:
     //Synth Engine Parameters
     ParamStore kits;
 
+    //Pool of the non-realtime jobs, shared with the other instances of the
+    //process and kept alive by them
+    std::shared_ptr<WorkPool> workers;
+
     //Callback When Waiting on async events
     void(*idle)(void*);
     void* idle_ptr;
@@ -1491,7 +1616,7 @@ static rtosc::Ports nonRtParamPorts = {
     {"part#" STRINGIFY(NUM_MIDI_PARTS)
         "/kit#" STRINGIFY(NUM_KIT_ITEMS) "/padpars/", 0, &PADnoteParameters::non_realtime_ports,
         rBegin
-        impl.obj_store.handlePad(chomp(chomp(chomp(msg))), d);
+        impl.obj_store.handlePad(chomp(chomp(chomp(msg))), d, *impl.uToB);
         rEnd},
 };
 
@@ -1934,6 +2059,9 @@ MiddleWareImpl::MiddleWareImpl(MiddleWare *mw, SYNTH_T synth_,
         fprintf(stderr, "lo server could not be started :-/\n");
 
 
+    padcache::setLimit((uint64_t)config->cfg.PadCacheSize << 20);
+    workers = WorkPool::shared();
+
     //dummy callback for starters
     cb = [](void*, const char*){};
     idle = 0;
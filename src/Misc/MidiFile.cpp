@@ -0,0 +1,200 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  MidiFile.cpp - Standard MIDI file reader
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "MidiFile.h"
+
+namespace zyn {
+
+//Default tempo of 120 BPM
+#define DEFAULT_TEMPO 500000
+
+static uint32_t be32(const uint8_t *p)
+{
+    return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static uint16_t be16(const uint8_t *p)
+{
+    return (p[0] << 8) | p[1];
+}
+
+//Variable length quantity, returns false when running past the end
+static bool readVarLen(const uint8_t *data, size_t len, size_t &pos,
+                       uint32_t &value)
+{
+    value = 0;
+    for(int i = 0; i < 4; ++i) {
+        if(pos >= len)
+            return false;
+        const uint8_t byte = data[pos++];
+        value = (value << 7) | (byte & 0x7f);
+        if(!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+MidiFile::MidiFile(void)
+    :division(96)
+{}
+
+int MidiFile::load(const std::string &filename)
+{
+    FILE *f = fopen(filename.c_str(), "rb");
+    if(!f)
+        return -1;
+
+    std::vector<uint8_t> data;
+    uint8_t buf[4096];
+    size_t  n;
+    while((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        data.insert(data.end(), buf, buf + n);
+    fclose(f);
+
+    return parse(data.data(), data.size());
+}
+
+int MidiFile::parse(const uint8_t *data, size_t len)
+{
+    evs.clear();
+    if(len < 14 || memcmp(data, "MThd", 4) || be32(data + 4) < 6)
+        return -1;
+
+    const int format  = be16(data + 8);
+    const int ntracks = be16(data + 10);
+    division          = be16(data + 12);
+    if(format > 1 || division == 0)
+        return -2;
+
+    std::vector<TickEvent> ticks;
+    size_t pos = 8 + be32(data + 4);
+    for(int t = 0; t < ntracks; ++t) {
+        if(pos + 8 > len)
+            return -3;
+        const uint32_t size = be32(data + pos + 4);
+        if(memcmp(data + pos, "MTrk", 4)) {
+            //unknown chunks are to be ignored
+            pos += 8 + size;
+            --t;
+            continue;
+        }
+        if(pos + 8 + size > len)
+            return -3;
+        if(parseTrack(data + pos + 8, size, ticks))
+            return -4;
+        pos += 8 + size;
+    }
+
+    //Merge the tracks, stable so events of one track keep their order
+    std::stable_sort(ticks.begin(), ticks.end(),
+            [](const TickEvent &a, const TickEvent &b) {
+                return a.tick < b.tick;
+            });
+
+    //Convert ticks into seconds following the tempo map
+    double   seconds = 0.0;
+    uint64_t last    = 0;
+    uint32_t tempo   = DEFAULT_TEMPO;
+    for(const TickEvent &e:ticks) {
+        if(division & 0x8000) {
+            //SMPTE: -frames per second in the high byte, ticks per frame
+            const int fps = -(int8_t)(division >> 8);
+            seconds = e.tick / (double)(fps * (division & 0xff));
+        } else {
+            seconds += (e.tick - last) * (tempo * 1e-6) / division;
+            last     = e.tick;
+        }
+
+        if(e.tempo) {
+            tempo = e.tempo;
+            continue;
+        }
+        MidiFileEvent ev;
+        ev.time = seconds;
+        memcpy(ev.data, e.data, sizeof(ev.data));
+        ev.size = e.size;
+        evs.push_back(ev);
+    }
+    return 0;
+}
+
+int MidiFile::parseTrack(const uint8_t *data, size_t len,
+                         std::vector<TickEvent> &out)
+{
+    size_t   pos     = 0;
+    uint64_t tick    = 0;
+    uint8_t  running = 0;
+    while(pos < len) {
+        uint32_t delta;
+        if(!readVarLen(data, len, pos, delta) || pos >= len)
+            return -1;
+        tick += delta;
+
+        uint8_t status = data[pos];
+        if(status == 0xff) { //meta event
+            if(pos + 2 > len)
+                return -1;
+            const uint8_t type = data[pos + 1];
+            pos += 2;
+            uint32_t size;
+            if(!readVarLen(data, len, pos, size) || pos + size > len)
+                return -1;
+            if(type == 0x51 && size == 3) {
+                TickEvent e = {tick, 0, {0, 0, 0}, 0};
+                e.tempo = (data[pos] << 16) | (data[pos + 1] << 8)
+                          | data[pos + 2];
+                if(e.tempo)
+                    out.push_back(e);
+            }
+            if(type == 0x2f) //end of track
+                return 0;
+            pos += size;
+            continue;
+        }
+        if(status == 0xf0 || status == 0xf7) { //SysEx
+            pos++;
+            uint32_t size;
+            if(!readVarLen(data, len, pos, size) || pos + size > len)
+                return -1;
+            pos += size;
+            continue;
+        }
+
+        if(status & 0x80) {
+            running = status;
+            pos++;
+        } else if(!running)
+            return -1;
+        status = running;
+
+        const int nbytes = ((status & 0xf0) == 0xc0
+                            || (status & 0xf0) == 0xd0) ? 1 : 2;
+        if(pos + nbytes > len)
+            return -1;
+
+        TickEvent e = {tick, 0, {status, data[pos], 0}, (uint8_t)(nbytes + 1)};
+        if(nbytes == 2)
+            e.data[2] = data[pos + 1];
+        pos += nbytes;
+        out.push_back(e);
+    }
+    return 0;
+}
+
+double MidiFile::length(void) const
+{
+    return evs.empty() ? 0.0 : evs.back().time;
+}
+
+}
@@ -0,0 +1,62 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  MidiFile.h - Standard MIDI file reader
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace zyn {
+
+/**A channel message with its time in seconds from the start of the file*/
+struct MidiFileEvent
+{
+    double  time;
+    uint8_t data[3];
+    uint8_t size;
+};
+
+/**
+ * Reads the channel messages of a standard MIDI file (format 0 or 1).
+ *
+ * The tracks are merged into one list ordered by time, with all tempo
+ * changes already applied. Meta events other than tempo and all SysEx
+ * messages are skipped.
+ */
+class MidiFile
+{
+    public:
+        MidiFile(void);
+
+        /**@return 0 on success, <0 if the file could not be read*/
+        int load(const std::string &filename);
+        /**@return 0 on success, <0 if the data is not a valid MIDI file*/
+        int parse(const uint8_t *data, size_t len);
+
+        const std::vector<MidiFileEvent> &events(void) const {return evs;}
+        /**Time of the last event in seconds*/
+        double length(void) const;
+
+    private:
+        struct TickEvent {
+            uint64_t tick;
+            uint32_t tempo; //microseconds per quarter note, 0 if no tempo
+            uint8_t  data[3];
+            uint8_t  size;
+        };
+        int parseTrack(const uint8_t *data, size_t len,
+                       std::vector<TickEvent> &out);
+
+        std::vector<MidiFileEvent> evs;
+        int division;
+};
+
+}
@@ -0,0 +1,240 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  OfflineRender.cpp - Render a MIDI file to WAV without any audio backend
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <rtosc/thread-link.h>
+
+#include "OfflineRender.h"
+#include "Config.h"
+#include "Master.h"
+#include "MidiFile.h"
+#include "Part.h"
+#include "Util.h"
+#include "WavFile.h"
+#include "WorkPool.h"
+#include "Allocator.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+
+namespace zyn {
+
+//Keep rendering after the last event until the output is this quiet...
+#define RENDER_SILENCE     1e-5f
+//...for this many seconds
+#define RENDER_SILENCE_SEC 0.5
+//but never longer than this
+#define RENDER_MAX_TAIL    30.0
+//Chunk handed to the RT memory pool when it runs low
+#define RENDER_MEMORY_CHUNK (5 * 1024 * 1024)
+
+typedef std::chrono::steady_clock render_clock;
+
+struct RenderJob
+{
+    std::string outfile;
+    int         part;    //part rendered alone, -1 for the full mix
+    double      seconds; //length of the rendered audio
+    double      wall;    //time it took
+    bool        ok;
+};
+
+static double since(render_clock::time_point start)
+{
+    return std::chrono::duration<double>(render_clock::now() - start).count();
+}
+
+//Answer the requests MiddleWare would normally take care of
+static void serviceMaster(Master &master, rtosc::ThreadLink &bToU)
+{
+    while(bToU.hasNext()) {
+        const char *msg = bToU.read();
+        if(!strcmp(msg, "/request-memory")) {
+            master.memory->addMemory(malloc(RENDER_MEMORY_CHUNK),
+                                     RENDER_MEMORY_CHUNK);
+            master.pendingMemory = false;
+        }
+    }
+}
+
+static void renderJob(const OfflineRenderOptions &opts, const SYNTH_T &synth,
+                      Config *config, const MidiFile &midi, RenderJob &job)
+{
+    const auto start = render_clock::now();
+    job.ok = false;
+
+    rtosc::ThreadLink bToU(4096, 256);
+    Master master(synth, config);
+    master.bToU = &bToU;
+    //Rendering slower than realtime is fine here
+    master.governor.target = 0.0f;
+
+    if(!opts.loadfile.empty() && master.loadXML(opts.loadfile.c_str()) < 0) {
+        cerr << "ERROR: Could not load master file " << opts.loadfile << endl;
+        return;
+    }
+    master.applyparameters();
+    if(job.part >= 0)
+        for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+            if(npart != job.part)
+                master.partonoff(npart, 0);
+
+    WavFile wav(job.outfile, synth.samplerate, 2);
+    if(!wav.good()) {
+        cerr << "ERROR: Could not write " << job.outfile << endl;
+        return;
+    }
+
+    const int bs = synth.buffersize;
+    float outl[bs], outr[bs];
+    short smps[2 * bs];
+
+    const std::vector<MidiFileEvent> &events = midi.events();
+    const double   sr      = synth.samplerate_f;
+    const uint64_t lastsmp = llround(midi.length() * sr);
+    const uint64_t maxsmp  = lastsmp + llround(RENDER_MAX_TAIL * sr);
+    const uint64_t hold    = llround(RENDER_SILENCE_SEC * sr);
+    uint64_t frame   = 0;
+    uint64_t quiet   = 0;
+    size_t   next    = 0;
+    int      skipped = 0;
+
+    while(true) {
+        //Events take effect at the start of the buffer they fall in
+        while(next < events.size()
+              && llround(events[next].time * sr) < (int64_t)(frame + bs)) {
+            const MidiFileEvent &ev = events[next++];
+            if(!master.midiMessage(ev.data, ev.size))
+                skipped++;
+        }
+
+        serviceMaster(master, bToU);
+        master.AudioOut(outl, outr);
+
+        float peak = 0.0f;
+        for(int i = 0; i < bs; ++i) {
+            peak = std::max(peak, std::max(fabsf(outl[i]), fabsf(outr[i])));
+            smps[2 * i]     = limit((int)(outl[i] * 32767.0f), -32768, 32767);
+            smps[2 * i + 1] = limit((int)(outr[i] * 32767.0f), -32768, 32767);
+        }
+        wav.writeStereoSamples(bs, smps);
+        frame += bs;
+
+        if(next < events.size() || frame < lastsmp)
+            continue;
+        quiet = peak < RENDER_SILENCE ? quiet + bs : 0;
+        if(quiet >= hold || frame >= maxsmp)
+            break;
+    }
+
+    if(skipped)
+        cerr << "WARNING: " << skipped << " MIDI events (e.g. program "
+             << "changes) can not be rendered offline" << endl;
+
+    job.seconds = frame / sr;
+    job.wall    = since(start);
+    job.ok      = true;
+}
+
+static std::string stemName(const std::string &outfile, int part)
+{
+    std::string base = outfile;
+    const size_t n   = base.size();
+    if(n > 4 && !strcasecmp(base.c_str() + n - 4, ".wav"))
+        base.resize(n - 4);
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), "-part%02d.wav", part + 1);
+    return base + suffix;
+}
+
+int renderOffline(const OfflineRenderOptions &opts, const SYNTH_T &synth,
+                  Config *config)
+{
+    MidiFile midi;
+    if(midi.load(opts.midifile) < 0) {
+        cerr << "ERROR: Could not read MIDI file " << opts.midifile << endl;
+        return 1;
+    }
+
+    //Without MiddleWare nobody else keeps the pool of the process alive,
+    //every Master::applyparameters() would start and join its own
+    std::shared_ptr<WorkPool> workers = WorkPool::shared();
+
+    std::vector<RenderJob> jobs;
+    if(opts.stems) {
+        //Find the parts to render with a throwaway master
+        Master master(synth, config);
+        if(!opts.loadfile.empty() && master.loadXML(opts.loadfile.c_str()) < 0) {
+            cerr << "ERROR: Could not load master file " << opts.loadfile
+                 << endl;
+            return 1;
+        }
+        for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+            if(master.part[npart]->Penabled)
+                jobs.push_back({stemName(opts.outfile, npart), npart,
+                                0.0, 0.0, false});
+    } else
+        jobs.push_back({opts.outfile, -1, 0.0, 0.0, false});
+
+    const auto start = render_clock::now();
+    if(opts.stems) {
+        //Every stem is single threaded, the parallelism comes from the jobs
+        const int renderThreads = config->cfg.RenderThreads;
+        config->cfg.RenderThreads = 0;
+
+        unsigned nthreads = opts.jobs > 0 ? opts.jobs
+                                          : std::thread::hardware_concurrency();
+        nthreads = std::max(1u, std::min<unsigned>(nthreads, jobs.size()));
+
+        std::atomic<size_t> nextJob(0);
+        std::vector<std::thread> threads;
+        for(unsigned i = 0; i < nthreads; ++i)
+            threads.emplace_back([&] {
+                size_t j;
+                while((j = nextJob++) < jobs.size())
+                    renderJob(opts, synth, config, midi, jobs[j]);
+            });
+        for(auto &t:threads)
+            t.join();
+
+        config->cfg.RenderThreads = renderThreads;
+    } else
+        renderJob(opts, synth, config, midi, jobs[0]);
+    const double wall = since(start);
+
+    cout.precision(2);
+    cout << std::fixed;
+    bool   ok    = true;
+    double audio = 0.0;
+    for(const RenderJob &job:jobs) {
+        ok &= job.ok;
+        if(!job.ok)
+            continue;
+        audio += job.seconds;
+        cout << "Rendered " << job.outfile << ": " << job.seconds << " s in "
+             << job.wall << " s (" << job.seconds / job.wall
+             << "x realtime)" << endl;
+    }
+    if(jobs.size() > 1)
+        cout << "Rendered " << jobs.size() << " stems in " << wall << " s ("
+             << audio / wall << "x realtime)" << endl;
+    return ok ? 0 : 1;
+}
+
+}
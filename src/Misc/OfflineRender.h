@@ -0,0 +1,41 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  OfflineRender.h - Render a MIDI file to WAV without any audio backend
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#pragma once
+#include <string>
+#include "../globals.h"
+
+namespace zyn {
+
+class Config;
+
+struct OfflineRenderOptions
+{
+    std::string midifile;  //MIDI file to play
+    std::string loadfile;  //optional .xmz to load first
+    std::string outfile;   //WAV file (or stem file prefix)
+    bool        stems;     //one WAV file per enabled part
+    int         jobs;      //threads rendering stems, 0 = one per core
+};
+
+/**
+ * Plays a MIDI file through a Master as fast as possible and writes the
+ * result as 16 bit stereo WAV, bypassing Nio and MiddleWare.
+ *
+ * In stem mode every enabled part is rendered by its own Master, with the
+ * other parts disabled, and the stems are spread over several threads.
+ *
+ * @return 0 on success, nonzero on failure
+ */
+int renderOffline(const OfflineRenderOptions &opts, const SYNTH_T &synth,
+                  Config *config) NONREALTIME;
+
+}
@@ -27,6 +27,7 @@
 #include "../Synth/PADnote.h"
 #include "../Containers/ScratchString.h"
 #include "../DSP/FFTwrapper.h"
+#include "../DSP/MixKernels.h"
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
@@ -42,6 +43,11 @@ namespace zyn {
 using rtosc::Ports;
 using rtosc::RtData;
 
+//Output level below which a part without notes counts as silent
+#define PART_SILENCE_THRESHOLD 1e-6f
+//Seconds an effected part has to stay silent (the longest Echo delay)
+#define PART_SILENCE_HOLD 2.0f
+
 #define rObject Part
 static const Ports partPorts = {
     rSelf(Part, rEnabledBy(Penabled)),
@@ -83,6 +89,11 @@ static const Ports partPorts = {
     rParamI(Pvoicelimit, rShort("vlimit"), rProp(parameter),
     rMap(min,0), rMap(max, POLYPHONY), rDefault(0), "Voice limit per part"),
 #undef rChangeCb
+#define rChangeCb
+    rParamI(Paudiblefloor, rShort("floor"), rProp(parameter), rUnit(dB),
+    rMap(min,-150), rMap(max,0), rDefault(0),
+    "Level below which released notes and voices are retired (0 = off)"),
+#undef rChangeCb
 #define rChangeCb
     rParamZyn(Pminkey, rShort("min"), rDefault(0), "Min Used Key"),
     rParamZyn(Pmaxkey, rShort("max"), rDefault(127), "Max Used Key"),
@@ -120,6 +131,9 @@ static const Ports partPorts = {
     {"captureMax:", rDoc("Capture maximum valid note"), NULL,
         [](const char *, RtData &r)
         {Part *p = (Part*)r.obj; p->Pmaxkey = p->lastnote;}},
+    {"idle:", rDoc("True if the part is silent and skipped by the mixer"), NULL,
+        [](const char *, RtData &d)
+        {Part *p = (Part*)d.obj; d.reply(d.loc, p->idle() ? "T" : "F");}},
     {"polyType::c:i", rProp(parameter) rOptions(Poly, Mono, Legato, Latch)
         rDoc("Synthesis polyphony type\n"), NULL,
         [](const char *msg, RtData &d)
@@ -317,6 +331,8 @@ Part::Part(Allocator &alloc, const SYNTH_T &synth_, const AbsTime &time_,
 
     killallnotes = false;
     oldfreq_log2 = -1.0f;
+    silent       = true;
+    silentsmps   = 0;
 
     cleanup();
 
@@ -360,6 +376,7 @@ void Part::cloneTraits(Part &p) const
     CLONE(Plegatomode);
     CLONE(Pkeylimit);
     CLONE(Pvoicelimit);
+    CLONE(Paudiblefloor);
 
     // Controller has a reference, so it can not be re-assigned
     // So, destroy and reconstruct it.
@@ -382,6 +399,7 @@ void Part::defaults()
     Pveloffs  = 64;
     Pkeylimit = 15;
     Pvoicelimit = 0;
+    Paudiblefloor = 0;
     defaultsinstrument();
     ctl.defaults();
 }
@@ -437,6 +455,7 @@ void Part::cleanup(bool final_)
     ctl.resetall();
     for(int nefx = 0; nefx < NUM_PART_EFX; ++nefx)
         partefx[nefx]->cleanup();
+    silent = true;
     for(int n = 0; n < NUM_PART_EFX + 1; ++n)
         for(int i = 0; i < synth.buffersize; ++i) {
             partfxinputl[n][i] = final_ ? 0.0f : synth.denormalkillbuf[i];
@@ -573,7 +592,7 @@ bool Part::NoteOnInternal(note_t note,
             continue;
 
         SynthParams pars{memory, ctl, synth, time, vel,
-            portamento, note_log2_freq, false, prng()};
+            portamento, note_log2_freq, false, prng(), noteFloor()};
         const int sendto = Pkitmode ? item.sendto() : 0;
 
         // Enforce voice limit, before we trigger new note
@@ -582,14 +601,14 @@ bool Part::NoteOnInternal(note_t note,
         try {
             if(item.Padenabled)
                 notePool.insertNote(note, sendto,
-                        {memory.alloc<ADnote>(kit[i].adpars, pars,
+                        {allocNote<ADnote>(kit[i].adpars, pars,
                             wm, (pre+"kit"+i+"/adpars/").c_str), 0, i});
             if(item.Psubenabled)
                 notePool.insertNote(note, sendto,
-                        {memory.alloc<SUBnote>(kit[i].subpars, pars, wm, (pre+"kit"+i+"/subpars/").c_str), 1, i});
+                        {allocNote<SUBnote>(kit[i].subpars, pars, wm, (pre+"kit"+i+"/subpars/").c_str), 1, i});
             if(item.Ppadenabled)
                 notePool.insertNote(note, sendto,
-                        {memory.alloc<PADnote>(kit[i].padpars, pars, interpolation, wm,
+                        {allocNote<PADnote>(kit[i].padpars, pars, interpolation, wm,
                             (pre+"kit"+i+"/padpars/").c_str), 2, i});
         } catch (std::bad_alloc & ba) {
             std::cerr << "dropped new note: " << ba.what() << std::endl;
@@ -617,8 +636,8 @@ void Part::NoteOff(note_t note) //release the key
     if(!monomemEmpty())
         monomemPop(note);
 
-    for(auto &desc:notePool.activeDesc()) {
-        if(desc.note != note || !desc.playing())
+    for(auto &desc:notePool.activeDesc(note)) {
+        if(!desc.playing())
             continue;
         // if latch is on we ignore noteoff, but set the state to lateched
         if(Platchmode) {
@@ -657,8 +676,8 @@ void Part::PolyphonicAftertouch(note_t note,
         monomem[note].velocity = velocity;       // Store this note's velocity.
 
     const float vel = getVelocity(velocity, Pvelsns, Pveloffs);
-    for(auto &d:notePool.activeDesc()) {
-        if(d.note == note && d.playing())
+    for(auto &d:notePool.activeDesc(note)) {
+        if(d.playing())
             for(auto &s:notePool.activeNotes(d))
                 s.note->setVelocity(vel);
     }
@@ -777,16 +796,16 @@ void Part::SetController(unsigned int type, note_t note, float value,
         if(!Ppolymode)
             monomem[note].note_log2_freq = value;
 
-        for(auto &d:notePool.activeDesc()) {
-            if(d.note == note && d.playing())
+        for(auto &d:notePool.activeDesc(note)) {
+            if(d.playing())
                 for(auto &s:notePool.activeNotes(d))
                     s.note->setPitch(value);
         }
         break;
     }
     case C_filtercutoff:
-        for(auto &d:notePool.activeDesc()) {
-            if(d.note == note && d.playing())
+        for(auto &d:notePool.activeDesc(note)) {
+            if(d.playing())
                 for(auto &s:notePool.activeNotes(d))
                     s.note->setFilterCutoff(value);
         }
@@ -925,51 +944,79 @@ void Part::AllNotesOff()
  * Compute Part samples and store them in the partoutl[] and partoutr[]
  */
 void Part::ComputePartSmps()
+{
+    ComputePartSmps(0, synth.buffersize);
+}
+
+void Part::ComputePartSmps(int pos, int nsamples)
 {
     assert(partefx[0]);
+    const bool   last  = pos + nsamples == synth.buffersize;
+    const size_t bytes = nsamples * sizeof(float);
+    //Nothing to play and no effect tail left to ring out
+    if(silent && !killallnotes && notePool.empty()) {
+        memset(partoutl + pos, 0, bytes);
+        memset(partoutr + pos, 0, bytes);
+        if(last)
+            ctl.updateportamento();
+        return;
+    }
+    //A note started within the buffer, the samples before it were skipped
+    if(silent)
+        for(unsigned nefx = 0; nefx < NUM_PART_EFX + 1; ++nefx) {
+            memset(partfxinputl[nefx], 0, pos * sizeof(float));
+            memset(partfxinputr[nefx], 0, pos * sizeof(float));
+        }
+    silent = false;
+
     for(unsigned nefx = 0; nefx < NUM_PART_EFX + 1; ++nefx) {
-        memset(partfxinputl[nefx], 0, synth.bufferbytes);
-        memset(partfxinputr[nefx], 0, synth.bufferbytes);
+        memset(partfxinputl[nefx] + pos, 0, bytes);
+        memset(partfxinputr[nefx] + pos, 0, bytes);
     }
 
+    const float audible = noteFloor();
     for(auto &d:notePool.activeDesc()) {
         d.age++;
         for(auto &s:notePool.activeNotes(d)) {
             float tmpoutr[synth.buffersize];
             float tmpoutl[synth.buffersize];
             auto &note = *s.note;
-            note.noteout(&tmpoutl[0], &tmpoutr[0]);
+            note.noteout(&tmpoutl[0], &tmpoutr[0], nsamples);
 
-            for(int i = 0; i < synth.buffersize; ++i) { //add the note to part(mix)
-                partfxinputl[d.sendto][i] += tmpoutl[i];
-                partfxinputr[d.sendto][i] += tmpoutr[i];
-            }
+            //add the note to part(mix)
+            mix::add(partfxinputl[d.sendto] + pos, tmpoutl, nsamples);
+            mix::add(partfxinputr[d.sendto] + pos, tmpoutr, nsamples);
 
+            //Released notes which faded below the audible floor are
+            //entombed, so they fade out over the next buffer instead of
+            //being cut off
             if(note.finished())
                 notePool.kill(s);
+            else if(audible > 0.0f && d.released()
+                    && note.envelopeAmplitude() < audible)
+                note.entomb();
         }
     }
+    if(!last)
+        return;
 
     //Apply part's effects and mix them
     for(int nefx = 0; nefx < NUM_PART_EFX; ++nefx) {
         if(!Pefxbypass[nefx]) {
             partefx[nefx]->out(partfxinputl[nefx], partfxinputr[nefx]);
-            if(Pefxroute[nefx] == 2)
-                for(int i = 0; i < synth.buffersize; ++i) {
-                    partfxinputl[nefx + 1][i] += partefx[nefx]->efxoutl[i];
-                    partfxinputr[nefx + 1][i] += partefx[nefx]->efxoutr[i];
-                }
+            if(Pefxroute[nefx] == 2) {
+                mix::add(partfxinputl[nefx + 1], partefx[nefx]->efxoutl,
+                         synth.buffersize);
+                mix::add(partfxinputr[nefx + 1], partefx[nefx]->efxoutr,
+                         synth.buffersize);
+            }
         }
         int routeto = ((Pefxroute[nefx] == 0) ? nefx + 1 : NUM_PART_EFX);
-        for(int i = 0; i < synth.buffersize; ++i) {
-            partfxinputl[routeto][i] += partfxinputl[nefx][i];
-            partfxinputr[routeto][i] += partfxinputr[nefx][i];
-        }
-    }
-    for(int i = 0; i < synth.buffersize; ++i) {
-        partoutl[i] = partfxinputl[NUM_PART_EFX][i];
-        partoutr[i] = partfxinputr[NUM_PART_EFX][i];
+        mix::add(partfxinputl[routeto], partfxinputl[nefx], synth.buffersize);
+        mix::add(partfxinputr[routeto], partfxinputr[nefx], synth.buffersize);
     }
+    memcpy(partoutl, partfxinputl[NUM_PART_EFX], synth.bufferbytes);
+    memcpy(partoutr, partfxinputr[NUM_PART_EFX], synth.bufferbytes);
 
     if(killallnotes) {
         for(int i = 0; i < synth.buffersize; ++i) {
@@ -984,6 +1031,58 @@ void Part::ComputePartSmps()
             partefx[nefx]->cleanup();
     }
     ctl.updateportamento();
+    updateSilence();
+}
+
+float Part::noteFloor(void) const
+{
+    if(Paudiblefloor >= 0)
+        return 0.0f;
+    //The note output is scaled by the part gain
+    const float level = dB2rap(Paudiblefloor);
+    return gain > 0.0f ? level / gain : level;
+}
+
+float Part::quietestVoice(void)
+{
+    float level;
+    return notePool.quietestVoice(level) ? level * gain : -1.0f;
+}
+
+void Part::shedVoice(bool hard)
+{
+    float level;
+    NotePool::NoteDescriptor *d = notePool.quietestVoice(level);
+    if(!d)
+        return;
+    //Let playing voices fade out with their release unless the period
+    //was overrun, voices already releasing are cut short
+    if(hard || !d->playing())
+        notePool.entomb(*d);
+    else
+        notePool.release(*d);
+}
+
+void Part::updateSilence(void)
+{
+    bool quiet = notePool.empty();
+    for(int i = 0; quiet && i < synth.buffersize; ++i)
+        quiet = fabsf(partoutl[i]) < PART_SILENCE_THRESHOLD
+             && fabsf(partoutr[i]) < PART_SILENCE_THRESHOLD;
+    if(!quiet) {
+        silentsmps = 0;
+        return;
+    }
+
+    //A delay line may still hold audio while the output is quiet, so wait
+    //for the longest effect memory before calling an effected part idle
+    bool effected = false;
+    for(int nefx = 0; nefx < NUM_PART_EFX; ++nefx)
+        effected |= !Pefxbypass[nefx] && partefx[nefx]->geteffect() != 0;
+
+    silentsmps += synth.buffersize;
+    silent      = !effected
+                  || silentsmps >= PART_SILENCE_HOLD * synth.samplerate_f;
 }
 
 /*
@@ -1147,6 +1246,7 @@ void Part::add2XML(XMLwrapper& xml)
     xml.addpar("legato_mode", Plegatomode);
     xml.addpar("key_limit", Pkeylimit);
     xml.addpar("voice_limit", Pvoicelimit);
+    xml.addpar("audible_floor", Paudiblefloor);
 
     xml.beginbranch("INSTRUMENT");
     add2XMLinstrument(xml);
@@ -1196,11 +1296,12 @@ void Part::applyparameters(void)
     applyparameters([]{return false;});
 }
 
-void Part::applyparameters(std::function<bool()> do_abort)
+void Part::applyparameters(std::function<bool()> do_abort, bool draft)
 {
     for(int n = 0; n < NUM_KIT_ITEMS; ++n)
         if(kit[n].Ppadenabled && kit[n].padpars)
-            kit[n].padpars->applyparameters(do_abort);
+            kit[n].padpars->applyparameters(do_abort, 0,
+                    draft && kit[n].padpars->needsDraft());
 }
 
 void Part::initialize_rt(void)
@@ -1371,6 +1472,7 @@ void Part::getfromXML(XMLwrapper& xml)
         Plegatomode = xml.getpar127("legato_mode", Plegatomode);
     Pkeylimit = xml.getpar127("key_limit", Pkeylimit);
     Pvoicelimit = xml.getpar127("voice_limit", Pvoicelimit);
+    Paudiblefloor = xml.getpar("audible_floor", Paudiblefloor, -150, 0);
 
 
     if(xml.enterbranch("INSTRUMENT")) {
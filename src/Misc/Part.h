@@ -75,6 +75,18 @@ class Part
 
         /* The synthesizer part output */
         void ComputePartSmps() REALTIME; //Part output
+        /* The samples [pos, pos+nsamples) of the output, so that events
+         * can land between the calls. The part effects run on the call
+         * which reaches the end of the buffer */
+        void ComputePartSmps(int pos, int nsamples) REALTIME;
+        /* True when no notes are playing and the part effect tails have
+         * decayed; partoutl/partoutr then hold silence */
+        bool idle(void) const {return silent;}
+        /* Level of the quietest voice (scaled by the part gain) and
+         * shedding it, used by the load governor of Master.
+         * quietestVoice() returns a negative level if there is no voice */
+        float quietestVoice(void) REALTIME;
+        void shedVoice(bool hard) REALTIME;
 
 
         //saves the instrument settings to a XML file
@@ -89,7 +101,10 @@ class Part
         void defaultsinstrument();
 
         void applyparameters(void) NONREALTIME;
-        void applyparameters(std::function<bool()> do_abort) NONREALTIME;
+        //With draft, PADsynth kit items whose samples take long to generate
+        //get a quick draft set (see PADnoteParameters::needsDraft())
+        void applyparameters(std::function<bool()> do_abort,
+                             bool draft = false) NONREALTIME;
 
         void initialize_rt(void) REALTIME;
         void kill_rt(void) REALTIME;
@@ -151,6 +166,7 @@ class Part
         bool Platchmode; // 0=normal, 1=latch
         unsigned char Pkeylimit; //how many keys are allowed to be played same time (0=off), the older will be released
         unsigned char Pvoicelimit; //how many voices are allowed to be played same time (0=off), the older will be entombed
+        int Paudiblefloor; //level in dB below which released notes and voices are retired (0=off)
 
         char *Pname; //name of the instrument
         struct { //instrument additional information
@@ -195,6 +211,15 @@ class Part
 
         bool killallnotes;
 
+        //Paudiblefloor as an amplitude of the notes (before the part gain),
+        //0 if disabled
+        float noteFloor(void) const;
+
+        //Silence tracking (see idle())
+        void updateSilence(void) REALTIME;
+        bool silent;
+        int  silentsmps; //samples since the output fell below the threshold
+
         NotePool notePool;
 
         void limit_voices(int new_note);
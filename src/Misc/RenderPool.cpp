@@ -0,0 +1,176 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  RenderPool.cpp - Realtime fork/join worker pool
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <cassert>
+#include <cstdio>
+#include <thread>
+#include <pthread.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+#include "RenderPool.h"
+#include "Util.h"
+#include "../DSP/Denormal.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define POOL_PAUSE() _mm_pause()
+#else
+#define POOL_PAUSE()
+#endif
+
+namespace zyn {
+
+//Number of idle polls a worker yields for before it starts to sleep
+#define POOL_SPIN_LIMIT 4096
+//Sleep between polls of an idle worker (in microseconds)
+#define POOL_SLEEP_US   50
+//Polls the audio thread busy waits for the last jobs before it yields
+#define POOL_WAIT_SPINS 1024
+
+struct RenderPool::Worker
+{
+    pthread_t   thread;
+    RenderPool *pool;
+    int         id;
+    bool        running;
+};
+
+RenderPool::RenderPool(unsigned nthreads, job_t job_, void *ctx_)
+    :job(job_), ctx(ctx_), nworkers(0), workers(nullptr),
+     ticket(0), done(0), exiting(false), generation(0)
+{
+    if(nthreads == 0)
+        return;
+
+    workers = new Worker[nthreads];
+    for(unsigned i = 0; i < nthreads; ++i) {
+        Worker &w = workers[i];
+        w.pool    = this;
+        w.id      = i;
+        w.running = false;
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+        w.running = !pthread_create(&w.thread, &attr, workerThread, &w);
+        pthread_attr_destroy(&attr);
+        if(!w.running) {
+            fprintf(stderr, "[WARNING] Could not start render thread %d\n", i);
+            break;
+        }
+        nworkers++;
+    }
+}
+
+RenderPool::~RenderPool(void)
+{
+    exiting.store(true, std::memory_order_release);
+    for(unsigned i = 0; i < nworkers; ++i)
+        if(workers[i].running)
+            pthread_join(workers[i].thread, NULL);
+    delete [] workers;
+}
+
+void *RenderPool::workerThread(void *arg)
+{
+    Worker &w = *(Worker*)arg;
+    w.pool->workerLoop(w.id);
+    return NULL;
+}
+
+void RenderPool::workerLoop(int id)
+{
+    set_realtime();
+    denormal::flushThread();
+#ifdef __linux__
+    //Pin worker N onto core N+1 (wrapping around), so the workers do not
+    //migrate. The audio thread is not pinned, the scheduler places it.
+    const unsigned ncpu = std::thread::hardware_concurrency();
+    if(ncpu > 1) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET((id + 1) % ncpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#else
+    (void)id;
+#endif
+
+    uint32_t seen = 0;
+    int      idle = 0;
+    while(!exiting.load(std::memory_order_acquire)) {
+        const uint32_t gen = ticket.load(std::memory_order_acquire) >> 32;
+        if(gen != seen) {
+            seen = gen;
+            work(gen);
+            idle = 0;
+        } else if(idle < POOL_SPIN_LIMIT) {
+            idle++;
+            std::this_thread::yield();
+        } else
+            os_usleep(POOL_SLEEP_US);
+    }
+}
+
+bool RenderPool::work(uint32_t gen)
+{
+    bool worked = false;
+    uint64_t t  = ticket.load(std::memory_order_acquire);
+    while((uint32_t)(t >> 32) == gen) {
+        const unsigned size = (t >> 16) & 0xffff;
+        const unsigned idx  = t & 0xffff;
+        if(idx >= size)
+            break;
+        //on failure t is reloaded and the claim is retried
+        if(!ticket.compare_exchange_weak(t, t + 1,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_acquire))
+            continue;
+        job(ctx, idx);
+        done.fetch_add(1, std::memory_order_release);
+        worked = true;
+        t = ticket.load(std::memory_order_acquire);
+    }
+    return worked;
+}
+
+void RenderPool::run(int njobs)
+{
+    if(njobs <= 0)
+        return;
+
+    //Not worth waking anyone up
+    if(nworkers == 0 || njobs == 1) {
+        for(int i = 0; i < njobs; ++i)
+            job(ctx, i);
+        return;
+    }
+
+    assert(njobs < 0x10000);
+    done.store(0, std::memory_order_relaxed);
+    ++generation;
+    ticket.store(((uint64_t)generation << 32) | ((uint64_t)njobs << 16),
+                 std::memory_order_release);
+
+    //Participate in the batch, then wait for jobs still owned by workers
+    work(generation);
+    int spins = 0;
+    while(done.load(std::memory_order_acquire) < njobs) {
+        if(spins < POOL_WAIT_SPINS) {
+            spins++;
+            POOL_PAUSE();
+        } else
+            std::this_thread::yield();
+    }
+}
+
+}
@@ -0,0 +1,68 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  RenderPool.h - Realtime fork/join worker pool
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include "../globals.h"
+
+namespace zyn {
+
+/**
+ * Fork/join pool used to spread independent units of work (e.g. parts)
+ * of one audio buffer over several realtime threads.
+ *
+ * All threads are created in the constructor. run() neither allocates nor
+ * takes any locks: jobs are handed out through a single atomic ticket and
+ * the calling thread works on the batch itself, so the batch always
+ * finishes even if no worker wakes up in time.
+ *
+ * The job callback is fixed at construction, which keeps the per batch
+ * state down to the generation/size/index triple packed in the ticket.
+ */
+class RenderPool
+{
+    public:
+        typedef void (*job_t)(void *ctx, int idx);
+
+        /**
+         * @param nthreads number of additional worker threads
+         * @param job      callback run once for every index of a batch
+         * @param ctx      opaque pointer passed to job
+         */
+        RenderPool(unsigned nthreads, job_t job, void *ctx) NONREALTIME;
+        RenderPool(const RenderPool&) = delete;
+        ~RenderPool(void) NONREALTIME;
+
+        /**Run job(ctx, i) for i in [0, njobs) and wait for completion*/
+        void run(int njobs) REALTIME;
+
+        unsigned threads(void) const {return nworkers;}
+
+    private:
+        struct Worker;
+        static void *workerThread(void *);
+        void workerLoop(int id);
+        bool work(uint32_t generation);
+
+        job_t    job;
+        void    *ctx;
+        unsigned nworkers;
+        Worker  *workers;
+
+        //[generation:32][size:16][next index:16]
+        std::atomic<uint64_t> ticket;
+        std::atomic<int>      done;
+        std::atomic<bool>     exiting;
+        uint32_t              generation;
+};
+
+}
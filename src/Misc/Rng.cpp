@@ -0,0 +1,188 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  Rng.cpp - Counter-based random number streams
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include "Rng.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define RNG_X86 1
+#include <immintrin.h>
+//See MixKernels.cpp
+#define RNG_SSE2 __attribute__((target("sse2")))
+#define RNG_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace zyn {
+
+RngStream::RngStream(uint32_t seed, uint32_t stream)
+{
+    reset(seed, stream);
+}
+
+void RngStream::reset(uint32_t seed, uint32_t stream)
+{
+    key     = hash(seed ^ hash(stream + 0x9e3779b9U));
+    counter = 0;
+}
+
+namespace rng {
+
+typedef void (*Kernel)(uint32_t, uint32_t, float *, int, float, float);
+
+/*
+ * The scaling is exact up to the final multiply-add (toUnit() multiplies by
+ * a power of two), which every version does as a separate multiply and add
+ */
+static void fill_scalar(uint32_t key, uint32_t counter, float *out, int n,
+                        float lo, float scale)
+{
+    for(int i = 0; i < n; ++i)
+        out[i] = lo + scale * RngStream::toUnit(RngStream::at(key, counter + i));
+}
+
+#ifdef RNG_X86
+//SSE2 has no 32 bit multiply keeping the low half, combine two 64 bit ones
+RNG_SSE2 static inline __m128i mullo_sse2(__m128i a, __m128i b)
+{
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32),
+                                       _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+RNG_SSE2 static inline __m128i hash_sse2(__m128i x)
+{
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    x = mullo_sse2(x, _mm_set1_epi32((int)0x7feb352dU));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+    x = mullo_sse2(x, _mm_set1_epi32((int)0x846ca68bU));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    return x;
+}
+
+RNG_SSE2 static void fill_sse2(uint32_t key, uint32_t counter, float *out,
+                               int n, float lo, float scale)
+{
+    const __m128i k    = _mm_set1_epi32((int)key);
+    const __m128i step = _mm_set1_epi32(4);
+    const __m128  unit = _mm_set1_ps(1.0f / 16777216.0f);
+    const __m128  vlo  = _mm_set1_ps(lo);
+    const __m128  vsc  = _mm_set1_ps(scale);
+    __m128i ctr = _mm_add_epi32(_mm_set1_epi32((int)counter),
+                                _mm_setr_epi32(0, 1, 2, 3));
+    int i = 0;
+    for(; i + 4 <= n; i += 4) {
+        const __m128i x = hash_sse2(_mm_add_epi32(hash_sse2(ctr), k));
+        const __m128  u = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(x, 8)),
+                                     unit);
+        _mm_storeu_ps(out + i, _mm_add_ps(vlo, _mm_mul_ps(vsc, u)));
+        ctr = _mm_add_epi32(ctr, step);
+    }
+    fill_scalar(key, counter + i, out + i, n - i, lo, scale);
+}
+
+RNG_AVX2 static inline __m256i hash_avx2(__m256i x)
+{
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32((int)0x7feb352dU));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32((int)0x846ca68bU));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    return x;
+}
+
+RNG_AVX2 static void fill_avx2(uint32_t key, uint32_t counter, float *out,
+                               int n, float lo, float scale)
+{
+    const __m256i k    = _mm256_set1_epi32((int)key);
+    const __m256i step = _mm256_set1_epi32(8);
+    const __m256  unit = _mm256_set1_ps(1.0f / 16777216.0f);
+    const __m256  vlo  = _mm256_set1_ps(lo);
+    const __m256  vsc  = _mm256_set1_ps(scale);
+    __m256i ctr = _mm256_add_epi32(_mm256_set1_epi32((int)counter),
+                                   _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    int i = 0;
+    for(; i + 8 <= n; i += 8) {
+        const __m256i x = hash_avx2(_mm256_add_epi32(hash_avx2(ctr), k));
+        const __m256  u = _mm256_mul_ps(
+                _mm256_cvtepi32_ps(_mm256_srli_epi32(x, 8)), unit);
+        _mm256_storeu_ps(out + i, _mm256_add_ps(vlo, _mm256_mul_ps(vsc, u)));
+        ctr = _mm256_add_epi32(ctr, step);
+    }
+    fill_scalar(key, counter + i, out + i, n - i, lo, scale);
+}
+#endif
+
+/*
+ * Dispatch
+ */
+static bool hasKernels(mix::Isa isa)
+{
+    switch(isa) {
+        case mix::ISA_SCALAR:
+#ifdef RNG_X86
+        case mix::ISA_SSE2:
+        case mix::ISA_AVX2:
+#endif
+            return mix::supported(isa);
+        default:
+            return false;
+    }
+}
+
+static mix::Isa current = mix::ISA_SCALAR;
+static Kernel   active  = fill_scalar;
+
+mix::Isa isa(void)
+{
+    return current;
+}
+
+bool setIsa(mix::Isa isa)
+{
+    if(!hasKernels(isa))
+        return false;
+    current = isa;
+    switch(isa) {
+#ifdef RNG_X86
+        case mix::ISA_SSE2:
+            active = fill_sse2;
+            break;
+        case mix::ISA_AVX2:
+            active = fill_avx2;
+            break;
+#endif
+        default:
+            active = fill_scalar;
+            break;
+    }
+    return true;
+}
+
+static mix::Isa bestIsa(void)
+{
+    for(int i = mix::ISA_COUNT - 1; i > mix::ISA_SCALAR; --i)
+        if(hasKernels((mix::Isa)i))
+            return (mix::Isa)i;
+    return mix::ISA_SCALAR;
+}
+
+static const bool dispatched = rng::setIsa(bestIsa());
+
+}
+
+void RngStream::fill(float *out, int n, float lo, float hi)
+{
+    rng::active(key, counter, out, n, lo, hi - lo);
+    counter += n;
+}
+
+}
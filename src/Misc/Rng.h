@@ -0,0 +1,91 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  Rng.h - Counter-based random number streams
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#pragma once
+#include <stdint.h>
+#include "../DSP/MixKernels.h"
+
+namespace zyn {
+
+/**
+ * Random number stream without shared state.
+ *
+ * Number n of a stream is a hash of n and the stream key, so a stream is
+ * just a key and a counter. Every note (or any other user) can own a
+ * stream, which keeps its output reproducible from its seed no matter what
+ * else is playing and lets RenderPool workers draw numbers without racing
+ * on the global prng_state. As the numbers do not depend on each other,
+ * fill() computes them several at a time.
+ *
+ * The hash is two rounds of the lowbias32 integer hash (C. Wellons), each
+ * round being a bijection of the 32 bit integers: a stream does not repeat
+ * before 2^32 numbers and streams with different keys are unrelated.
+ */
+class RngStream
+{
+    public:
+        explicit RngStream(uint32_t seed = 0, uint32_t stream = 0);
+
+        //Restart as stream number stream of the seed
+        void reset(uint32_t seed, uint32_t stream = 0);
+
+        uint32_t next(void)
+        {
+            return at(key, counter++);
+        }
+
+        //Uniform in [0, 1), 24 bit resolution
+        float unit(void)
+        {
+            return toUnit(next());
+        }
+
+        //n numbers uniform in [lo, hi), the same as calling
+        //lo + (hi - lo) * unit() n times
+        void fill(float *out, int n, float lo, float hi);
+
+        static uint32_t hash(uint32_t x)
+        {
+            x ^= x >> 16;
+            x *= 0x7feb352dU;
+            x ^= x >> 15;
+            x *= 0x846ca68bU;
+            x ^= x >> 16;
+            return x;
+        }
+
+        static uint32_t at(uint32_t key, uint32_t n)
+        {
+            return hash(hash(n) + key);
+        }
+
+        static float toUnit(uint32_t x)
+        {
+            return (x >> 8) * (1.0f / 16777216.0f);
+        }
+
+        uint32_t key;
+        uint32_t counter;
+};
+
+/**
+ * Implementation of RngStream::fill(), picked like the mix:: kernels.
+ * SSE2 and AVX2 produce exactly the scalar numbers, NEON uses the scalar
+ * code.
+ */
+namespace rng {
+
+mix::Isa isa(void);
+//Returns false if the CPU does not support isa
+bool setIsa(mix::Isa isa);
+
+}
+}
@@ -0,0 +1,95 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  RoutingGraph.cpp - Compiled part/effect routing of the master mix
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <cstring>
+#include "RoutingGraph.h"
+
+namespace zyn {
+
+RoutingGraph::RoutingGraph(void)
+    :nparts(0), npartins(0), nmasterins(0), nsysefx(0), nlevels(0),
+     valid(false)
+{
+    memset(&compiled, 0, sizeof(compiled));
+}
+
+bool RoutingGraph::update(const State &state,
+                          const float sysvol[NUM_SYS_EFX][NUM_MIDI_PARTS],
+                          const float syssend[NUM_SYS_EFX][NUM_SYS_EFX])
+{
+    if(valid && !memcmp(&state, &compiled, sizeof(State)))
+        return false;
+    memcpy(&compiled, &state, sizeof(State));
+    compile(sysvol, syssend);
+    valid = true;
+    return true;
+}
+
+void RoutingGraph::compile(const float sysvol[NUM_SYS_EFX][NUM_MIDI_PARTS],
+                           const float syssend[NUM_SYS_EFX][NUM_SYS_EFX])
+{
+    const State &s = compiled;
+
+    nparts = 0;
+    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+        if(s.partEnabled[npart])
+            parts[nparts++] = npart;
+
+    //Insertion effects, an effect of type 0 leaves its input untouched
+    npartins = nmasterins = 0;
+    for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx) {
+        const int dest = s.insparts[nefx];
+        if(s.insefx[nefx] == 0)
+            continue;
+        if(dest == -2)
+            masterins[nmasterins++] = nefx;
+        else if(dest >= 0 && dest < NUM_MIDI_PARTS && s.partEnabled[dest])
+            partins[npartins++] = {nefx, dest};
+    }
+
+    //System effects, parts are level 0 and an effect sits one level above
+    //the highest effect sending into it
+    int level[NUM_SYS_EFX];
+    nsysefx = nlevels = 0;
+    for(int nefx = 0; nefx < NUM_SYS_EFX; ++nefx) {
+        if(s.sysefx[nefx] == 0)
+            continue;
+        SysefxNode &node = sysefx[nsysefx++];
+        node.efx    = nefx;
+        node.level  = 1;
+        node.nparts = 0;
+        node.nsends = 0;
+
+        for(int i = 0; i < nparts; ++i) {
+            const int npart = parts[i];
+            if(s.sysvol[nefx][npart] == 0)
+                continue;
+            node.part[node.nparts]       = npart;
+            node.partgain[node.nparts++] = sysvol[nefx][npart];
+        }
+
+        //only earlier effects can send into this one
+        for(int nfrom = 0; nfrom < nefx; ++nfrom) {
+            if(s.sysefx[nfrom] == 0 || s.syssend[nfrom][nefx] == 0)
+                continue;
+            node.from[node.nsends]       = nfrom;
+            node.fromgain[node.nsends++] = syssend[nfrom][nefx];
+            if(level[nfrom] + 1 > node.level)
+                node.level = level[nfrom] + 1;
+        }
+
+        level[nefx] = node.level;
+        if(node.level > nlevels)
+            nlevels = node.level;
+    }
+}
+
+}
@@ -0,0 +1,101 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  RoutingGraph.h - Compiled part/effect routing of the master mix
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#pragma once
+#include "../globals.h"
+
+namespace zyn {
+
+/**
+ * The routing of Master (enabled parts, insertion effects, system effect
+ * sends) compiled into lists holding only the live nodes and edges.
+ *
+ * Master fills in a RoutingGraph::State from its parameters every buffer.
+ * update() compares it with the state the graph was compiled from and only
+ * recompiles when something changed. The send gains follow from the send
+ * parameters, so they never change on their own.
+ *
+ * The audio path walks the short edge lists instead of the dense parameter
+ * matrices.
+ *
+ * System effects are sorted into dependency levels: an effect only takes
+ * input from parts and from effects of lower levels, so all effects of
+ * one level could run in parallel.
+ *
+ * Everything is stored in fixed size arrays, update() is realtime safe.
+ */
+class RoutingGraph
+{
+    public:
+        /**Routing parameters the graph is compiled from*/
+        struct State {
+            bool          partEnabled[NUM_MIDI_PARTS];
+            short         insparts[NUM_INS_EFX];  //Master::Pinsparts
+            unsigned char insefx[NUM_INS_EFX];    //effect types (0 = off)
+            unsigned char sysefx[NUM_SYS_EFX];    //effect types (0 = off)
+            unsigned char sysvol[NUM_SYS_EFX][NUM_MIDI_PARTS];
+            unsigned char syssend[NUM_SYS_EFX][NUM_SYS_EFX];
+        };
+
+        struct InsertionEdge {
+            int efx;
+            int part;
+        };
+
+        struct SysefxNode {
+            int   efx;
+            int   level;
+            //parts sending into the effect
+            int   nparts;
+            int   part[NUM_MIDI_PARTS];
+            float partgain[NUM_MIDI_PARTS];
+            //lower system effects sending into this one
+            int   nsends;
+            int   from[NUM_SYS_EFX];
+            float fromgain[NUM_SYS_EFX];
+        };
+
+        RoutingGraph(void);
+
+        /**Recompile if state differs from the compiled one
+         * @param sysvol  Master::sysefxvol (gains of the part sends)
+         * @param syssend Master::sysefxsend (gains of the effect sends)
+         * @return true if the graph was rebuilt*/
+        bool update(const State &state,
+                    const float sysvol[NUM_SYS_EFX][NUM_MIDI_PARTS],
+                    const float syssend[NUM_SYS_EFX][NUM_SYS_EFX]) REALTIME;
+
+        //Enabled parts, in order
+        int nparts;
+        int parts[NUM_MIDI_PARTS];
+
+        //Insertion effects on enabled parts, in effect order
+        int           npartins;
+        InsertionEdge partins[NUM_INS_EFX];
+
+        //Insertion effects on the master output, in effect order
+        int nmasterins;
+        int masterins[NUM_INS_EFX];
+
+        //Enabled system effects, sorted by effect index (and so by level)
+        int        nsysefx;
+        SysefxNode sysefx[NUM_SYS_EFX];
+        int        nlevels;
+
+    private:
+        void compile(const float sysvol[NUM_SYS_EFX][NUM_MIDI_PARTS],
+                     const float syssend[NUM_SYS_EFX][NUM_SYS_EFX]);
+
+        State compiled;
+        bool  valid;
+};
+
+}
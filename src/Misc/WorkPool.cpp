@@ -0,0 +1,234 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  WorkPool.cpp - Work stealing pool for non-realtime jobs
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <algorithm>
+#include <deque>
+#include "WorkPool.h"
+
+namespace zyn {
+
+struct WorkPool::Job
+{
+    std::function<void()> fn;
+    Group                *group;
+    //Set by the first thread to run the job. A job is referenced by a queue
+    //and its group, either may be the one to run it
+    std::atomic<bool>     taken;
+};
+
+struct WorkPool::Queue
+{
+    std::mutex                       mutex;
+    std::deque<std::shared_ptr<Job>> jobs[PRIO_COUNT];
+};
+
+//The pool and worker the current thread belongs to
+static thread_local WorkPool *current_pool   = nullptr;
+static thread_local unsigned  current_worker = 0;
+//Priority of the job run by the current thread, -1 if none
+static thread_local int       current_prio   = -1;
+
+WorkPool::WorkPool(unsigned nthreads)
+    :nworkers(nthreads), queues(nullptr), queued(0), exiting(false)
+{
+    if(nworkers == 0)
+        nworkers = std::max(1u, std::thread::hardware_concurrency());
+
+    queues = new Queue[nworkers + 1];
+    for(unsigned i = 0; i < nworkers; ++i)
+        workers.push_back(std::thread(&WorkPool::workerLoop, this, i));
+}
+
+WorkPool::~WorkPool(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep);
+        exiting = true;
+    }
+    wakeup.notify_all();
+    for(auto &w : workers)
+        w.join();
+
+    //Groups wait for their jobs, so whatever is left was run by a group
+    delete[] queues;
+}
+
+std::shared_ptr<WorkPool> WorkPool::shared(void)
+{
+    static std::mutex              mutex;
+    static std::weak_ptr<WorkPool> instance;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<WorkPool> pool = instance.lock();
+    if(!pool) {
+        pool     = std::make_shared<WorkPool>();
+        instance = pool;
+    }
+    return pool;
+}
+
+WorkPool::Priority WorkPool::priority(void)
+{
+    return current_prio < 0 ? PRIO_LOAD : (Priority)current_prio;
+}
+
+void WorkPool::push(std::shared_ptr<Job> job, Priority prio)
+{
+    Queue &q = current_pool == this ? queues[current_worker] : queues[nworkers];
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.jobs[prio].push_back(job);
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleep);
+        ++queued;
+    }
+    wakeup.notify_one();
+}
+
+std::shared_ptr<WorkPool::Job> WorkPool::take(unsigned id)
+{
+    std::shared_ptr<Job> job;
+    for(int prio = 0; prio < PRIO_COUNT && !job; ++prio) {
+        //Own jobs first, newest first as they are the ones the worker waits
+        //for, then the oldest ones of the others
+        for(unsigned i = 0; i <= nworkers && !job; ++i) {
+            const bool own = i == 0;
+            Queue &q = own ? queues[id]
+                : queues[(id + i) % (nworkers + 1)];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            auto &jobs = q.jobs[prio];
+            if(jobs.empty())
+                continue;
+            if(own) {
+                job = jobs.back();
+                jobs.pop_back();
+            } else {
+                job = jobs.front();
+                jobs.pop_front();
+            }
+        }
+    }
+
+    if(job) {
+        std::lock_guard<std::mutex> lock(sleep);
+        --queued;
+    }
+    return job;
+}
+
+void WorkPool::execute(Job &job)
+{
+    if(job.taken.exchange(true))
+        return;
+
+    Group &group = *job.group;
+    const int prio = current_prio;
+    current_prio = group.prio;
+    if(!group.cancelled())
+        job.fn();
+    current_prio = prio;
+    group.finish();
+}
+
+void WorkPool::workerLoop(unsigned id)
+{
+    current_pool   = this;
+    current_worker = id;
+
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(sleep);
+            wakeup.wait(lock, [this]{return exiting || queued > 0;});
+            if(exiting)
+                return;
+        }
+
+        //Jobs already run by their group are merely dropped here
+        std::shared_ptr<Job> job = take(id);
+        if(job)
+            execute(*job);
+    }
+}
+
+WorkPool::Group::Group(WorkPool &pool, Priority prio,
+                       std::function<bool()> do_abort)
+    :prio(prio), pool(pool), do_abort(do_abort), stopped(false), pending(0)
+{}
+
+WorkPool::Group::~Group(void)
+{
+    wait();
+}
+
+void WorkPool::Group::run(std::function<void()> fn)
+{
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->fn    = fn;
+    job->group = this;
+    job->taken = false;
+    jobs.push_back(job);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++pending;
+    }
+    pool.push(job, prio);
+}
+
+void WorkPool::Group::wait(void)
+{
+    //Jobs are run in the order they were submitted, which keeps a group
+    //without any free worker as fast as running its jobs in a loop
+    for(auto &job : jobs)
+        execute(*job);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]{return pending == 0;});
+    lock.unlock();
+    jobs.clear();
+}
+
+bool WorkPool::Group::done(void)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending == 0;
+}
+
+void WorkPool::Group::cancel(void)
+{
+    stopped = true;
+}
+
+bool WorkPool::Group::cancelled(void) const
+{
+    return stopped || do_abort();
+}
+
+void WorkPool::Group::finish(void)
+{
+    //Notified with the lock held, the group may be gone right after
+    std::lock_guard<std::mutex> lock(mutex);
+    if(--pending == 0)
+        finished.notify_all();
+}
+
+WorkPool::PriorityScope::PriorityScope(Priority prio)
+    :old(current_prio)
+{
+    current_prio = prio;
+}
+
+WorkPool::PriorityScope::~PriorityScope(void)
+{
+    current_prio = old;
+}
+
+}
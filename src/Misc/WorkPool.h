@@ -0,0 +1,133 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  WorkPool.h - Work stealing pool for non-realtime jobs
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../globals.h"
+
+namespace zyn {
+
+/**
+ * Pool of threads for the long non-realtime jobs (generating PADsynth
+ * samples, loading parts), shared by the whole process.
+ *
+ * Every worker has its own queue. Jobs submitted by a worker go to its own
+ * queue and are taken back in LIFO order, jobs submitted by other threads
+ * go to a common queue. An idle worker steals the oldest job of the others.
+ *
+ * Jobs are submitted in groups with a priority. Workers always take the
+ * most urgent job there is, so the part the user plays is loaded before
+ * the rest of a session and background prefetching runs last.
+ *
+ * A group is waited for as a whole. The waiting thread runs the jobs of the
+ * group no worker took yet, so a job may wait for a group of its own
+ * without blocking the pool. Jobs that did not start yet are dropped once
+ * the group is cancelled, running ones are expected to poll
+ * Group::cancelled() (or the abort callback of the group) themselves.
+ */
+class WorkPool
+{
+    public:
+        enum Priority {
+            PRIO_ACTIVE,   //!< the user waits for it, e.g. the played part
+            PRIO_LOAD,     //!< loading sessions and instruments
+            PRIO_PREFETCH, //!< background work nobody waits for
+            PRIO_COUNT
+        };
+
+        struct Job;
+
+        /**A set of jobs which is waited for and cancelled together.
+         * run() and wait() are called by the thread owning the group.*/
+        class Group
+        {
+            public:
+                Group(WorkPool &pool, Priority prio,
+                      std::function<bool()> do_abort = []{return false;});
+                Group(const Group&) = delete;
+                //Waits for the jobs
+                ~Group(void);
+
+                void run(std::function<void()> job);
+                //Help with the jobs of the group until all of them are done
+                void wait(void);
+                //True once every job ran or was dropped
+                bool done(void);
+
+                //Drop the jobs that did not start yet
+                void cancel(void);
+                bool cancelled(void) const;
+
+                const Priority prio;
+            private:
+                friend class WorkPool;
+                void finish(void);
+
+                WorkPool                         &pool;
+                std::function<bool()>             do_abort;
+                std::atomic<bool>                 stopped;
+                std::vector<std::shared_ptr<Job>> jobs;
+                std::mutex                        mutex;
+                std::condition_variable           finished;
+                int                               pending;
+        };
+
+        /**Sets the priority of the groups created by the current thread
+         * within a scope*/
+        class PriorityScope
+        {
+            public:
+                PriorityScope(Priority prio);
+                ~PriorityScope(void);
+            private:
+                int old;
+        };
+
+        //@param nthreads number of worker threads, 0 for one per core
+        explicit WorkPool(unsigned nthreads = 0) NONREALTIME;
+        WorkPool(const WorkPool&) = delete;
+        ~WorkPool(void) NONREALTIME;
+
+        unsigned threads(void) const {return nworkers;}
+
+        /**The pool of the process. It is created on first use and lives as
+         * long as anyone (usually MiddleWare) holds on to it.*/
+        static std::shared_ptr<WorkPool> shared(void);
+
+        /**Priority for new groups of the current thread: the one of the job
+         * it runs, PRIO_LOAD outside of jobs*/
+        static Priority priority(void);
+
+    private:
+        struct Queue;
+        void workerLoop(unsigned id);
+        void push(std::shared_ptr<Job> job, Priority prio);
+        std::shared_ptr<Job> take(unsigned id);
+        static void execute(Job &job);
+
+        unsigned                 nworkers;
+        std::vector<std::thread> workers;
+        //One per worker and one for other threads
+        Queue                   *queues;
+
+        std::mutex               sleep;
+        std::condition_variable  wakeup;
+        int                      queued;
+        bool                     exiting;
+};
+
+}
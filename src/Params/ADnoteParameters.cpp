@@ -1066,6 +1066,31 @@ void ADnoteParameters::getfromXML(XMLwrapper& xml)
         getfromXMLsection(xml, nvoice);
         xml.exitbranch();
     }
+
+    prepareOscillators();
+}
+
+/*
+ * Build the spectra and band-limited tables of the oscillators which the
+ * enabled voices play. The other oscillators are prepared by the first note
+ * using them (without tables) or when they are edited.
+ */
+void ADnoteParameters::prepareOscillators(void)
+{
+    for(int nvoice = 0; nvoice < NUM_VOICES; ++nvoice) {
+        const ADnoteVoiceParam &param = VoicePar[nvoice];
+        if(!param.Enabled || param.Type != 0)
+            continue;
+
+        const int vc = param.Pextoscil != -1 ? param.Pextoscil : nvoice;
+        VoicePar[vc].OscilGn->preparemips();
+
+        if(param.PFMEnabled != FMTYPE::NONE
+                && (param.PFMVoice < 0 || param.PFMVoice >= nvoice)) {
+            const int fm = param.PextFMoscil != -1 ? param.PextFMoscil : nvoice;
+            VoicePar[fm].FmGn->preparemips();
+        }
+    }
 }
 
 void ADnoteParameters::getfromXMLsection(XMLwrapper& xml, int n)
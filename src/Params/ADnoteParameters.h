@@ -339,6 +339,7 @@ class ADnoteParameters:public PresetsArray
 
     private:
         void EnableVoice(const SYNTH_T &synth, int nvoice, const AbsTime* time);
+        void prepareOscillators(void);
         void KillVoice(int nvoice);
         FFTwrapper *fft;
 };
@@ -0,0 +1,286 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  PADcache.cpp - On disk cache of generated PADsynth samples
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include "PADcache.h"
+#include "PADstore.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <utime.h>
+#include <vector>
+
+namespace zyn {
+namespace padcache {
+
+/*
+ * File layout (native byte order, a foreign file fails the header check):
+ *
+ *   Header
+ *   float basefreq[count]
+ *   float scale[count]
+ *   float smp[count][length]   (raw buffers, 16 bit values if scaled)
+ */
+struct Header {
+    char     magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t size;
+    uint32_t length;
+    uint32_t reserved;
+};
+
+static const char MAGIC[4] = {'Z', 'P', 'A', 'D'};
+
+static std::atomic<uint64_t> limit_bytes(0);
+
+//Age in seconds after which a temporary file is left over from a crashed
+//writer, live writers touch theirs every sample
+#define STALE_TMP_AGE 3600
+
+static long sampleOffset(int count, int length, int n)
+{
+    return sizeof(Header) + sizeof(float) * (2 * count + (long)n * length);
+}
+
+static std::string keyPath(uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.pad", (unsigned long long)key);
+    return directory() + name;
+}
+
+std::string directory(void)
+{
+    if(const char *dir = getenv("ZYNADDSUBFX_PADCACHE"))
+        return dir;
+    const char *home = getenv("HOME");
+    return std::string(home ? home : ".") + "/.zynaddsubfx-padcache";
+}
+
+void setLimit(uint64_t bytes)
+{
+    limit_bytes = bytes;
+}
+
+bool enabled(void)
+{
+    return limit_bytes != 0;
+}
+
+uint64_t hash(const char *data, size_t len)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for(size_t i = 0; i < len; ++i) {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+bool contains(uint64_t key)
+{
+    struct stat st;
+    return enabled() && stat(keyPath(key).c_str(), &st) == 0;
+}
+
+bool load(uint64_t key, int count, int size, int length,
+          PADnoteParameters::callback cb)
+{
+    if(!enabled())
+        return false;
+
+    const std::string path = keyPath(key);
+    struct stat st;
+    if(stat(path.c_str(), &st) != 0
+            || st.st_size != sampleOffset(count, length, count))
+        return false;
+
+    FILE *f = fopen(path.c_str(), "rb");
+    if(!f)
+        return false;
+
+    Header h;
+    float basefreq[PAD_MAX_SAMPLES], scale[PAD_MAX_SAMPLES];
+    if(fread(&h, sizeof(h), 1, f) != 1
+            || memcmp(h.magic, MAGIC, sizeof(MAGIC))
+            || h.version != VERSION
+            || (int)h.count != count || count > PAD_MAX_SAMPLES
+            || (int)h.size != size || (int)h.length != length
+            || fread(basefreq, sizeof(float), count, f) != (size_t)count
+            || fread(scale, sizeof(float), count, f) != (size_t)count) {
+        fclose(f);
+        return false;
+    }
+
+    //The size was checked, so reading the samples fails only on an I/O
+    //error, which is treated as a miss (the caller regenerates the set)
+    for(int n = 0; n < count; ++n) {
+        PADnoteParameters::Sample smp;
+        smp.smp = padstore::alloc(length);
+        if(fread(smp.smp, sizeof(float), length, f) != (size_t)length) {
+            padstore::release(smp.smp);
+            fclose(f);
+            return false;
+        }
+        smp.size     = size;
+        smp.basefreq = basefreq[n];
+        smp.scale    = scale[n];
+        cb(n, std::move(smp));
+    }
+    fclose(f);
+
+    //Mark as recently used
+    utime(path.c_str(), NULL);
+    return true;
+}
+
+Writer::Writer(uint64_t key, int count, int size, int length)
+    :file(NULL), count(count), size(size), length(length), stored(0)
+{
+    if(!enabled())
+        return;
+
+    const std::string dir = directory();
+#ifdef _WIN32
+    mkdir(dir.c_str());
+#else
+    mkdir(dir.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+#endif
+
+    //Other writers of the same set (other parts or processes) use other
+    //temporary files, the last rename wins
+    char suffix[64];
+    snprintf(suffix, sizeof(suffix), ".%d-%p.tmp", (int)getpid(), (void*)this);
+    path    = keyPath(key);
+    tmppath = path + suffix;
+
+    file = fopen(tmppath.c_str(), "wb");
+    if(!file)
+        return;
+
+    Header h;
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version  = VERSION;
+    h.count    = count;
+    h.size     = size;
+    h.length   = length;
+    h.reserved = 0;
+    if(fwrite(&h, sizeof(h), 1, file) != 1) {
+        fclose(file);
+        file = NULL;
+        remove(tmppath.c_str());
+    }
+}
+
+Writer::~Writer(void)
+{
+    if(file) {
+        fclose(file);
+        remove(tmppath.c_str());
+    }
+}
+
+void Writer::store(int n, const PADnoteParameters::Sample &smp)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!file)
+        return;
+
+    const long freqoffset = sizeof(Header) + sizeof(float) * n;
+    if(fseek(file, freqoffset, SEEK_SET)
+            || fwrite(&smp.basefreq, sizeof(float), 1, file) != 1
+            || fseek(file, freqoffset + sizeof(float) * count, SEEK_SET)
+            || fwrite(&smp.scale, sizeof(float), 1, file) != 1
+            || fseek(file, sampleOffset(count, length, n), SEEK_SET)
+            || fwrite(smp.smp, sizeof(float), length, file) != (size_t)length) {
+        //Out of disk space or alike, give up on this set
+        fclose(file);
+        file = NULL;
+        remove(tmppath.c_str());
+        return;
+    }
+    ++stored;
+}
+
+void Writer::commit(void)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!file)
+        return;
+
+    const bool complete = stored == count;
+    const bool written  = fclose(file) == 0;
+    file = NULL;
+    if(!complete || !written || rename(tmppath.c_str(), path.c_str())) {
+        remove(tmppath.c_str());
+        return;
+    }
+
+    evict();
+}
+
+void evict(void)
+{
+    struct Entry {
+        time_t      used;
+        uint64_t    bytes;
+        std::string path;
+        bool operator<(const Entry &e) const {return used < e.used;}
+    };
+
+    const std::string dir = directory();
+    DIR *d = opendir(dir.c_str());
+    if(!d)
+        return;
+
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    const time_t now = ::time(NULL);
+    while(struct dirent *fn = readdir(d)) {
+        const char  *name = fn->d_name;
+        const size_t len  = strlen(name);
+        const bool   pad  = len >= 4 && !strcmp(name + len - 4, ".pad");
+        const bool   tmp  = len >= 4 && !strcmp(name + len - 4, ".tmp");
+        if(!pad && !tmp)
+            continue;
+
+        Entry e;
+        e.path = dir + "/" + name;
+        struct stat st;
+        if(stat(e.path.c_str(), &st) != 0)
+            continue;
+        if(tmp) {
+            if(now - st.st_mtime > STALE_TMP_AGE)
+                remove(e.path.c_str());
+            continue;
+        }
+        e.used  = st.st_mtime;
+        e.bytes = st.st_size;
+        total  += e.bytes;
+        entries.push_back(e);
+    }
+    closedir(d);
+
+    std::sort(entries.begin(), entries.end());
+    const uint64_t bound = limit_bytes;
+    for(unsigned i = 0; i < entries.size() && total > bound; ++i)
+        if(remove(entries[i].path.c_str()) == 0)
+            total -= entries[i].bytes;
+}
+
+}
+}
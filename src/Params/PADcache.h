@@ -0,0 +1,88 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  PADcache.h - On disk cache of generated PADsynth samples
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#pragma once
+
+#include <cstdio>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include "PADnoteParameters.h"
+
+namespace zyn {
+
+/**
+ * Generating the samples of a PADsynth instrument takes up to seconds, as
+ * each of them is one huge IFFT. The cache keeps every generated sample set
+ * in a file $HOME/.zynaddsubfx-padcache/<key>.pad (or in the directory
+ * $ZYNADDSUBFX_PADCACHE if it is set), where the key is a hash
+ * of everything the generation depends on (see
+ * PADnoteParameters::sampleKey()). Loading the same instrument again reads
+ * the samples back instead of computing them.
+ *
+ * The cache is bounded in size. When a new set does not fit, the least
+ * recently used sets are removed; a file's modification time is its last
+ * use, it is refreshed on every hit. Temporary files which crashed writers
+ * left behind are removed as well.
+ *
+ * The cache is process wide and disabled until a limit is set.
+ */
+namespace padcache {
+
+//Bump when the file format or the sample generation changes
+const uint32_t VERSION = 3;
+
+//Directory of the cache files
+std::string directory(void);
+
+//Bound of the cache size in bytes, 0 disables the cache
+void setLimit(uint64_t bytes);
+bool enabled(void);
+
+//64 bit FNV-1a
+uint64_t hash(const char *data, size_t len);
+
+//True if the set key is cached
+bool contains(uint64_t key);
+
+/**Hands the cached samples of key to cb.
+ * @param count  number of samples of the set
+ * @param size   Sample::size of each sample
+ * @param length floats of the buffer of each sample (see padstore::alloc)
+ * @return false on a miss, cb is not called then*/
+bool load(uint64_t key, int count, int size, int length,
+          PADnoteParameters::callback cb);
+
+/**Collects the samples of a set while they are generated (from several
+ * threads at the same time) and adds the set to the cache on commit().
+ * Does nothing if the cache is disabled.*/
+class Writer
+{
+    public:
+        Writer(uint64_t key, int count, int size, int length);
+        //Discards the set unless it was committed
+        ~Writer(void);
+
+        void store(int n, const PADnoteParameters::Sample &smp);
+        //Publish the set, if all of its samples were stored
+        void commit(void);
+    private:
+        std::string path, tmppath;
+        FILE       *file;
+        int         count, size, length, stored;
+        std::mutex  mutex;
+};
+
+//Remove the least recently used sets until the cache fits its limit
+void evict(void);
+
+}
+}
@@ -13,15 +13,22 @@
 #include <limits>
 #include <cmath>
 #include "PADnoteParameters.h"
+#include "PADcache.h"
+#include "PADstore.h"
 #include "FilterParams.h"
 #include "EnvelopeParams.h"
 #include "LFOParams.h"
 #include "../Synth/Resonance.h"
 #include "../Synth/OscilGen.h"
 #include "../Misc/WavFile.h"
+#include "../Misc/Rng.h"
 #include "../Misc/Time.h"
+#include "../Misc/WorkPool.h"
+#include "../Misc/XMLwrapper.h"
 #include <cstdio>
-#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
 
 #include <rtosc/ports.h>
 #include <rtosc/port-sugar.h>
@@ -84,7 +91,7 @@ static const rtosc::Ports realtime_ports =
             rOptions(L35cents, L10cents, E100cents, E1200cents),
             rDefault(L10cents), "Magnitude of Detune"),
 
-    {"sample#64:ifb", rProp(internal) rDoc("Nothing to see here"), 0,
+    {"sample#64:ifbf", rProp(internal) rDoc("Nothing to see here"), 0,
         [](const char *m, rtosc::RtData &d)
         {
             // MiddleWare calls this to send the generated sample buffers to us
@@ -97,6 +104,7 @@ static const rtosc::Ports realtime_ports =
             p->sample[n].size     = rtosc_argument(m,0).i;
             p->sample[n].basefreq = rtosc_argument(m,1).f;
             p->sample[n].smp      = *(float**)rtosc_argument(m,2).b.data;
+            p->sample[n].scale    = rtosc_argument(m,3).f;
             if (oldsmp)
                 d.reply("/free", "sb", "PADsample", sizeof(void*), &oldsmp);
         }},
@@ -241,6 +249,11 @@ static const rtosc::Ports non_realtime_ports =
             "Samples per octave"),
     rParamI(Pquality.oct, rShort("octaves"), rLinear(0,7), rDefault(3),
             "Number of octaves to sample (above the first sample"),
+    rOption(Pquality.storage, rShort("storage"),
+            rOptions(Float, 16 bit), rDefault(Float),
+            "Sample format, 16 bit samples take half the memory"),
+    rParamI(Pphaseseed, rShort("seed"), rLinear(0,65535), rDefault(0),
+            "Seed of the random phases of the harmonics"),
 
     {"Pbandwidth::i", rShort("bandwidth") rProp(parameter) rLinear(0,1000)
         rDefault(500) rDoc("Bandwidth Of Harmonics"), NULL,
@@ -304,6 +317,10 @@ static const rtosc::Ports non_realtime_ports =
         }},
     {"needPrepare:", rDoc("Unimplemented Stub"),
         NULL, [](const char *, rtosc::RtData&) {}},
+    {"progress:", rDoc("Broadcast while the samples are generated: stage "
+                       "(0 = draft, 1 = full quality), finished samples "
+                       "and samples of the stage"),
+        NULL, [](const char *, rtosc::RtData&) {}},
 };
 #undef rChangeCb
 
@@ -341,8 +358,10 @@ PADnoteParameters::PADnoteParameters(const SYNTH_T &synth_, FFTwrapper *fft_,
     FilterEnvelope->init(ad_global_filter);
     FilterLfo = new LFOParams(ad_global_filter, time_);
 
-    for(int i = 0; i < PAD_MAX_SAMPLES; ++i)
-        sample[i].smp = NULL;
+    for(int i = 0; i < PAD_MAX_SAMPLES; ++i) {
+        sample[i].smp   = NULL;
+        sample[i].scale = 0.0f;
+    }
 
     defaults();
 }
@@ -393,6 +412,8 @@ void PADnoteParameters::defaults()
     Pquality.basenote   = 4;
     Pquality.oct    = 3;
     Pquality.smpoct = 2;
+    Pquality.storage    = storage_float;
+    Pphaseseed      = 0;
 
     PStereo = 1; //stereo
     /* Frequency Global Parameters */
@@ -433,10 +454,11 @@ void PADnoteParameters::deletesample(int n)
     if((n < 0) || (n >= PAD_MAX_SAMPLES))
         return;
 
-    delete[] sample[n].smp;
+    padstore::release(sample[n].smp);
     sample[n].smp = NULL;
     sample[n].size     = 0;
     sample[n].basefreq = 440.0f;
+    sample[n].scale    = 0.0f;
 }
 
 void PADnoteParameters::deletesamples()
@@ -674,6 +696,27 @@ float PADnoteParameters::getNhr(int n) const
     return iresult + (1.0f - par3) * dresult;
 }
 
+//OscilGen::get and OscilGen::prepare work in buffers of the oscillator and
+//use the FFT of the master, which all pads share. The threads of
+//sampleGenerator and the pads applied in parallel take turns
+static std::mutex oscilgen_mutex;
+
+//Converts a sample to 16 bit values, returns the scale to convert them back
+static float to_int16(const float *smp, int16_t *out, int len)
+{
+    float peak = 0.0f;
+    for(int i = 0; i < len; ++i)
+        peak = std::max(peak, fabsf(smp[i]));
+    if(peak == 0.0f)
+        peak = 1.0f;
+
+    const float scale  = peak / 32767.0f;
+    const float rscale = 1.0f / scale;
+    for(int i = 0; i < len; ++i)
+        out[i] = (int16_t)lrintf(smp[i] * rscale);
+    return scale;
+}
+
 //Transform non zero positive signals into ones with a max of one
 static void normalize_max(float *f, size_t len)
 {
@@ -723,7 +766,10 @@ void PADnoteParameters::generatespectrum_bandwidthMode(float *spectrum,
     memset(harmonics, 0, sizeof(float) * synth.oscilsize);
 
     //get the harmonic structure from the oscillator (I am using the frequency amplitudes, only)
-    oscilgen->get(harmonics, basefreq, false);
+    {
+        std::lock_guard<std::mutex> lock(oscilgen_mutex);
+        oscilgen->get(harmonics, basefreq, false);
+    }
 
     //normalize
     normalize_max(harmonics, synth.oscilsize / 2);
@@ -798,7 +844,10 @@ void PADnoteParameters::generatespectrum_otherModes(float *spectrum,
     memset(harmonics, 0, sizeof(float) * synth.oscilsize);
 
     //get the harmonic structure from the oscillator (I am using the frequency amplitudes, only)
-    oscilgen->get(harmonics, basefreq, false);
+    {
+        std::lock_guard<std::mutex> lock(oscilgen_mutex);
+        oscilgen->get(harmonics, basefreq, false);
+    }
 
     //normalize
     normalize_max(harmonics, synth.oscilsize / 2);
@@ -849,36 +898,83 @@ void PADnoteParameters::applyparameters()
 }
 
 void PADnoteParameters::applyparameters(std::function<bool()> do_abort,
-                                        unsigned max_threads)
+                                        unsigned max_threads, bool draft)
 {
     if(do_abort())
         return;
     unsigned num = sampleGenerator([this]
                        (unsigned N, PADnoteParameters::Sample&& smp) {
-                           delete[] sample[N].smp;
+                           padstore::release(sample[N].smp);
                            sample[N] = std::move(smp);
                        },
-                       do_abort, max_threads);
+                       do_abort, max_threads, draft);
 
     //Delete remaining unused samples
     for(unsigned i = num; i < PAD_MAX_SAMPLES; ++i)
         deletesample(i);
 }
 
+int PADnoteParameters::sampleSize(bool draft) const
+{
+    const int samplesize = ((int) 1) << (Pquality.samplesize + 14);
+    return draft ? std::min(samplesize, 1 << 14) : samplesize;
+}
+
+int PADnoteParameters::sampleCount(bool draft) const
+{
+    int samplemax = Pquality.oct + 1;
+    int smpoct    = Pquality.smpoct;
+    if(Pquality.smpoct == 5)
+        smpoct = 6;
+    if(Pquality.smpoct == 6)
+        smpoct = 12;
+    if(smpoct != 0)
+        samplemax *= smpoct;
+    else
+        samplemax = samplemax / 2 + 1;
+    if(samplemax == 0)
+        samplemax = 1;
+
+    if(samplemax > PAD_MAX_SAMPLES)
+        samplemax = PAD_MAX_SAMPLES;
+
+    //a draft has one sample per octave
+    if(draft)
+        samplemax = std::min(samplemax, Pquality.oct + 1);
+    return samplemax;
+}
+
+bool PADnoteParameters::needsDraft(void)
+{
+    //the smallest samples are quick enough
+    if(sampleSize(false) <= sampleSize(true))
+        return false;
+
+    const uint64_t key = sampleKey();
+    Sample shared;
+    if(padstore::find(key, 0, shared)) {
+        padstore::release(shared.smp);
+        return false;
+    }
+    return !padcache::contains(key);
+}
+
 //Requires
 // - Pquality.samplesize
 // - Pquality.basenote
 // - Pquality.oct
 // - Pquality.smpoct
+// - Pquality.storage
 // - spectrum at various frequencies (oodles of data)
 int PADnoteParameters::sampleGenerator(PADnoteParameters::callback cb,
         std::function<bool()> do_abort,
-        unsigned max_threads)
+        unsigned max_threads,
+        bool draft)
 {
     if(!max_threads)
         max_threads = std::numeric_limits<unsigned>::max();
 
-    const int samplesize   = (((int) 1) << (Pquality.samplesize + 14));
+    const int samplesize   = sampleSize(draft);
     const int spectrumsize = samplesize / 2;
     const int profilesize = 512;
 
@@ -890,21 +986,51 @@ int PADnoteParameters::sampleGenerator(PADnoteParameters::callback cb,
     if(Pquality.basenote % 2 == 1)
         basefreq *= 1.5f;
 
-    int samplemax = Pquality.oct + 1;
-    int smpoct    = Pquality.smpoct;
-    if(Pquality.smpoct == 5)
-        smpoct = 6;
-    if(Pquality.smpoct == 6)
-        smpoct = 12;
-    if(smpoct != 0)
-        samplemax *= smpoct;
-    else
-        samplemax = samplemax / 2 + 1;
-    if(samplemax == 0)
-        samplemax = 1;
+    const int samplemax = sampleCount(draft);
+
+    //the last samples contain the first samples
+    //(used for linear/cubic interpolation)
+    const int extra_samples = 5;
+    const int samplelength  = samplesize + extra_samples;
+    //buffers hold floats, two 16 bit values share one of them
+    const bool compact      = Pquality.storage == storage_int16;
+    const int  bufferlength = compact ? (samplelength + 1) / 2 : samplelength;
+
+    //Drafts are neither shared nor cached
+    const uint64_t key = draft ? 0 : sampleKey();
+    PADnoteParameters::callback share = cb;
+    padcache::Writer *cache = NULL;
+
+    //Share the samples of an identical instance (in another part or kit
+    //item), if there is one in memory or being generated
+    padstore::Claim claim(key, do_abort);
+    if(!draft) {
+        PADnoteParameters::Sample shared[PAD_MAX_SAMPLES];
+        int found = 0;
+        while(found < samplemax && padstore::find(key, found, shared[found]))
+            ++found;
+        if(found == samplemax) {
+            for(int nsample = 0; nsample < samplemax; ++nsample)
+                cb(nsample, std::move(shared[nsample]));
+            return samplemax;
+        }
+        for(int nsample = 0; nsample < found; ++nsample)
+            padstore::release(shared[nsample].smp);
+    }
 
-    if(samplemax > PAD_MAX_SAMPLES)
-        samplemax = PAD_MAX_SAMPLES;
+    //Newly loaded or generated samples become shareable before they are
+    //handed out
+    if(!draft) {
+        share = [&cb, key](int nsample, PADnoteParameters::Sample &&smp) {
+            padstore::publish(key, nsample, smp);
+            cb(nsample, std::move(smp));
+        };
+
+        if(padcache::load(key, samplemax, samplesize, bufferlength, share))
+            return samplemax;
+        cache = new padcache::Writer(key, samplemax, samplesize,
+                                     bufferlength);
+    }
 
     //this is used to compute frequency relation to the base frequency
     float adj[samplemax];
@@ -916,15 +1042,18 @@ int PADnoteParameters::sampleGenerator(PADnoteParameters::callback cb,
 
     const PADnoteParameters* this_c = this;
 
-    auto thread_cb = [basefreq, bwadjust, &cb, do_abort,
-                      samplesize, samplemax, spectrumsize,
-                      adj_ptr, &profile, this_c](
+    auto thread_cb = [basefreq, bwadjust, &share, do_abort,
+                      samplesize, samplelength, samplemax, spectrumsize, cache,
+                      compact, bufferlength, adj_ptr, &profile, this_c](
                       unsigned nthreads, unsigned threadno)
     {
         //prepare a BIG IFFT
         FFTwrapper *fft      = new FFTwrapper(samplesize);
         fft_t      *fftfreqs = new fft_t[samplesize / 2];
         float      *spectrum = new float[spectrumsize];
+        float      *phases   = new float[spectrumsize];
+        //compact samples are computed as floats and converted afterwards
+        float      *wave     = compact ? new float[samplelength] : NULL;
 
         for(int nsample = 0; nsample < samplemax; ++nsample)
         if(nsample % nthreads == threadno)
@@ -945,64 +1074,89 @@ int PADnoteParameters::sampleGenerator(PADnoteParameters::callback cb,
                 this_c->generatespectrum_otherModes(spectrum, spectrumsize,
                                                     basefreq * basefreqadjust);
 
-            //the last samples contain the first samples
-            //(used for linear/cubic interpolation)
-            const int extra_samples = 5;
             PADnoteParameters::Sample newsample;
-            newsample.smp = new float[samplesize + extra_samples];
-
-            newsample.smp[0] = 0.0f;
-            for(int i = 1; i < spectrumsize; ++i) //randomize the phases
-                fftfreqs[i] = FFTpolar(spectrum[i], (float)RND * 2 * PI);
+            newsample.smp = padstore::alloc(bufferlength);
+            float *smp = compact ? wave : newsample.smp;
+
+            //randomize the phases, each sample draws from its own stream
+            //of the seed, so the set does not depend on the threads
+            RngStream(this_c->Pphaseseed, nsample)
+                .fill(phases, spectrumsize, 0.0f, 2 * PI);
+            smp[0] = 0.0f;
+            for(int i = 1; i < spectrumsize; ++i)
+                fftfreqs[i] = FFTpolar(spectrum[i], phases[i]);
             //that's all; here is the only ifft for the whole sample;
             //no windows are used ;-)
-            fft->freqs2smps(fftfreqs, newsample.smp);
+            fft->freqs2smps(fftfreqs, smp);
 
 
             //normalize(rms)
             float rms = 0.0f;
             for(int i = 0; i < samplesize; ++i)
-                rms += newsample.smp[i] * newsample.smp[i];
+                rms += smp[i] * smp[i];
             rms = sqrtf(rms);
             if(rms < 0.000001f)
                 rms = 1.0f;
             rms *= sqrtf(262144.0f / samplesize);//262144=2^18
             for(int i = 0; i < samplesize; ++i)
-                newsample.smp[i] *= 1.0f / rms * 50.0f;
+                smp[i] *= 1.0f / rms * 50.0f;
 
             //prepare extra samples used by the linear or cubic interpolation
             for(int i = 0; i < extra_samples; ++i)
-                newsample.smp[i + samplesize] = newsample.smp[i];
+                smp[i + samplesize] = smp[i];
 
             //yield new sample
             newsample.size     = samplesize;
             newsample.basefreq = basefreq * basefreqadjust;
-            cb(nsample, std::move(newsample));
+            newsample.scale    = 0.0f;
+            if(compact)
+                newsample.scale = to_int16(smp, (int16_t*)newsample.smp,
+                                           samplelength);
+            if(cache)
+                cache->store(nsample, newsample);
+            share(nsample, std::move(newsample));
         }
 
         //Cleanup
         delete (fft);
         delete[] fftfreqs;
         delete[] spectrum;
+        delete[] phases;
+        delete[] wave;
     };
 
-    if(oscilgen->needPrepare())
-        oscilgen->prepare();
+    {
+        std::lock_guard<std::mutex> lock(oscilgen_mutex);
+        if(oscilgen->needPrepare())
+            oscilgen->prepare();
+    }
 
 #ifdef WIN32
     //Temporarily disable multi-threading here as C++11 threads are broken on
     //mingw cross compilation
     thread_cb(1,0);
 #else
-    unsigned nthreads = std::min(max_threads,
-                                 std::thread::hardware_concurrency());
-    std::vector<std::thread> threads(nthreads);
-    for(unsigned i = 0; i < nthreads; ++i)
-        threads[i] = std::thread(thread_cb, nthreads, i);
-    for(unsigned i = 0; i < nthreads; ++i)
-        threads[i].join();
+    //The jobs go to the pool of the process, this thread takes part in
+    //the generation while it waits
+    std::shared_ptr<WorkPool> pool;
+    if(max_threads > 1)
+        pool = WorkPool::shared();
+    const unsigned nthreads = pool ? std::min<unsigned>(max_threads,
+                                                        pool->threads() + 1)
+                                   : 1;
+    if(nthreads == 1)
+        thread_cb(1,0);
+    else {
+        WorkPool::Group jobs(*pool, WorkPool::priority(), do_abort);
+        for(unsigned i = 0; i < nthreads; ++i)
+            jobs.run([&thread_cb, nthreads, i]{thread_cb(nthreads, i);});
+        jobs.wait();
+    }
 #endif
 
+    if(cache && !do_abort())
+        cache->commit();
+    delete cache;
     return samplemax;
 }
 
@@ -1021,17 +1175,15 @@ void PADnoteParameters::export2wav(std::string basefilename)
             int nsmps = sample[k].size;
             short int *smps = new short int[nsmps];
             for(int i = 0; i < nsmps; ++i)
-                smps[i] = (short int)(sample[k].smp[i] * 32767.0f);
+                smps[i] = (short int)(sample[k].value(i) * 32767.0f);
             wav.writeMonoSamples(nsmps, smps);
         }
     }
 }
 
-void PADnoteParameters::add2XML(XMLwrapper& xml)
+//The parameters the samples are generated from
+void PADnoteParameters::add2XMLsamples(XMLwrapper& xml)
 {
-    xml.setPadSynth(true);
-
-    xml.addparbool("stereo", PStereo);
     xml.addpar("mode", (int)Pmode);
     xml.addpar("bandwidth", Pbandwidth);
     xml.addpar("bandwidth_scale", Pbwscale);
@@ -1071,8 +1223,36 @@ void PADnoteParameters::add2XML(XMLwrapper& xml)
     xml.addpar("basenote", Pquality.basenote);
     xml.addpar("octaves", Pquality.oct);
     xml.addpar("samples_per_octave", Pquality.smpoct);
+    xml.addpar("phase_seed", Pphaseseed);
+    xml.addpar("storage", Pquality.storage);
+    xml.endbranch();
+}
+
+uint64_t PADnoteParameters::sampleKey(void)
+{
+    XMLwrapper xml;
+    add2XMLsamples(xml);
+
+    //Besides the parameters the samples depend on the audio setup
+    xml.beginbranch("PAD_CACHE");
+    xml.addpar("format", padcache::VERSION);
+    xml.addpar("samplerate", synth.samplerate);
+    xml.addpar("oscilsize", synth.oscilsize);
     xml.endbranch();
 
+    char *data = xml.getXMLdata();
+    const uint64_t key = data ? padcache::hash(data, strlen(data)) : 0;
+    free(data);
+    return key;
+}
+
+void PADnoteParameters::add2XML(XMLwrapper& xml)
+{
+    xml.setPadSynth(true);
+
+    xml.addparbool("stereo", PStereo);
+    add2XMLsamples(xml);
+
     xml.beginbranch("AMPLITUDE_PARAMETERS");
     xml.addpar("volume", PVolume);
     xml.addpar("panning", PPanning);
@@ -1183,6 +1363,9 @@ void PADnoteParameters::getfromXML(XMLwrapper& xml)
         Pquality.oct    = xml.getpar127("octaves", Pquality.oct);
         Pquality.smpoct = xml.getpar127("samples_per_octave",
                                          Pquality.smpoct);
+        Pphaseseed = xml.getpar("phase_seed", Pphaseseed, 0, 65535);
+        Pquality.storage = xml.getpar("storage", Pquality.storage,
+                                      storage_float, storage_int16);
         xml.exitbranch();
     }
 
@@ -1280,6 +1463,8 @@ void PADnoteParameters::paste(PADnoteParameters &x)
     COPY(Pquality.basenote);
     COPY(Pquality.oct);
     COPY(Pquality.smpoct);
+    COPY(Pquality.storage);
+    COPY(Pphaseseed);
 
     oscilgen->paste(*x.oscilgen);
     resonance->paste(*x.resonance);
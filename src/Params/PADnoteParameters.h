@@ -97,8 +97,14 @@ class PADnoteParameters:public Presets
         struct { //quality of the samples (how many samples, the length of them,etc.)
             unsigned char samplesize;
             unsigned char basenote, oct, smpoct;
+            //how the samples are kept in memory, see Sample::scale
+            unsigned char storage;
         } Pquality;
 
+        //seed of the random phases, the same seed always gives the same
+        //samples
+        unsigned short int Pphaseseed;
+
         //frequency parameters
         //If the base frequency is fixed to 440 Hz
         unsigned char Pfixedfreq;
@@ -161,16 +167,36 @@ class PADnoteParameters:public Presets
         //! Compute the #sample array from the other parameters.
         //! For the function's parameters, see sampleGenerator()
         void applyparameters(std::function<bool()> do_abort,
-                             unsigned max_threads = 0);
+                             unsigned max_threads = 0,
+                             bool draft = false);
         void export2wav(std::string basefilename);
 
         OscilGen  *oscilgen;
         Resonance *resonance;
 
+        //! Sample formats of Pquality.storage
+        enum pad_storage {
+            //! 32 bit floats
+            storage_float,
+            //! 16 bit integers with a scale, half the memory
+            storage_int16
+        };
+
         struct Sample {
             int    size;
             float  basefreq;
+            //! size values and the interpolation tail, floats unless the
+            //! sample has a scale
             float *smp;
+            //! Factor of the 16 bit values of a compact sample, 0 for
+            //! float samples
+            float  scale;
+
+            const int16_t *smp16(void) const {return (const int16_t*)smp;}
+            //! Value i as a float, for code that is not time critical
+            float value(int i) const {
+                return scale ? smp16()[i] * scale : smp[i];
+            }
         };
 
         //! RT sample data
@@ -190,9 +216,20 @@ class PADnoteParameters:public Presets
         //!                 user)
         //! @param max_threads Maximum number of threads for computation, or
         //!                    zero if no maximum shall be set
+        //! @param draft Generate a quick low resolution set instead, which
+        //!              is played while the full set is generated
         int sampleGenerator(PADnoteParameters::callback cb,
                             std::function<bool()> do_abort,
-                            unsigned max_threads = 0);
+                            unsigned max_threads = 0,
+                            bool draft = false);
+
+        //! Size of the samples and number of samples of a set
+        int sampleSize(bool draft = false) const;
+        int sampleCount(bool draft = false) const;
+        //! True if the full set takes long to generate (its samples are
+        //! bigger than the draft ones and it is neither shared in memory nor
+        //! cached on disk)
+        bool needsDraft(void);
 
         const AbsTime *time;
         int64_t last_update_timestamp;
@@ -214,6 +251,10 @@ class PADnoteParameters:public Presets
         void deletesamples();
         void deletesample(int n);
 
+        void add2XMLsamples(XMLwrapper& xml);
+        //! Hash of everything the samples depend on, the key in padcache
+        uint64_t sampleKey(void);
+
     public:
         const SYNTH_T &synth;
 };
@@ -0,0 +1,164 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  PADstore.cpp - Shared storage of PADsynth samples
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include "PADstore.h"
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <new>
+#include <utility>
+
+namespace zyn {
+namespace padstore {
+
+//Header in front of the floats of every buffer
+struct alignas(16) Block {
+    int      refs;
+    bool     published;
+    uint64_t key;
+    int      n;
+    int      size;
+    float    basefreq;
+    float    scale;
+
+    float *data(void) {return (float*)(this + 1);}
+};
+
+static Block *block(float *smp)
+{
+    return (Block*)smp - 1;
+}
+
+typedef std::pair<uint64_t, int> Id;
+
+//All reference counts and the index are guarded by one mutex, they are
+//only touched when samples are generated or dropped
+static std::mutex           mutex;
+static std::map<Id, Block*> index;
+static int                  alive = 0;
+
+//Keys of the sets being generated, see Claim
+static std::set<uint64_t>      claimed;
+static std::condition_variable unclaimed;
+
+float *alloc(int length)
+{
+    void  *mem = ::operator new(sizeof(Block) + sizeof(float) * length);
+    Block *b   = new(mem) Block;
+    b->refs      = 1;
+    b->published = false;
+    b->key       = 0;
+    b->n         = 0;
+    b->size      = 0;
+    b->basefreq  = 0.0f;
+    b->scale     = 0.0f;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++alive;
+    return b->data();
+}
+
+float *acquire(float *smp)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ++block(smp)->refs;
+    return smp;
+}
+
+void release(float *smp)
+{
+    if(!smp)
+        return;
+
+    Block *b = block(smp);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(--b->refs)
+            return;
+        if(b->published) {
+            auto itr = index.find(Id(b->key, b->n));
+            if(itr != index.end() && itr->second == b)
+                index.erase(itr);
+        }
+        --alive;
+    }
+    b->~Block();
+    ::operator delete(b);
+}
+
+void publish(uint64_t key, int n, const PADnoteParameters::Sample &smp)
+{
+    Block *b = block(smp.smp);
+    std::lock_guard<std::mutex> lock(mutex);
+    //A set generated twice at the same time keeps the first copy findable
+    if(b->published || index.count(Id(key, n)))
+        return;
+    b->published = true;
+    b->key       = key;
+    b->n         = n;
+    b->size      = smp.size;
+    b->basefreq  = smp.basefreq;
+    b->scale     = smp.scale;
+    index[Id(key, n)] = b;
+}
+
+bool find(uint64_t key, int n, PADnoteParameters::Sample &smp)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto itr = index.find(Id(key, n));
+    if(itr == index.end())
+        return false;
+
+    Block *b = itr->second;
+    ++b->refs;
+    smp.smp      = b->data();
+    smp.size     = b->size;
+    smp.basefreq = b->basefreq;
+    smp.scale    = b->scale;
+    return true;
+}
+
+int buffers(void)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return alive;
+}
+
+Claim::Claim(uint64_t key_, std::function<bool()> do_abort)
+    :key(key_), owner(false)
+{
+    if(!key)
+        return;
+    std::unique_lock<std::mutex> lock(mutex);
+    while(claimed.count(key)) {
+        if(do_abort())
+            return;
+        unclaimed.wait_for(lock, std::chrono::milliseconds(10));
+    }
+    claimed.insert(key);
+    owner = true;
+}
+
+Claim::~Claim(void)
+{
+    if(!owner)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        claimed.erase(key);
+    }
+    unclaimed.notify_all();
+}
+
+}
+}
@@ -0,0 +1,71 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  PADstore.h - Shared storage of PADsynth samples
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include "PADnoteParameters.h"
+
+namespace zyn {
+
+/**
+ * The sample buffers of PADnoteParameters::sample are reference counted and
+ * shared between all instances generated from the same parameters (the same
+ * PADnoteParameters::sampleKey()), so a pad loaded into several parts or kit
+ * items is kept in memory once.
+ *
+ * Every PADnoteParameters::Sample::smp holds one reference. References are
+ * only taken and dropped outside of the realtime thread: the realtime side
+ * swaps the pointers and returns the old one to MiddleWare, which drops it
+ * (see "PADsample" in deallocate()).
+ *
+ * The buffers are 16 byte aligned.
+ */
+namespace padstore {
+
+//New unpublished buffer of length floats (or twice as many 16 bit values),
+//with one reference
+float *alloc(int length);
+//Take another reference
+float *acquire(float *smp);
+//Drop a reference, the last one frees the buffer. NULL is ignored
+void release(float *smp);
+
+//Make the buffer of smp findable as sample n of the set key
+void publish(uint64_t key, int n, const PADnoteParameters::Sample &smp);
+//Fill smp with a new reference to sample n of the set key.
+//Returns false if it is not in memory
+bool find(uint64_t key, int n, PADnoteParameters::Sample &smp);
+
+//Number of buffers alive
+int buffers(void);
+
+/**Generation of the set key by one instance at a time.
+ *
+ * Identical pads applied in parallel (e.g. the parts of a session) would
+ * all miss find() and generate a copy each, as the samples are published
+ * one by one. The first instance claims the key, the others wait until it
+ * is done and then find its samples. Waiting stops when do_abort returns
+ * true. Key 0 (drafts) is never claimed.*/
+class Claim
+{
+    public:
+        Claim(uint64_t key, std::function<bool()> do_abort);
+        Claim(const Claim&) = delete;
+        ~Claim(void);
+    private:
+        uint64_t key;
+        bool     owner;
+};
+
+}
+}
@@ -118,9 +118,6 @@ public:
         synth.buffersize = static_cast<int>(getBufferSize());
         synth.samplerate = static_cast<uint>(getSampleRate());
 
-        if (synth.buffersize > 32)
-            synth.buffersize = 32;
-
         synth.alias();
 
         _initMaster();
@@ -351,8 +348,6 @@ protected:
             mutex.lock();
         }
 
-        uint32_t framesOffset = 0;
-
         for (uint32_t i=0; i<midiEventCount; ++i)
         {
             const MidiEvent& midiEvent(midiEvents[i]);
@@ -364,50 +359,13 @@ protected:
             if (midiEvent.data[0] < 0x80 || midiEvent.data[0] >= 0xF0)
                 continue;
 
-            if (midiEvent.frame > framesOffset)
-            {
-                master->GetAudioOutSamples(midiEvent.frame-framesOffset, synth.samplerate, outputs[0]+framesOffset,
-                                                                                           outputs[1]+framesOffset);
-                framesOffset = midiEvent.frame;
-            }
-
             const uint8_t status  = midiEvent.data[0] & 0xF0;
             const char    channel = midiEvent.data[0] & 0x0F;
 
-            switch (status)
+            // program changes go through middleware, everything else is
+            // applied by master at the right frame
+            if (status == 0xC0)
             {
-            case 0x80: {
-                const char note = static_cast<char>(midiEvent.data[1]);
-
-                master->noteOff(channel, note);
-            } break;
-
-            case 0x90: {
-                const char note = static_cast<char>(midiEvent.data[1]);
-                const char velo = static_cast<char>(midiEvent.data[2]);
-
-                master->noteOn(channel, note, velo);
-            } break;
-
-            case 0xA0: {
-                const char note     = static_cast<char>(midiEvent.data[1]);
-                const char pressure = static_cast<char>(midiEvent.data[2]);
-
-                master->polyphonicAftertouch(channel, note, pressure);
-            } break;
-
-            case 0xB0: {
-                const int control = midiEvent.data[1];
-                const int value   = midiEvent.data[2];
-
-                // skip controls which we map to parameters
-                //if (getIndexFromZynControl(midiEvent.data[1]) != kParamCount)
-                //    continue;
-
-                master->setController(channel, control, value);
-            } break;
-
-            case 0xC0: {
                 const int program = midiEvent.data[1];
 
                 for(int i=0; i < NUM_MIDI_PARTS; ++i) {
@@ -416,21 +374,19 @@ protected:
                         middleware->pendingSetProgram(i, program);
                     }
                 }
-            } break;
+                continue;
+            }
 
-            case 0xE0: {
-                const uint8_t lsb = midiEvent.data[1];
-                const uint8_t msb = midiEvent.data[2];
-                const int   value = ((msb << 7) | lsb) - 8192;
+            // skip controls which we map to parameters
+            //if (status == 0xB0 && getIndexFromZynControl(midiEvent.data[1]) != kParamCount)
+            //    continue;
 
-                master->setController(channel, zyn::C_pitchwheel, value);
-            } break;
-            }
+            // a full queue only costs timing accuracy
+            if (! master->queueMidi(midiEvent.frame, midiEvent.data, midiEvent.size))
+                master->midiMessage(midiEvent.data, midiEvent.size);
         }
 
-        if (frames > framesOffset)
-            master->GetAudioOutSamples(frames-framesOffset, synth.samplerate, outputs[0]+framesOffset,
-                                                                              outputs[1]+framesOffset);
+        master->GetAudioOutSamples(frames, synth.samplerate, outputs[0], outputs[1]);
 
         mutex.unlock();
     }
@@ -454,9 +410,6 @@ protected:
 
         synth.buffersize = static_cast<int>(newBufferSize);
 
-        if (synth.buffersize > 32)
-            synth.buffersize = 32;
-
         synth.alias();
 
         _initMaster();
@@ -11,6 +11,7 @@
   of the License, or (at your option) any later version.
 */
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <cstdio>
@@ -24,12 +25,11 @@
 #include "../Params/ADnoteParameters.h"
 #include "../Containers/ScratchString.h"
 #include "../Containers/NotePool.h"
+#include "../DSP/OscilKernels.h"
 #include "ModFilter.h"
 #include "OscilGen.h"
 #include "ADnote.h"
 
-#define LENGTHOF(x) ((int)(sizeof(x)/sizeof(x[0])))
-
 namespace zyn {
 ADnote::ADnote(ADnoteParameters *pars_, const SynthParams &spars,
         WatchManager *wm, const char *prefix)
@@ -49,6 +49,7 @@ ADnote::ADnote(ADnoteParameters *pars_, const SynthParams &spars,
     velocity    = spars.velocity;
     initial_seed = spars.seed;
     current_prng_state = spars.seed;
+    rng.reset(spars.seed);
     stereo = pars.GlobalPar.PStereo;
 
     NoteGlobalPar.Detune = getdetune(pars.GlobalPar.PDetuneType,
@@ -108,7 +109,7 @@ void ADnote::setupVoice(int nvoice)
     for (int i = 0; i < 14; i++)
         voice.pinking[i] = 0.0;
 
-    param.OscilGn->newrandseed(prng());
+    param.OscilGn->newrandseed(rng.next());
     voice.OscilSmp = NULL;
     voice.FMSmp    = NULL;
     voice.VoiceOut = NULL;
@@ -141,11 +142,11 @@ void ADnote::setupVoice(int nvoice)
     voice.oscfreqhi   = memory.valloc<int>(unison);
     voice.oscfreqlo   = memory.valloc<float>(unison);
 
-    voice.oscfreqhiFM = memory.valloc<unsigned int>(unison);
+    voice.oscfreqhiFM = memory.valloc<int>(unison);
     voice.oscfreqloFM = memory.valloc<float>(unison);
     voice.oscposhi    = memory.valloc<int>(unison);
     voice.oscposlo    = memory.valloc<float>(unison);
-    voice.oscposhiFM  = memory.valloc<unsigned int>(unison);
+    voice.oscposhiFM  = memory.valloc<int>(unison);
     voice.oscposloFM  = memory.valloc<float>(unison);
 
     voice.Enabled     = ON;
@@ -170,7 +171,7 @@ void ADnote::setupVoice(int nvoice)
     if(pars.VoicePar[nvoice].Pextoscil != -1)
         vc = pars.VoicePar[nvoice].Pextoscil;
     if(!pars.GlobalPar.Hrandgrouping)
-        pars.VoicePar[vc].OscilGn->newrandseed(prng());
+        pars.VoicePar[vc].OscilGn->newrandseed(rng.next());
     int oscposhi_start =
         pars.VoicePar[vc].OscilGn->get(NoteVoicePar[nvoice].OscilSmp,
                 getvoicebasefreq(nvoice),
@@ -205,7 +206,7 @@ void ADnote::setupVoice(int nvoice)
         voice.oscposhi[k] = kth_start % synth.oscilsize;
         //put random starting point for other subvoices
         kth_start      = oscposhi_start +
-            (int)(RND * pars.VoicePar[nvoice].Unison_phase_randomness /
+            (int)(rng.unit() * pars.VoicePar[nvoice].Unison_phase_randomness /
                     127.0f * (synth.oscilsize - 1));
     }
 
@@ -214,6 +215,7 @@ void ADnote::setupVoice(int nvoice)
 
     voice.AmpLfo      = NULL;
     voice.AmpEnvelope = NULL;
+    voice.envamplitude = 1.0f;
 
     voice.Filter         = NULL;
     voice.FilterEnvelope = NULL;
@@ -237,27 +239,33 @@ void ADnote::setupVoice(int nvoice)
                     - 1.0f) / synth.buffersize_f / 10.0f * synth.samplerate_f);
 }
 
-int ADnote::setupVoiceUnison(int nvoice)
+//Number of subvoices a voice is played with
+static int unisonSize(const ADnoteVoiceParam &param)
 {
-    auto &voice = NoteVoicePar[nvoice];
-
-    int unison = pars.VoicePar[nvoice].Unison_size;
+    int unison = param.Unison_size;
     if(unison < 1)
         unison = 1;
 
-    bool is_pwm = pars.VoicePar[nvoice].PFMEnabled == FMTYPE::PW_MOD;
-
-    if (pars.VoicePar[nvoice].Type != 0) {
+    if (param.Type != 0) {
         // Since noise unison of greater than two is touch goofy...
         if (unison > 2)
             unison = 2;
-    } else if (is_pwm) {
+    } else if (param.PFMEnabled == FMTYPE::PW_MOD) {
         /* Pulse width mod uses pairs of subvoices. */
         unison *= 2;
         // This many is likely to sound like noise anyhow.
         if (unison > 64)
             unison = 64;
     }
+    return unison;
+}
+
+int ADnote::setupVoiceUnison(int nvoice)
+{
+    auto &voice = NoteVoicePar[nvoice];
+
+    const int unison = unisonSize(pars.VoicePar[nvoice]);
+    bool is_pwm = pars.VoicePar[nvoice].PFMEnabled == FMTYPE::PW_MOD;
 
     //compute unison
     voice.unison_size = unison;
@@ -286,7 +294,7 @@ int ADnote::setupVoiceUnison(int nvoice)
             float min = -1e-6f, max = 1e-6f;
             for(int k = 0; k < true_unison; ++k) {
                 float step = (k / (float) (true_unison - 1)) * 2.0f - 1.0f; //this makes the unison spread more uniform
-                float val  = step + (RND * 2.0f - 1.0f) / (true_unison - 1);
+                float val  = step + (rng.unit() * 2.0f - 1.0f) / (true_unison - 1);
                 unison_values[k] = val;
                 if (min > val) {
                     min = val;
@@ -327,12 +335,12 @@ int ADnote::setupVoiceUnison(int nvoice)
     const float vib_speed = pars.VoicePar[nvoice].Unison_vibratto_speed / 127.0f;
     const float vibratto_base_period  = 0.25f * powf(2.0f, (1.0f - vib_speed) * 4.0f);
     for(int k = 0; k < unison; ++k) {
-        voice.unison_vibratto.position[k] = RND * 1.8f - 0.9f;
+        voice.unison_vibratto.position[k] = rng.unit() * 1.8f - 0.9f;
         //make period to vary randomly from 50% to 200% vibratto base period
         const float vibratto_period = vibratto_base_period
-            * powf(2.0f, RND * 2.0f - 1.0f);
+            * powf(2.0f, rng.unit() * 2.0f - 1.0f);
 
-        const float m = (RND < 0.5f ? -1.0f : 1.0f) *
+        const float m = (rng.unit() < 0.5f ? -1.0f : 1.0f) *
             4.0f / (vibratto_period * increments_per_second);
         voice.unison_vibratto.step[k] = m;
 
@@ -369,7 +377,7 @@ int ADnote::setupVoiceUnison(int nvoice)
                 break;
             case 1:
                 for(int k = 0; k < unison; ++k)
-                    voice.unison_invert_phase[k] = (RND > 0.5f);
+                    voice.unison_invert_phase[k] = (rng.unit() > 0.5f);
                 break;
             default:
                 for(int k = 0; k < unison; ++k)
@@ -435,7 +443,7 @@ void ADnote::setupVoiceMod(int nvoice, bool first_run)
 
     //Triggers when a user enables modulation on a running voice
     if(!first_run && voice.FMEnabled != FMTYPE::NONE && voice.FMSmp == NULL && voice.FMVoice < 0) {
-        param.FmGn->newrandseed(prng());
+        param.FmGn->newrandseed(rng.next());
         voice.FMSmp = memory.valloc<float>(synth.oscilsize + OSCIL_SMP_EXTRA_SAMPLES);
         memset(voice.FMSmp, 0, sizeof(float)*(synth.oscilsize + OSCIL_SMP_EXTRA_SAMPLES));
         int vc = nvoice;
@@ -449,7 +457,7 @@ void ADnote::setupVoiceMod(int nvoice, bool first_run)
             tmp = getFMvoicebasefreq(nvoice);
 
         if(!pars.GlobalPar.Hrandgrouping)
-            pars.VoicePar[vc].FmGn->newrandseed(prng());
+            pars.VoicePar[vc].FmGn->newrandseed(rng.next());
 
         for(int k = 0; k < voice.unison_size; ++k)
             voice.oscposhiFM[k] = (voice.oscposhi[k]
@@ -502,8 +510,65 @@ SynthNote *ADnote::cloneLegato(void)
 {
     SynthParams sp{memory, ctl, synth, time, velocity,
                 (bool)portamento, legato.param.note_log2_freq, true,
-                initial_seed };
-    return memory.alloc<ADnote>(&pars, sp);
+                initial_seed, audiblefloor};
+    return allocNote<ADnote>(&pars, sp);
+}
+
+//Mirrors the allocations of the constructor and initparameters()
+size_t ADnote::footprint(const ADnoteParameters &pars, const SYNTH_T &synth)
+{
+    const bool   stereo  = pars.GlobalPar.PStereo;
+    const size_t buffer  = NoteArena::footprint<float>(synth.buffersize);
+    const size_t oscil   = NoteArena::footprint<float>(
+            synth.oscilsize + OSCIL_SMP_EXTRA_SAMPLES);
+    const size_t env     = NoteArena::footprint<Envelope>();
+    const size_t lfo     = NoteArena::footprint<LFO>();
+
+    size_t size = NoteArena::footprint<ADnote>() + 4 * buffer
+        + 3 * env + 3 * lfo
+        + ModFilter::footprint(*pars.GlobalPar.GlobalFilter, synth, stereo);
+
+    int max_unison = 1;
+    for(int nvoice = 0; nvoice < NUM_VOICES; ++nvoice) {
+        const ADnoteVoiceParam &param = pars.VoicePar[nvoice];
+        if(!param.Enabled)
+            continue;
+
+        const int unison = unisonSize(param);
+        max_unison = std::max(max_unison, unison);
+        //oscillator positions and frequencies, unison and FM state
+        size += 13 * NoteArena::footprint<float>(unison)
+            + NoteArena::footprint<bool>(unison) + oscil;
+
+        if(param.PAmpEnvelopeEnabled)
+            size += env;
+        if(param.PAmpLfoEnabled)
+            size += lfo;
+        if(param.PFreqEnvelopeEnabled)
+            size += env;
+        if(param.PFreqLfoEnabled)
+            size += lfo;
+        if(param.PFilterEnabled) {
+            size += ModFilter::footprint(*param.VoiceFilter, synth, stereo);
+            if(param.PFilterEnvelopeEnabled)
+                size += env;
+            if(param.PFilterLfoEnabled)
+                size += lfo;
+        }
+        if(param.Type == 0 && param.PFMEnabled != FMTYPE::NONE
+                && (param.PFMVoice < 0 || param.PFMVoice >= nvoice))
+            size += oscil;
+        if(param.PFMFreqEnvelopeEnabled)
+            size += env;
+        if(param.PFMAmpEnvelopeEnabled)
+            size += env;
+        //output of a voice used as modulator
+        if(param.PFMVoice >= 0 && param.PFMVoice < nvoice)
+            size += buffer;
+    }
+
+    return size + NoteArena::footprint<float*>(max_unison)
+        + max_unison * buffer;
 }
 
 // ADlegatonote: This function is (mostly) a copy of ADnote(...) and
@@ -521,6 +586,7 @@ void ADnote::legatonote(const LegatoParams &lpars)
     note_log2_freq = lpars.note_log2_freq;
     initial_seed = lpars.seed;
     current_prng_state = lpars.seed;
+    rng.reset(lpars.seed);
 
     if(lpars.velocity > 1.0f)
         velocity = 1.0f;
@@ -702,7 +768,7 @@ void ADnote::legatonote(const LegatoParams &lpars)
         /* Voice Modulation Parameters Init */
         if((NoteVoicePar[nvoice].FMEnabled != FMTYPE::NONE)
            && (NoteVoicePar[nvoice].FMVoice < 0)) {
-            pars.VoicePar[nvoice].FmGn->newrandseed(prng());
+            pars.VoicePar[nvoice].FmGn->newrandseed(rng.next());
 
             //Perform Anti-aliasing only on MIX or RING MODULATION
 
@@ -711,7 +777,7 @@ void ADnote::legatonote(const LegatoParams &lpars)
                 vc = pars.VoicePar[nvoice].PextFMoscil;
 
             if(!pars.GlobalPar.Hrandgrouping)
-                pars.VoicePar[vc].FmGn->newrandseed(prng());
+                pars.VoicePar[vc].FmGn->newrandseed(rng.next());
 
             for(int i = 0; i < OSCIL_SMP_EXTRA_SAMPLES; ++i)
                 NoteVoicePar[nvoice].FMSmp[synth.oscilsize + i] =
@@ -737,6 +803,25 @@ void ADnote::legatonote(const LegatoParams &lpars)
 }
 
 
+/*
+ * A released voice whose level (without LFOs) fell below the audible floor
+ * is retired like one whose amplitude envelope has finished. Voices which
+ * modulate other voices are kept, their own volume says nothing about the
+ * level of the voices they modulate.
+ */
+bool ADnote::inaudible(const Voice &vce) const
+{
+    return audiblefloor > 0.0f && !vce.VoiceOut
+           && NoteGlobalPar.AmpEnvelope->released()
+           && vce.envamplitude * fabsf(vce.Volume) * globalenvamplitude
+              < audiblefloor;
+}
+
+bool ADnote::retiring(const Voice &vce) const
+{
+    return inaudible(vce) || (vce.AmpEnvelope && vce.AmpEnvelope->finished());
+}
+
 /*
  * Kill a voice of ADnote
  */
@@ -808,11 +893,12 @@ void ADnote::initparameters(WatchManager *wm, const char *prefix)
     NoteGlobalPar.initparameters(pars.GlobalPar, synth,
                                  time,
                                  memory, basefreq, velocity,
-                                 stereo, wm, prefix);
+                                 stereo, wm, prefix, rng);
 
     NoteGlobalPar.AmpEnvelope->envout_dB(); //discard the first envelope output
-    globalnewamplitude = NoteGlobalPar.Volume
-                         * NoteGlobalPar.AmpEnvelope->envout_dB()
+    globalenvamplitude = NoteGlobalPar.Volume
+                         * NoteGlobalPar.AmpEnvelope->envout_dB();
+    globalnewamplitude = globalenvamplitude
                          * NoteGlobalPar.AmpLfo->amplfoout();
 
     // Forbids the Modulation Voice to be greater or equal than voice
@@ -854,7 +940,7 @@ void ADnote::initparameters(WatchManager *wm, const char *prefix)
 
         if(param.PAmpLfoEnabled) {
             vce.AmpLfo = memory.alloc<LFO>(*param.AmpLfo, basefreq, time, wm,
-                    (pre+"VoicePar"+nvoice+"/AmpLfo/").c_str);
+                    (pre+"VoicePar"+nvoice+"/AmpLfo/").c_str, rng.next());
             vce.newamplitude *= vce.AmpLfo->amplfoout();
         }
 
@@ -866,7 +952,7 @@ void ADnote::initparameters(WatchManager *wm, const char *prefix)
 
         if(param.PFreqLfoEnabled)
             vce.FreqLfo = memory.alloc<LFO>(*param.FreqLfo, basefreq, time, wm,
-                    (pre+"VoicePar"+nvoice+"/FreqLfo/").c_str);
+                    (pre+"VoicePar"+nvoice+"/FreqLfo/").c_str, rng.next());
 
         /* Voice Filter Parameters Init */
         if(param.PFilterEnabled) {
@@ -886,14 +972,14 @@ void ADnote::initparameters(WatchManager *wm, const char *prefix)
 
             if(param.PFilterLfoEnabled) {
                 vce.FilterLfo = memory.alloc<LFO>(*param.FilterLfo, basefreq, time, wm,
-                        (pre+"VoicePar"+nvoice+"/FilterLfo/").c_str);
+                        (pre+"VoicePar"+nvoice+"/FilterLfo/").c_str, rng.next());
                 vce.Filter->addMod(*vce.FilterLfo);
             }
         }
 
         /* Voice Modulation Parameters Init */
         if((vce.FMEnabled != FMTYPE::NONE) && (vce.FMVoice < 0)) {
-            param.FmGn->newrandseed(prng());
+            param.FmGn->newrandseed(rng.next());
             vce.FMSmp = memory.valloc<float>(synth.oscilsize + OSCIL_SMP_EXTRA_SAMPLES);
 
             //Perform Anti-aliasing only on MIX or RING MODULATION
@@ -909,7 +995,7 @@ void ADnote::initparameters(WatchManager *wm, const char *prefix)
                 tmp = getFMvoicebasefreq(nvoice);
 
             if(!pars.GlobalPar.Hrandgrouping)
-                pars.VoicePar[vc].FmGn->newrandseed(prng());
+                pars.VoicePar[vc].FmGn->newrandseed(rng.next());
 
             for(int k = 0; k < vce.unison_size; ++k)
                 vce.oscposhiFM[k] = (vce.oscposhi[k]
@@ -1083,8 +1169,9 @@ void ADnote::computecurrentparameters()
                            + NoteGlobalPar.FreqLfo->lfoout()
                            * ctl.modwheel.relmod);
     globaloldamplitude = globalnewamplitude;
-    globalnewamplitude = NoteGlobalPar.Volume
-                         * NoteGlobalPar.AmpEnvelope->envout_dB()
+    globalenvamplitude = NoteGlobalPar.Volume
+                         * NoteGlobalPar.AmpEnvelope->envout_dB();
+    globalnewamplitude = globalenvamplitude
                          * NoteGlobalPar.AmpLfo->amplfoout();
 
     NoteGlobalPar.Filter->update(relfreq, ctl.filterq.relq);
@@ -1116,6 +1203,7 @@ void ADnote::computecurrentparameters()
 
         if(NoteVoicePar[nvoice].AmpEnvelope)
             vce.newamplitude *= NoteVoicePar[nvoice].AmpEnvelope->envout_dB();
+        vce.envamplitude = vce.newamplitude;
 
         if(NoteVoicePar[nvoice].AmpLfo)
             vce.newamplitude *= NoteVoicePar[nvoice].AmpLfo->amplfoout();
@@ -1177,22 +1265,22 @@ void ADnote::computecurrentparameters()
 /*
  * Fadein in a way that removes clicks but keep sound "punchy"
  */
-inline void ADnote::fadein(float *smps) const
+inline void ADnote::fadein(float *smps, int nsamples) const
 {
     int zerocrossings = 0;
-    for(int i = 1; i < synth.buffersize; ++i)
+    for(int i = 1; i < nsamples; ++i)
         if((smps[i - 1] < 0.0f) && (smps[i] > 0.0f))
             zerocrossings++;  //this is only the positive crossings
 
-    float tmp = (synth.buffersize_f - 1.0f) / (zerocrossings + 1) / 3.0f;
+    float tmp = (nsamples - 1.0f) / (zerocrossings + 1) / 3.0f;
     if(tmp < 8.0f)
         tmp = 8.0f;
     tmp *= NoteGlobalPar.Fadein_adjustment;
 
     int n;
     F2I(tmp, n); //how many samples is the fade-in
-    if(n > synth.buffersize)
-        n = synth.buffersize;
+    if(n > nsamples)
+        n = nsamples;
     for(int i = 0; i < n; ++i) { //fade-in
         float tmp = 0.5f - cosf((float)i / (float) n * PI) * 0.5f;
         smps[i] *= tmp;
@@ -1201,150 +1289,39 @@ inline void ADnote::fadein(float *smps) const
 
 /*
  * Computes the Oscillator (Without Modulation) - LinearInterpolation
+ *
+ * All unison subvoices are rendered at once, see DSP/OscilKernels.h
  */
-
-/* As the code here is a bit odd due to optimization, here is what happens
- * First the current position and frequency are retrieved from the running
- * state. These are broken up into high and low portions to indicate how many
- * samples are skipped in one step and how many fractional samples are skipped.
- * Outside of this method the fractional samples are just handled with floating
- * point code, but that's a bit slower than it needs to be. In this code the low
- * portions are known to exist between 0.0 and 1.0 and it is known that they are
- * stored in single precision floating point IEEE numbers. This implies that
- * a maximum of 24 bits are significant. The below code does your standard
- * linear interpolation that you'll see throughout this codebase, but by
- * sticking to integers for tracking the overflow of the low portion, around 15%
- * of the execution time was shaved off in the ADnote test.
- */
-inline void ADnote::ComputeVoiceOscillator_LinearInterpolation(int nvoice)
+inline void ADnote::ComputeVoiceOscillator_LinearInterpolation(int nvoice,
+                                                               int nsamples)
 {
     Voice& vce = NoteVoicePar[nvoice];
-    for(int k = 0; k < vce.unison_size; ++k) {
-        int    poshi  = vce.oscposhi[k];
-        // convert floating point fractional part (sample interval phase)
-        // with range [0.0 ... 1.0] to fixed point with 1 digit is 2^-24
-        // by multiplying with precalculated 2^24 and casting to integer:
-        int    poslo  = (int)(vce.oscposlo[k] * 16777216.0f);
-        int    freqhi = vce.oscfreqhi[k];
-        // same for phase increment:
-        int    freqlo = (int)(vce.oscfreqlo[k] * 16777216.0f);
-        float *smps   = NoteVoicePar[nvoice].OscilSmp;
-        float *tw     = tmpwave_unison[k];
-        assert(vce.oscfreqlo[k] < 1.0f);
-        for(int i = 0; i < synth.buffersize; ++i) {
-            tw[i]  = (smps[poshi] * (0x01000000 - poslo) + smps[poshi + 1] * poslo)/(16777216.0f);
-            poslo += freqlo;                // increment fractional part (sample interval phase)
-            poshi += freqhi + (poslo>>24);  // add overflow over 24 bits in poslo to poshi
-            poslo &= 0xffffff;              // remove overflow from poslo
-            poshi &= synth.oscilsize - 1;   // remove overflow
-        }
-        vce.oscposhi[k] = poshi;
-        vce.oscposlo[k] = poslo/(16777216.0f);
-    }
+    oscil::linear(tmpwave_unison, vce.OscilSmp, synth.oscilsize,
+                  vce.oscposhi, vce.oscposlo, vce.oscfreqhi, vce.oscfreqlo,
+                  vce.unison_size, nsamples);
 }
 
 
 /*
  * Computes the Oscillator (Without Modulation) - windowed sinc Interpolation
  */
-
-/* As the code here is a bit odd due to optimization, here is what happens
- * First the current position and frequency are retrieved from the running
- * state. These are broken up into high and low portions to indicate how many
- * samples are skipped in one step and how many fractional samples are skipped.
- * Outside of this method the fractional samples are just handled with floating
- * point code, but that's a bit slower than it needs to be. In this code the low
- * portions are known to exist between 0.0 and 1.0 and it is known that they are
- * stored in single precision floating point IEEE numbers. This implies that
- * a maximum of 24 bits are significant. The below code does your standard
- * linear interpolation that you'll see throughout this codebase, but by
- * sticking to integers for tracking the overflow of the low portion, around 15%
- * of the execution time was shaved off in the ADnote test.
- */
-inline void ADnote::ComputeVoiceOscillator_SincInterpolation(int nvoice)
+inline void ADnote::ComputeVoiceOscillator_SincInterpolation(int nvoice,
+                                                             int nsamples)
 {
-    // windowed sinc kernel factor Fs*0.3, rejection 80dB
-    const float_t kernel[] = {
-        0.0010596256917418426f,
-        0.004273442181254887f,
-        0.0035466063043375785f,
-        -0.014555483937137638f,
-        -0.04789321342588484f,
-        -0.050800020978553066f,
-        0.04679847159974432f,
-        0.2610646708018185f,
-        0.4964802251145513f,
-        0.6000513532962539f,
-        0.4964802251145513f,
-        0.2610646708018185f,
-        0.04679847159974432f,
-        -0.050800020978553066f,
-        -0.04789321342588484f,
-        -0.014555483937137638f,
-        0.0035466063043375785f,
-        0.004273442181254887f,
-        0.0010596256917418426f
-        };
-
-
-
     Voice& vce = NoteVoicePar[nvoice];
-    for(int k = 0; k < vce.unison_size; ++k) {
-        int    poshi  = vce.oscposhi[k];
-        int    poslo  = (int)(vce.oscposlo[k] * (1<<24));
-        int    freqhi = vce.oscfreqhi[k];
-        int    freqlo = (int)(vce.oscfreqlo[k] * (1<<24));
-        int    ovsmpfreqhi = vce.oscfreqhi[k] / 2;
-        int    ovsmpfreqlo = (int)((vce.oscfreqlo[k] / 2) * (1<<24));
-
-        int    ovsmpposlo;
-        int    ovsmpposhi;
-        int    uflow;
-        float *smps   = NoteVoicePar[nvoice].OscilSmp;
-        float *tw     = tmpwave_unison[k];
-        assert(vce.oscfreqlo[k] < 1.0f);
-        float out = 0;
-
-        for(int i = 0; i < synth.buffersize; ++i) {
-            ovsmpposlo  = poslo - (LENGTHOF(kernel)-1)/2 * ovsmpfreqlo;
-            uflow = ovsmpposlo>>24;
-            ovsmpposhi  = poshi - (LENGTHOF(kernel)-1)/2 * ovsmpfreqhi - ((0x00 - uflow) & 0xff);
-            ovsmpposlo &= 0xffffff;
-            ovsmpposhi &= synth.oscilsize - 1;
-            out = 0;
-            for (int l = 0; l<LENGTHOF(kernel); l++) {
-                out += kernel[l] * (
-                    smps[ovsmpposhi]     * ((1<<24) - ovsmpposlo) +
-                    smps[ovsmpposhi + 1] * ovsmpposlo)/(1.0f*(1<<24));
-                // advance to next kernel sample
-                ovsmpposlo += ovsmpfreqlo;
-                ovsmpposhi += ovsmpfreqhi + (ovsmpposlo>>24); // add the 24-bit overflow
-                ovsmpposlo &= 0xffffff;
-                ovsmpposhi &= synth.oscilsize - 1;
-
-            }
-
-            // advance to next sample
-            poslo += freqlo;
-            poshi += freqhi + (poslo>>24);
-            poslo &= 0xffffff;
-            poshi &= synth.oscilsize - 1;
-
-            tw[i] = out;
-
-        }
-        vce.oscposhi[k] = poshi;
-        vce.oscposlo[k] = poslo/(1.0f*(1<<24));
-    }
+    oscil::sinc(tmpwave_unison, vce.OscilSmp, synth.oscilsize,
+                vce.oscposhi, vce.oscposlo, vce.oscfreqhi, vce.oscfreqlo,
+                vce.unison_size, nsamples);
 }
 
 
 /*
  * Computes the Oscillator (Mixing)
  */
-inline void ADnote::ComputeVoiceOscillatorMix(int nvoice)
+inline void ADnote::ComputeVoiceOscillatorMix(int nvoice, int pos,
+                                              int nsamples)
 {
-    ComputeVoiceOscillator_LinearInterpolation(nvoice);
+    ComputeVoiceOscillator_LinearInterpolation(nvoice, nsamples);
 
     Voice& vce = NoteVoicePar[nvoice];
     if(vce.FMnewamplitude > 1.0f)
@@ -1357,10 +1334,10 @@ inline void ADnote::ComputeVoiceOscillatorMix(int nvoice)
         int FMVoice = NoteVoicePar[nvoice].FMVoice;
         for(int k = 0; k < vce.unison_size; ++k) {
             float *tw = tmpwave_unison[k];
-            for(int i = 0; i < synth.buffersize; ++i) {
+            for(int i = 0; i < nsamples; ++i) {
                 float amp = INTERPOLATE_AMPLITUDE(vce.FMoldamplitude,
                                             vce.FMnewamplitude,
-                                            i,
+                                            pos + i,
                                             synth.buffersize);
                 tw[i] = tw[i]
                     * (1.0f - amp) + amp * NoteVoicePar[FMVoice].VoiceOut[i];
@@ -1375,10 +1352,10 @@ inline void ADnote::ComputeVoiceOscillatorMix(int nvoice)
             float  freqloFM = vce.oscfreqloFM[k];
             float *tw = tmpwave_unison[k];
 
-            for(int i = 0; i < synth.buffersize; ++i) {
+            for(int i = 0; i < nsamples; ++i) {
                 float amp = INTERPOLATE_AMPLITUDE(vce.FMoldamplitude,
                                             vce.FMnewamplitude,
-                                            i,
+                                            pos + i,
                                             synth.buffersize);
                 tw[i] = tw[i] * (1.0f - amp) + amp
                         * (NoteVoicePar[nvoice].FMSmp[poshiFM] * (1 - posloFM)
@@ -1399,9 +1376,10 @@ inline void ADnote::ComputeVoiceOscillatorMix(int nvoice)
 /*
  * Computes the Oscillator (Ring Modulation)
  */
-inline void ADnote::ComputeVoiceOscillatorRingModulation(int nvoice)
+inline void ADnote::ComputeVoiceOscillatorRingModulation(int nvoice, int pos,
+                                                         int nsamples)
 {
-    ComputeVoiceOscillator_LinearInterpolation(nvoice);
+    ComputeVoiceOscillator_LinearInterpolation(nvoice, nsamples);
 
     Voice& vce = NoteVoicePar[nvoice];
     if(vce.FMnewamplitude > 1.0f)
@@ -1412,10 +1390,10 @@ inline void ADnote::ComputeVoiceOscillatorRingModulation(int nvoice)
         // if I use VoiceOut[] as modullator
         for(int k = 0; k < vce.unison_size; ++k) {
             float *tw = tmpwave_unison[k];
-            for(int i = 0; i < synth.buffersize; ++i) {
+            for(int i = 0; i < nsamples; ++i) {
                 float amp = INTERPOLATE_AMPLITUDE(vce.FMoldamplitude,
                                             vce.FMnewamplitude,
-                                            i,
+                                            pos + i,
                                             synth.buffersize);
                 int FMVoice = NoteVoicePar[nvoice].FMVoice;
                 tw[i] *= (1.0f - amp) + amp * NoteVoicePar[FMVoice].VoiceOut[i];
@@ -1429,10 +1407,10 @@ inline void ADnote::ComputeVoiceOscillatorRingModulation(int nvoice)
             float  freqloFM = vce.oscfreqloFM[k];
             float *tw = tmpwave_unison[k];
 
-            for(int i = 0; i < synth.buffersize; ++i) {
+            for(int i = 0; i < nsamples; ++i) {
                 float amp = INTERPOLATE_AMPLITUDE(vce.FMoldamplitude,
                                             vce.FMnewamplitude,
-                                            i,
+                                            pos + i,
                                             synth.buffersize);
                 tw[i] *= (NoteVoicePar[nvoice].FMSmp[poshiFM] * (1.0f - posloFM)
                           + NoteVoicePar[nvoice].FMSmp[poshiFM
@@ -1451,137 +1429,152 @@ inline void ADnote::ComputeVoiceOscillatorRingModulation(int nvoice)
         }
 }
 
+//fmodf(phase, size) for the integrated FM phase, which leaves
+//(-size, size) by less than one period per sample unless the modulation is
+//extreme; the subtraction is exact in that range
+static inline float wrapPhase(float phase, float size)
+{
+    if(phase >= size)
+        phase -= size;
+    else if(phase <= -size)
+        phase += size;
+    if(fabsf(phase) >= size)
+        phase = fmodf(phase, size);
+    return phase;
+}
+
 /*
- * Computes the Oscillator (Phase Modulation or Frequency Modulation)
+ * Carrier of one unison subvoice, modulated by mod (scaled by sign and the
+ * modulator amplitude). The modes are template parameters so that the
+ * per-sample loop has no branches on them. It computes the n samples from
+ * pos of a buffer, the modulator amplitude moves over the whole buffer.
  */
-inline void ADnote::ComputeVoiceOscillatorFrequencyModulation(int nvoice,
-                                                              FMTYPE FMmode)
+template<bool freqmod, bool interpolate>
+static inline void modulatedCarrier(float *out, const float *mod, float sign,
+                                    float oldamp, float newamp,
+                                    float normalize, float &fmold,
+                                    const float *smps, int oscilsize,
+                                    int &poshi_, int &poslo_, int freqhi,
+                                    int freqlo, int offset, int pos, int n,
+                                    int buffersize)
 {
-    Voice& vce = NoteVoicePar[nvoice];
-    if(NoteVoicePar[nvoice].FMVoice >= 0) {
-        //if I use VoiceOut[] as modulator
-        for(int k = 0; k < vce.unison_size; ++k) {
-            float *tw = tmpwave_unison[k];
-            const float *smps = NoteVoicePar[NoteVoicePar[nvoice].FMVoice].VoiceOut;
-            if (FMmode == FMTYPE::PW_MOD && (k & 1))
-                for (int i = 0; i < synth.buffersize; ++i)
-                    tw[i] = -smps[i];
-            else
-                memcpy(tw, smps, synth.bufferbytes);
-        }
-    } else {
-        //Compute the modulator and store it in tmpwave_unison[][]
-        for(int k = 0; k < vce.unison_size; ++k) {
-            int    poshiFM  = vce.oscposhiFM[k];
-            int    posloFM  = (int)(vce.oscposloFM[k]  * (1<<24));
-            int    freqhiFM = vce.oscfreqhiFM[k];
-            int    freqloFM = (int)(vce.oscfreqloFM[k] * (1<<24));
-            float *tw = tmpwave_unison[k];
-            const float *smps = NoteVoicePar[nvoice].FMSmp;
+    const float size  = oscilsize;
+    int         poshi = poshi_;
+    int         poslo = poslo_;
+    float       phase = fmold;
+    for(int i = 0; i < n; ++i) {
+        float m = sign * mod[i];
+        if(interpolate)
+            m *= INTERPOLATE_AMPLITUDE(oldamp, newamp, pos + i, buffersize);
+        else
+            m *= newamp;
+        if(freqmod)
+            m = phase = wrapPhase(phase + m * normalize, size);
+        else
+            m *= normalize;
 
-            for(int i = 0; i < synth.buffersize; ++i) {
-                tw[i] = (smps[poshiFM] * ((1<<24) - posloFM)
-                         + smps[poshiFM + 1] * posloFM) / (1.0f*(1<<24));
-                if (FMmode == FMTYPE::PW_MOD && (k & 1))
-                    tw[i] = -tw[i];
+        int FMmodfreqhi = 0;
+        F2I(m, FMmodfreqhi);
+        float FMmodfreqlo = m-FMmodfreqhi;//fmod(m /*+ 0.0000000001f*/, 1.0f);
+        if(FMmodfreqhi < 0)
+            FMmodfreqlo++;
 
-                posloFM += freqloFM;
-                if(posloFM >= (1<<24)) {
-                    posloFM &= 0xffffff;//fmod(posloFM, 1.0f);
-                    poshiFM++;
-                }
-                poshiFM += freqhiFM;
-                poshiFM &= synth.oscilsize - 1;
-            }
-            vce.oscposhiFM[k] = poshiFM;
-            vce.oscposloFM[k] = posloFM/((1<<24)*1.0f);
-        }
-    }
-    // Amplitude interpolation
-    if(ABOVE_AMPLITUDE_THRESHOLD(vce.FMoldamplitude,
-                                 vce.FMnewamplitude)) {
-        for(int k = 0; k < vce.unison_size; ++k) {
-            float *tw = tmpwave_unison[k];
-            for(int i = 0; i < synth.buffersize; ++i)
-                tw[i] *= INTERPOLATE_AMPLITUDE(vce.FMoldamplitude,
-                                               vce.FMnewamplitude,
-                                               i,
-                                               synth.buffersize);
-        }
-    } else {
-        for(int k = 0; k < vce.unison_size; ++k) {
-            float *tw = tmpwave_unison[k];
-            for(int i = 0; i < synth.buffersize; ++i)
-                tw[i] *= vce.FMnewamplitude;
+        //carrier
+        int carposhi = poshi + FMmodfreqhi + offset;
+        int carposlo = (int)(poslo + FMmodfreqlo);
+
+        if(carposlo >= (1<<24)) {
+            carposhi++;
+            carposlo &= 0xffffff;//fmod(carposlo, 1.0f);
         }
-    }
+        carposhi &= (oscilsize - 1);
 
+        out[i] = (smps[carposhi] * ((1<<24) - carposlo)
+                  + smps[carposhi + 1] * carposlo)/(1.0f*(1<<24));
 
-    //normalize: makes all sample-rates, oscil_sizes to produce same sound
-    if(FMmode == FMTYPE::FREQ_MOD) { //Frequency modulation
-        const float normalize = synth.oscilsize_f / 262144.0f * 44100.0f
-                          / synth.samplerate_f;
-        for(int k = 0; k < vce.unison_size; ++k) {
-            float *tw    = tmpwave_unison[k];
-            float  fmold = vce.FMoldsmp[k];
-            for(int i = 0; i < synth.buffersize; ++i) {
-                fmold = fmodf(fmold + tw[i] * normalize, synth.oscilsize);
-                tw[i] = fmold;
-            }
-            vce.FMoldsmp[k] = fmold;
+        poslo += freqlo;
+        if(poslo >= (1<<24)) {
+            poslo &= 0xffffff;//fmod(poslo, 1.0f);
+            poshi++;
         }
-    }
-    else {  //Phase or PWM modulation
-        const float normalize = synth.oscilsize_f / 262144.0f;
-        for(int k = 0; k < vce.unison_size; ++k) {
-            float *tw = tmpwave_unison[k];
-            for(int i = 0; i < synth.buffersize; ++i)
-                tw[i] *= normalize;
-        }
-    }
 
-    //do the modulation
-    for(int k = 0; k < vce.unison_size; ++k) {
-        float *smps   = NoteVoicePar[nvoice].OscilSmp;
-        float *tw     = tmpwave_unison[k];
-        int    poshi  = vce.oscposhi[k];
-        int    poslo  = (int)(vce.oscposlo[k] * (1<<24));
-        int    freqhi = vce.oscfreqhi[k];
-        int    freqlo = (int)(vce.oscfreqlo[k] * (1<<24));
-
-        for(int i = 0; i < synth.buffersize; ++i) {
-            int FMmodfreqhi = 0;
-            F2I(tw[i], FMmodfreqhi);
-            float FMmodfreqlo = tw[i]-FMmodfreqhi;//fmod(tw[i] /*+ 0.0000000001f*/, 1.0f);
-            if(FMmodfreqhi < 0)
-                FMmodfreqlo++;
-
-            //carrier
-            int carposhi = poshi + FMmodfreqhi;
-            int carposlo = (int)(poslo + FMmodfreqlo);
-            if (FMmode == FMTYPE::PW_MOD && (k & 1))
-                carposhi += NoteVoicePar[nvoice].phase_offset;
-
-            if(carposlo >= (1<<24)) {
-                carposhi++;
-                carposlo &= 0xffffff;//fmod(carposlo, 1.0f);
-            }
-            carposhi &= (synth.oscilsize - 1);
+        poshi += freqhi;
+        poshi &= oscilsize - 1;
+    }
+    poshi_ = poshi;
+    poslo_ = poslo;
+    fmold  = phase;
+}
 
-            tw[i] = (smps[carposhi] * ((1<<24) - carposlo)
-                    + smps[carposhi + 1] * carposlo)/(1.0f*(1<<24));
+/*
+ * Computes the Oscillator (Phase Modulation or Frequency Modulation)
+ *
+ * A modulator voice (FMVoice) is read from its VoiceOut by every carrier
+ * subvoice, the own modulator oscillator is rendered into tmpwave_unison
+ * first. Each carrier subvoice is then computed in one pass, which turns
+ * the modulator into the carrier phase and overwrites tmpwave_unison.
+ */
+inline void ADnote::ComputeVoiceOscillatorFrequencyModulation(int nvoice,
+                                                              FMTYPE FMmode,
+                                                              int pos,
+                                                              int nsamples)
+{
+    Voice& vce = NoteVoicePar[nvoice];
+    const bool shared = vce.FMVoice >= 0;
+    if(!shared)
+        oscil::linear(tmpwave_unison, vce.FMSmp, synth.oscilsize,
+                      vce.oscposhiFM, vce.oscposloFM,
+                      vce.oscfreqhiFM, vce.oscfreqloFM,
+                      vce.unison_size, nsamples);
+
+    const bool freqmod = FMmode == FMTYPE::FREQ_MOD;
+    const bool interpolate = ABOVE_AMPLITUDE_THRESHOLD(vce.FMoldamplitude,
+                                                       vce.FMnewamplitude);
+    //normalize: makes all sample-rates, oscil_sizes to produce same sound
+    const float normalize = freqmod ? synth.oscilsize_f / 262144.0f * 44100.0f
+                                      / synth.samplerate_f
+                                    : synth.oscilsize_f / 262144.0f;
 
-            poslo += freqlo;
-            if(poslo >= (1<<24)) {
-                poslo &= 0xffffff;//fmod(poslo, 1.0f);
-                poshi++;
-            }
+    for(int k = 0; k < vce.unison_size; ++k) {
+        float *tw = tmpwave_unison[k];
+        const float *mod = shared ? NoteVoicePar[vce.FMVoice].VoiceOut : tw;
+        //PWM: every second subvoice gets the inverted modulator and the
+        //shifted carrier
+        const bool  pwm    = FMmode == FMTYPE::PW_MOD && (k & 1);
+        const float sign   = pwm ? -1.0f : 1.0f;
+        const int   offset = pwm ? vce.phase_offset : 0;
+
+        int   poshi  = vce.oscposhi[k];
+        int   poslo  = (int)(vce.oscposlo[k] * (1<<24));
+        int   freqhi = vce.oscfreqhi[k];
+        int   freqlo = (int)(vce.oscfreqlo[k] * (1<<24));
+        float fmold  = freqmod ? vce.FMoldsmp[k] : 0.0f;
+
+        if(freqmod && interpolate)
+            modulatedCarrier<true, true>(tw, mod, sign, vce.FMoldamplitude,
+                    vce.FMnewamplitude, normalize, fmold, vce.OscilSmp,
+                    synth.oscilsize, poshi, poslo, freqhi, freqlo, offset,
+                    pos, nsamples, synth.buffersize);
+        else if(freqmod)
+            modulatedCarrier<true, false>(tw, mod, sign, vce.FMoldamplitude,
+                    vce.FMnewamplitude, normalize, fmold, vce.OscilSmp,
+                    synth.oscilsize, poshi, poslo, freqhi, freqlo, offset,
+                    pos, nsamples, synth.buffersize);
+        else if(interpolate)
+            modulatedCarrier<false, true>(tw, mod, sign, vce.FMoldamplitude,
+                    vce.FMnewamplitude, normalize, fmold, vce.OscilSmp,
+                    synth.oscilsize, poshi, poslo, freqhi, freqlo, offset,
+                    pos, nsamples, synth.buffersize);
+        else
+            modulatedCarrier<false, false>(tw, mod, sign, vce.FMoldamplitude,
+                    vce.FMnewamplitude, normalize, fmold, vce.OscilSmp,
+                    synth.oscilsize, poshi, poslo, freqhi, freqlo, offset,
+                    pos, nsamples, synth.buffersize);
 
-            poshi += freqhi;
-            poshi &= synth.oscilsize - 1;
-        }
         vce.oscposhi[k] = poshi;
         vce.oscposlo[k] = (poslo)/((1<<24)*1.0f);
+        if(freqmod)
+            vce.FMoldsmp[k] = fmold;
     }
 }
 
@@ -1589,23 +1582,21 @@ inline void ADnote::ComputeVoiceOscillatorFrequencyModulation(int nvoice,
 /*
  * Computes the Noise
  */
-inline void ADnote::ComputeVoiceWhiteNoise(int nvoice)
+inline void ADnote::ComputeVoiceWhiteNoise(int nvoice, int nsamples)
 {
-    for(int k = 0; k < NoteVoicePar[nvoice].unison_size; ++k) {
-        float *tw = tmpwave_unison[k];
-        for(int i = 0; i < synth.buffersize; ++i)
-            tw[i] = RND * 2.0f - 1.0f;
-    }
+    for(int k = 0; k < NoteVoicePar[nvoice].unison_size; ++k)
+        rng.fill(tmpwave_unison[k], nsamples, -1.0f, 1.0f);
 }
 
-inline void ADnote::ComputeVoicePinkNoise(int nvoice)
+inline void ADnote::ComputeVoicePinkNoise(int nvoice, int nsamples)
 {
     Voice& vce = NoteVoicePar[nvoice];
     for(int k = 0; k < vce.unison_size; ++k) {
         float *tw = tmpwave_unison[k];
         float *f = &vce.pinking[k > 0 ? 7 : 0];
-        for(int i = 0; i < synth.buffersize; ++i) {
-            float white = (RND-0.5f)/4.0f;
+        rng.fill(tw, nsamples, -0.125f, 0.125f);
+        for(int i = 0; i < nsamples; ++i) {
+            float white = tw[i];
             f[0] = 0.99886f*f[0]+white*0.0555179f;
             f[1] = 0.99332f*f[1]+white*0.0750759f;
             f[2] = 0.96900f*f[2]+white*0.1538520f;
@@ -1618,11 +1609,11 @@ inline void ADnote::ComputeVoicePinkNoise(int nvoice)
     }
 }
 
-inline void ADnote::ComputeVoiceDC(int nvoice)
+inline void ADnote::ComputeVoiceDC(int nvoice, int nsamples)
 {
     for(int k = 0; k < NoteVoicePar[nvoice].unison_size; ++k) {
         float *tw = tmpwave_unison[k];
-        for(int i = 0; i < synth.buffersize; ++i)
+        for(int i = 0; i < nsamples; ++i)
             tw[i] = 1.0f;
     }
 }
@@ -1630,19 +1621,39 @@ inline void ADnote::ComputeVoiceDC(int nvoice)
 
 
 /*
- * Compute the ADnote samples
- * Returns 0 if the note is finished
+ * Start the next buffer of the ADnote
  */
-int ADnote::noteout(float *outl, float *outr)
+void ADnote::nextbuffer(int elapsed)
 {
-    memcpy(outl, synth.denormalkillbuf, synth.bufferbytes);
-    memcpy(outr, synth.denormalkillbuf, synth.bufferbytes);
-
-    if(NoteEnabled == OFF)
-        return 0;
-
-    memset(bypassl, 0, synth.bufferbytes);
-    memset(bypassr, 0, synth.bufferbytes);
+    //A release cut the buffer short: the amplitudes carry on from where
+    //the interpolation got to and the fade-outs end here
+    if(elapsed < synth.buffersize) {
+        if(NoteGlobalPar.AmpEnvelope->finished()) {
+            KillNote();
+            return;
+        }
+        for(unsigned nvoice = 0; nvoice < NUM_VOICES; ++nvoice) {
+            Voice& vce = NoteVoicePar[nvoice];
+            if((vce.Enabled != ON) || (vce.DelayTicks > 0))
+                continue;
+            if(retiring(vce)) {
+                KillVoice(nvoice);
+                continue;
+            }
+            vce.newamplitude = INTERPOLATE_AMPLITUDE(vce.oldamplitude,
+                                                     vce.newamplitude,
+                                                     elapsed,
+                                                     synth.buffersize);
+            vce.FMnewamplitude = INTERPOLATE_AMPLITUDE(vce.FMoldamplitude,
+                                                       vce.FMnewamplitude,
+                                                       elapsed,
+                                                       synth.buffersize);
+        }
+        globalnewamplitude = INTERPOLATE_AMPLITUDE(globaloldamplitude,
+                                                   globalnewamplitude,
+                                                   elapsed,
+                                                   synth.buffersize);
+    }
 
     //Update Changed Parameters From UI
     for(unsigned nvoice = 0; nvoice < NUM_VOICES; ++nvoice) {
@@ -1654,6 +1665,19 @@ int ADnote::noteout(float *outl, float *outr)
     }
 
     computecurrentparameters();
+}
+
+/*
+ * Compute the samples [pos, pos+nsamples) of the buffer
+ */
+void ADnote::bufferout(float *outl, float *outr, int pos, int nsamples)
+{
+    const size_t bytes = nsamples * sizeof(float);
+    memcpy(outl, synth.denormalkillbuf + pos, bytes);
+    memcpy(outr, synth.denormalkillbuf + pos, bytes);
+
+    memset(bypassl, 0, bytes);
+    memset(bypassr, 0, bytes);
 
     for(unsigned nvoice = 0; nvoice < NUM_VOICES; ++nvoice) {
         if((NoteVoicePar[nvoice].Enabled != ON)
@@ -1663,40 +1687,42 @@ int ADnote::noteout(float *outl, float *outr)
             case 0: //voice mode=sound
                 switch(NoteVoicePar[nvoice].FMEnabled) {
                     case FMTYPE::MIX:
-                        ComputeVoiceOscillatorMix(nvoice);
+                        ComputeVoiceOscillatorMix(nvoice, pos, nsamples);
                         break;
                     case FMTYPE::RING_MOD:
-                        ComputeVoiceOscillatorRingModulation(nvoice);
+                        ComputeVoiceOscillatorRingModulation(nvoice, pos,
+                                                             nsamples);
                         break;
                     case FMTYPE::FREQ_MOD:
                     case FMTYPE::PHASE_MOD:
                     case FMTYPE::PW_MOD:
                         ComputeVoiceOscillatorFrequencyModulation(nvoice,
-                                                                  NoteVoicePar[nvoice].FMEnabled);
+                                                                  NoteVoicePar[nvoice].FMEnabled,
+                                                                  pos, nsamples);
                         break;
                     default:
-                        if(NoteVoicePar[nvoice].AAEnabled) ComputeVoiceOscillator_SincInterpolation(nvoice);
-                        else ComputeVoiceOscillator_LinearInterpolation(nvoice);
+                        if(NoteVoicePar[nvoice].AAEnabled) ComputeVoiceOscillator_SincInterpolation(nvoice, nsamples);
+                        else ComputeVoiceOscillator_LinearInterpolation(nvoice, nsamples);
                         //if (config.cfg.Interpolation) ComputeVoiceOscillator_CubicInterpolation(nvoice);
                 }
                 break;
             case 1:
-                ComputeVoiceWhiteNoise(nvoice);
+                ComputeVoiceWhiteNoise(nvoice, nsamples);
                 break;
             case 2:
-                ComputeVoicePinkNoise(nvoice);
+                ComputeVoicePinkNoise(nvoice, nsamples);
                 break;
             default:
-                ComputeVoiceDC(nvoice);
+                ComputeVoiceDC(nvoice, nsamples);
                 break;
         }
         // Voice Processing
 
         Voice& vce = NoteVoicePar[nvoice];
         //mix subvoices into voice
-        memset(tmpwavel, 0, synth.bufferbytes);
+        memset(tmpwavel, 0, bytes);
         if(stereo)
-            memset(tmpwaver, 0, synth.bufferbytes);
+            memset(tmpwaver, 0, bytes);
         for(int k = 0; k < vce.unison_size; ++k) {
             float *tw = tmpwave_unison[k];
             if(stereo) {
@@ -1742,16 +1768,16 @@ int ADnote::noteout(float *outl, float *outr)
                     rvol = -rvol;
                 }
 
-                for(int i = 0; i < synth.buffersize; ++i)
+                for(int i = 0; i < nsamples; ++i)
                     tmpwavel[i] += tw[i] * lvol;
-                for(int i = 0; i < synth.buffersize; ++i)
+                for(int i = 0; i < nsamples; ++i)
                     tmpwaver[i] += tw[i] * rvol;
             }
             else
-                for(int i = 0; i < synth.buffersize; ++i)
+                for(int i = 0; i < nsamples; ++i)
                     tmpwavel[i] += tw[i];
             if(nvoice == 0)
-                watch_be4_add(tmpwavel,synth.buffersize);
+                watch_be4_add(tmpwavel, nsamples);
         }
 
         float unison_amplitude = 1.0f / sqrtf(vce.unison_size); //reduce the amplitude for large unison sizes
@@ -1766,64 +1792,65 @@ int ADnote::noteout(float *outl, float *outr)
                 rest = 10;
                 if(rest > synth.buffersize)
                     rest = synth.buffersize;
-                for(int i = 0; i < synth.buffersize - rest; ++i)
-                    tmpwavel[i] *= oldam;
-                if(stereo)
-                    for(int i = 0; i < synth.buffersize - rest; ++i)
-                        tmpwaver[i] *= oldam;
             }
-            // Amplitude interpolation
-            for(int i = 0; i < rest; ++i) {
-                float amp = INTERPOLATE_AMPLITUDE(oldam, newam, i, rest);
-                tmpwavel[i + (synth.buffersize - rest)] *= amp;
+            // Amplitude interpolation over the last rest samples
+            const int start = synth.buffersize - rest;
+            for(int i = 0; i < nsamples; ++i) {
+                float amp = oldam;
+                if(pos + i >= start)
+                    amp = INTERPOLATE_AMPLITUDE(oldam, newam, pos + i - start,
+                                                rest);
+                tmpwavel[i] *= amp;
                 if(stereo)
-                    tmpwaver[i + (synth.buffersize - rest)] *= amp;
+                    tmpwaver[i] *= amp;
             }
         }
         else {
-            for(int i = 0; i < synth.buffersize; ++i)
+            for(int i = 0; i < nsamples; ++i)
                 tmpwavel[i] *= newam;
             if(stereo)
-                for(int i = 0; i < synth.buffersize; ++i)
+                for(int i = 0; i < nsamples; ++i)
                     tmpwaver[i] *= newam;
         }
 
         // Fade in
         if(vce.firsttick != 0) {
-            fadein(&tmpwavel[0]);
+            fadein(&tmpwavel[0], nsamples);
             if(stereo)
-                fadein(&tmpwaver[0]);
+                fadein(&tmpwaver[0], nsamples);
             vce.firsttick = 0;
         }
 
         // Filter
         if(NoteVoicePar[nvoice].Filter) {
             if(stereo)
-                NoteVoicePar[nvoice].Filter->filter(tmpwavel, tmpwaver);
+                NoteVoicePar[nvoice].Filter->filter(tmpwavel, tmpwaver,
+                                                    nsamples);
             else
-                NoteVoicePar[nvoice].Filter->filter(tmpwavel, 0);
+                NoteVoicePar[nvoice].Filter->filter(tmpwavel, 0, nsamples);
         }
 
-        //check if the amplitude envelope is finished, if yes, the voice will be fadeout
-        if(NoteVoicePar[nvoice].AmpEnvelope)
-            if(NoteVoicePar[nvoice].AmpEnvelope->finished()) {
-                for(int i = 0; i < synth.buffersize; ++i)
-                    tmpwavel[i] *= 1.0f - (float)i / synth.buffersize_f;
-                if(stereo)
-                    for(int i = 0; i < synth.buffersize; ++i)
-                        tmpwaver[i] *= 1.0f - (float)i / synth.buffersize_f;
-            }
-        //the voice is killed later
+        //check if the amplitude envelope is finished or the voice can no
+        //longer be heard, if yes, the voice will be fadeout
+        const bool retire = retiring(vce);
+        if(retire) {
+            for(int i = 0; i < nsamples; ++i)
+                tmpwavel[i] *= 1.0f - (float)(pos + i) / synth.buffersize_f;
+            if(stereo)
+                for(int i = 0; i < nsamples; ++i)
+                    tmpwaver[i] *= 1.0f - (float)(pos + i) / synth.buffersize_f;
+        }
+        //the voice is killed at the end of the buffer
 
 
         // Put the ADnote samples in VoiceOut (without applying Global volume, because I wish to use this voice as a modullator)
         if(NoteVoicePar[nvoice].VoiceOut) {
             if(stereo)
-                for(int i = 0; i < synth.buffersize; ++i)
+                for(int i = 0; i < nsamples; ++i)
                     NoteVoicePar[nvoice].VoiceOut[i] = tmpwavel[i]
                                                        + tmpwaver[i];
             else   //mono
-                for(int i = 0; i < synth.buffersize; ++i)
+                for(int i = 0; i < nsamples; ++i)
                     NoteVoicePar[nvoice].VoiceOut[i] = tmpwavel[i];
         }
 
@@ -1831,19 +1858,19 @@ int ADnote::noteout(float *outl, float *outr)
         // Add the voice that do not bypass the filter to out
         if(NoteVoicePar[nvoice].filterbypass == 0) { //no bypass
             if(stereo)
-                for(int i = 0; i < synth.buffersize; ++i) { //stereo
+                for(int i = 0; i < nsamples; ++i) { //stereo
                     outl[i] += tmpwavel[i] * NoteVoicePar[nvoice].Volume
                                * NoteVoicePar[nvoice].Panning * 2.0f;
                     outr[i] += tmpwaver[i] * NoteVoicePar[nvoice].Volume
                                * (1.0f - NoteVoicePar[nvoice].Panning) * 2.0f;
                 }
             else
-                for(int i = 0; i < synth.buffersize; ++i) //mono
+                for(int i = 0; i < nsamples; ++i) //mono
                     outl[i] += tmpwavel[i] * NoteVoicePar[nvoice].Volume;
         }
         else {  //bypass the filter
             if(stereo)
-                for(int i = 0; i < synth.buffersize; ++i) { //stereo
+                for(int i = 0; i < nsamples; ++i) { //stereo
                     bypassl[i] += tmpwavel[i] * NoteVoicePar[nvoice].Volume
                                   * NoteVoicePar[nvoice].Panning * 2.0f;
                     bypassr[i] += tmpwaver[i] * NoteVoicePar[nvoice].Volume
@@ -1851,48 +1878,47 @@ int ADnote::noteout(float *outl, float *outr)
                                      - NoteVoicePar[nvoice].Panning) * 2.0f;
                 }
             else
-                for(int i = 0; i < synth.buffersize; ++i) //mono
+                for(int i = 0; i < nsamples; ++i) //mono
                     bypassl[i] += tmpwavel[i] * NoteVoicePar[nvoice].Volume;
         }
         // check if there is necessary to process the voice longer (if the Amplitude envelope isn't finished)
-        if(NoteVoicePar[nvoice].AmpEnvelope)
-            if(NoteVoicePar[nvoice].AmpEnvelope->finished())
-                KillVoice(nvoice);
+        if(retire && pos + nsamples == synth.buffersize)
+            KillVoice(nvoice);
     }
 
     //Processing Global parameters
     if(stereo) {
-        NoteGlobalPar.Filter->filter(outl, outr);
+        NoteGlobalPar.Filter->filter(outl, outr, nsamples);
     } else { //set the right channel=left channel
-        NoteGlobalPar.Filter->filter(outl, 0);
-        memcpy(outr, outl, synth.bufferbytes);
-        memcpy(bypassr, bypassl, synth.bufferbytes);
+        NoteGlobalPar.Filter->filter(outl, 0, nsamples);
+        memcpy(outr, outl, bytes);
+        memcpy(bypassr, bypassl, bytes);
     }
 
-    for(int i = 0; i < synth.buffersize; ++i) {
+    for(int i = 0; i < nsamples; ++i) {
         outl[i] += bypassl[i];
         outr[i] += bypassr[i];
     }
 
     if(ABOVE_AMPLITUDE_THRESHOLD(globaloldamplitude, globalnewamplitude))
         // Amplitude Interpolation
-        for(int i = 0; i < synth.buffersize; ++i) {
+        for(int i = 0; i < nsamples; ++i) {
             float tmpvol = INTERPOLATE_AMPLITUDE(globaloldamplitude,
                                                  globalnewamplitude,
-                                                 i,
+                                                 pos + i,
                                                  synth.buffersize);
             outl[i] *= tmpvol * NoteGlobalPar.Panning;
             outr[i] *= tmpvol * (1.0f - NoteGlobalPar.Panning);
         }
     else
-        for(int i = 0; i < synth.buffersize; ++i) {
+        for(int i = 0; i < nsamples; ++i) {
             outl[i] *= globalnewamplitude * NoteGlobalPar.Panning;
             outr[i] *= globalnewamplitude * (1.0f - NoteGlobalPar.Panning);
         }
 
     //Apply the punch
     if(NoteGlobalPar.Punch.Enabled != 0)
-        for(int i = 0; i < synth.buffersize; ++i) {
+        for(int i = 0; i < nsamples; ++i) {
             float punchamp = NoteGlobalPar.Punch.initialvalue
                              * NoteGlobalPar.Punch.t + 1.0f;
             outl[i] *= punchamp;
@@ -1904,28 +1930,27 @@ int ADnote::noteout(float *outl, float *outr)
             }
         }
 
-    watch_punch(outl, synth.buffersize);
-    watch_after_add(outl,synth.buffersize);
+    watch_punch(outl, nsamples);
+    watch_after_add(outl, nsamples);
 
     // Apply legato-specific sound signal modifications
-    legato.apply(*this, outl, outr);
+    legato.apply(*this, outl, outr, nsamples);
 
-    watch_legato(outl, synth.buffersize);
+    watch_legato(outl, nsamples);
 
     // Check if the global amplitude is finished.
     // If it does, disable the note
     if(NoteGlobalPar.AmpEnvelope->finished()) {
-        for(int i = 0; i < synth.buffersize; ++i) { //fade-out
-            float tmp = 1.0f - (float)i / synth.buffersize_f;
+        for(int i = 0; i < nsamples; ++i) { //fade-out
+            float tmp = 1.0f - (float)(pos + i) / synth.buffersize_f;
             outl[i] *= tmp;
             outr[i] *= tmp;
         }
-        KillNote();
+        if(pos + nsamples == synth.buffersize)
+            KillNote();
     }
-    return 1;
 }
 
-
 /*
  * Release the key (NoteOff)
  */
@@ -1939,6 +1964,7 @@ void ADnote::releasekey()
     NoteGlobalPar.FreqLfo->releasekey();
     NoteGlobalPar.FilterLfo->releasekey();
     NoteGlobalPar.AmpLfo->releasekey();
+    restartbuffer();
 }
 
 /*
@@ -1955,6 +1981,7 @@ bool ADnote::finished() const
 void ADnote::entomb(void)
 {
     NoteGlobalPar.AmpEnvelope->forceFinish();
+    restartbuffer();
 }
 
 void ADnote::Voice::releasekey()
@@ -2015,18 +2042,19 @@ void ADnote::Global::initparameters(const ADnoteGlobalParam &param,
                                     float basefreq, float velocity,
                                     bool stereo,
                                     WatchManager *wm,
-                                    const char *prefix)
+                                    const char *prefix,
+                                    RngStream &rng)
 {
     ScratchString pre = prefix;
     FreqEnvelope = memory.alloc<Envelope>(*param.FreqEnvelope, basefreq,
             synth.dt(), wm, (pre+"GlobalPar/FreqEnvelope/").c_str);
     FreqLfo      = memory.alloc<LFO>(*param.FreqLfo, basefreq, time, wm,
-                   (pre+"GlobalPar/FreqLfo/").c_str);
+                   (pre+"GlobalPar/FreqLfo/").c_str, rng.next());
 
     AmpEnvelope = memory.alloc<Envelope>(*param.AmpEnvelope, basefreq,
             synth.dt(), wm, (pre+"GlobalPar/AmpEnvelope/").c_str);
     AmpLfo      = memory.alloc<LFO>(*param.AmpLfo, basefreq, time, wm,
-                   (pre+"GlobalPar/AmpLfo/").c_str);
+                   (pre+"GlobalPar/AmpLfo/").c_str, rng.next());
 
     Volume = dB2rap(param.Volume)
              * VelF(velocity, param.PAmpVelocityScaleFunction);     //sensing
@@ -2037,7 +2065,7 @@ void ADnote::Global::initparameters(const ADnoteGlobalParam &param,
     FilterEnvelope = memory.alloc<Envelope>(*param.FilterEnvelope, basefreq,
             synth.dt(), wm, (pre+"GlobalPar/FilterEnvelope/").c_str);
     FilterLfo      = memory.alloc<LFO>(*param.FilterLfo, basefreq, time, wm,
-                   (pre+"GlobalPar/FilterLfo/").c_str);
+                   (pre+"GlobalPar/FilterLfo/").c_str, rng.next());
 
     Filter->addMod(*FilterEnvelope);
     Filter->addMod(*FilterLfo);
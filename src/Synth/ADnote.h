@@ -42,17 +42,25 @@ class ADnote:public SynthNote
         /**Destructor*/
         ~ADnote();
 
+        /**Bytes a note built from pars takes from its NoteArena*/
+        static size_t footprint(const ADnoteParameters &pars,
+                                const SYNTH_T &synth);
+
         /**Alters the playing note for legato effect*/
         void legatonote(const LegatoParams &pars);
 
-        int noteout(float *outl, float *outr);
         void releasekey();
         bool finished() const;
+        float amplitude(void) const {return globalnewamplitude;}
+        float envelopeAmplitude(void) const {return globalenvamplitude;}
         void entomb(void);
 
 
         virtual SynthNote *cloneLegato(void) override;
     private:
+        void nextbuffer(int elapsed) override;
+        void bufferout(float *outl, float *outr,
+                       int pos, int nsamples) override;
 
         void setupVoice(int nvoice);
         int  setupVoiceUnison(int nvoice);
@@ -82,35 +90,42 @@ class ADnote:public SynthNote
         inline float getFMvoicebasefreq(int nvoice) const;
         /**Compute the Oscillator's samples.
          * Affects tmpwave_unison and updates oscposhi/oscposlo*/
-        inline void ComputeVoiceOscillator_LinearInterpolation(int nvoice);
+        inline void ComputeVoiceOscillator_LinearInterpolation(int nvoice,
+                                                               int nsamples);
         /**Compute the Oscillator's samples.
          * Affects tmpwave_unison and updates oscposhi/oscposlo
          * @todo remove this declaration if it is commented out*/
-        inline void ComputeVoiceOscillator_SincInterpolation(int nvoice);
+        inline void ComputeVoiceOscillator_SincInterpolation(int nvoice,
+                                                             int nsamples);
         /**Compute the Oscillator's samples.
          * Affects tmpwave_unison and updates oscposhi/oscposlo
          * @todo remove this declaration if it is commented out*/
         inline void ComputeVoiceOscillator_CubicInterpolation(int nvoice);
         /**Computes the Oscillator samples with mixing.
-         * updates tmpwave_unison*/
-        inline void ComputeVoiceOscillatorMix(int nvoice);
+         * updates tmpwave_unison
+         * @param pos first sample of the buffer (for the interpolation)*/
+        inline void ComputeVoiceOscillatorMix(int nvoice, int pos,
+                                              int nsamples);
         /**Computes the Ring Modulated Oscillator.*/
-        inline void ComputeVoiceOscillatorRingModulation(int nvoice);
+        inline void ComputeVoiceOscillatorRingModulation(int nvoice, int pos,
+                                                         int nsamples);
         /**Computes the Frequency Modulated Oscillator.
          * @param FMmode modulation type 0=Phase 1=Frequency*/
         inline void ComputeVoiceOscillatorFrequencyModulation(int nvoice,
-                                                              FMTYPE FMmode);
+                                                              FMTYPE FMmode,
+                                                              int pos,
+                                                              int nsamples);
         //  inline void ComputeVoiceOscillatorFrequencyModulation(int nvoice);
         /**TODO*/
         inline void ComputeVoiceOscillatorPitchModulation(int nvoice);
 
         /**Generate Noise Samples for Voice*/
-        inline void ComputeVoiceWhiteNoise(int nvoice);
-        inline void ComputeVoicePinkNoise(int nvoice);
-        inline void ComputeVoiceDC(int nvoice);
+        inline void ComputeVoiceWhiteNoise(int nvoice, int nsamples);
+        inline void ComputeVoicePinkNoise(int nvoice, int nsamples);
+        inline void ComputeVoiceDC(int nvoice, int nsamples);
 
         /**Fadein in a way that removes clicks but keep sound "punchy"*/
-        inline void fadein(float *smps) const;
+        inline void fadein(float *smps, int nsamples) const;
 
         //GLOBALS
         ADnoteParameters &pars;
@@ -133,7 +148,8 @@ class ADnote:public SynthNote
                                 float basefreq, float velocity,
                                 bool stereo,
                                 WatchManager *wm,
-                                const char *prefix);
+                                const char *prefix,
+                                RngStream &rng);
             /******************************************
             *     FREQUENCY GLOBAL PARAMETERS        *
             ******************************************/
@@ -295,12 +311,15 @@ class ADnote:public SynthNote
                 float *position; //between -1.0f and 1.0f
             } unison_vibratto;
 
-            //integer part (skip) of the Modullator
-            unsigned int *oscposhiFM, *oscfreqhiFM;
+            //integer part (skip) of the Modullator, int as for the
+            //carrier (see oscil::linear)
+            int *oscposhiFM, *oscfreqhiFM;
 
             //used to compute and interpolate the amplitudes of voices and modullators
             float oldamplitude, newamplitude,
                   FMoldamplitude, FMnewamplitude;
+            //newamplitude without the LFO, see inaudible()
+            float envamplitude;
 
             //used by Frequency Modulation (for integration)
             float *FMoldsmp;
@@ -321,6 +340,13 @@ class ADnote:public SynthNote
 
         //interpolate the amplitudes
         float globaloldamplitude, globalnewamplitude;
+        //volume times amplitude envelope (globalnewamplitude without the LFO)
+        float globalenvamplitude;
+
+        /**True if the voice, released, fell below the audible floor*/
+        bool inaudible(const Voice &vce) const;
+        /**True if the voice fades out over this buffer and is killed*/
+        bool retiring(const Voice &vce) const;
 
         //1 if the note has portamento
         int portamento;
@@ -36,6 +36,8 @@ class Envelope
         /**Determines the status of the Envelope
          * @return returns 1 if the envelope is finished*/
         bool finished(void) const;
+        /**True once releasekey() was called*/
+        bool released(void) const {return keyreleased;}
         void watch(float time, float value);
 
     private:
@@ -22,8 +22,9 @@
 namespace zyn {
 
 LFO::LFO(const LFOParams &lfopars_, float basefreq_, const AbsTime &t, WatchManager *m,
-        const char *watch_prefix)
-    :first_half(-1),
+        const char *watch_prefix, uint32_t seed)
+    :rng(seed),
+    first_half(-1),
     time(t),
     delayTime(t, lfopars_.delay), //0..4 sec
     deterministic(!lfopars_.Pfreqrand),
@@ -36,7 +37,7 @@ LFO::LFO(const LFOParams &lfopars_, float basefreq_, const AbsTime &t, WatchMana
     
     if(!lfopars.Pcontinous) {
         if(!lfopars.Pstartphase)
-            phase = RND;
+            phase = rng.unit();
         else
             phase = 0.0f;
     }
@@ -66,8 +67,8 @@ LFO::LFO(const LFOParams &lfopars_, float basefreq_, const AbsTime &t, WatchMana
     rampUp = 0.0f;
     rampDown = 1.0f;
 
-    amp1     = (1 - lfornd) + lfornd * RND;
-    amp2     = (1 - lfornd) + lfornd * RND;
+    amp1     = (1 - lfornd) + lfornd * rng.unit();
+    amp2     = (1 - lfornd) + lfornd * rng.unit();
     incrnd   = nextincrnd = 1.0f;
     computeNextFreqRnd();
     computeNextFreqRnd(); //twice because I want incrnd & nextincrnd to be random
@@ -129,7 +130,7 @@ float LFO::baseOut(const char waveShape, const float phase)
         case LFO_RANDOM:
             if ((phase < 0.5) != first_half) {
                 first_half = phase < 0.5;
-                last_random = 2*RND-1;
+                last_random = 2*rng.unit()-1;
             }
             return biquad(last_random);
             break;
@@ -284,7 +285,7 @@ float LFO::lfoout()
     if(phase >= 1) {
         phase    = fmod(phase, 1.0f);
         amp1 = amp2;
-        amp2 = (1 - lfornd) + lfornd * RND;
+        amp2 = (1 - lfornd) + lfornd * rng.unit();
 
         computeNextFreqRnd();
     }
@@ -309,7 +310,7 @@ void LFO::computeNextFreqRnd()
     if(deterministic)
         return;
     incrnd     = nextincrnd;
-    nextincrnd = powf(0.5f, lfofreqrnd) + RND * (powf(2.0f, lfofreqrnd) - 1.0f);
+    nextincrnd = powf(0.5f, lfofreqrnd) + rng.unit() * (powf(2.0f, lfofreqrnd) - 1.0f);
 }
 
 }
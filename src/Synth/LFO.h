@@ -16,6 +16,7 @@
 
 #include "../globals.h"
 #include "../Misc/Time.h"
+#include "../Misc/Rng.h"
 #include "WatchPoint.h"
 
 
@@ -30,9 +31,10 @@ class LFO
          *
          * @param lfopars pointer to a LFOParams object
          * @param basefreq base frequency of LFO
+         * @param seed key of the random stream of the LFO
          */
         LFO(const LFOParams &lfopars_, float basefreq_, const AbsTime &t, WatchManager *m=0,
-                const char *watch_prefix=0);
+                const char *watch_prefix=0, uint32_t seed=0);
         ~LFO();
 
         float lfoout();
@@ -63,6 +65,9 @@ class LFO
         //Amplitude Randomness
         float amp1, amp2;
 
+        //Randomness of this LFO, it does not use the global generator
+        RngStream rng;
+
         // RND mode
         int first_half;
         float last_random;
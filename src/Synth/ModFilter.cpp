@@ -56,6 +56,13 @@ ModFilter::~ModFilter(void)
     alloc.dealloc(right);
 }
 
+size_t ModFilter::footprint(const FilterParams &pars, const SYNTH_T &synth,
+                            bool stereo)
+{
+    return NoteArena::footprint<ModFilter>() + (stereo ? 2 : 1)
+        * Filter::footprint(&pars, synth.samplerate, synth.buffersize);
+}
+
 void ModFilter::addMod(LFO &lfo_)
 {
     lfo = &lfo_;
@@ -110,12 +117,12 @@ void ModFilter::updateSense(float velocity, uint8_t scale,
     sense = velScale * 6.0f * (VelF(velocity, func) - 1);
 }
 
-void ModFilter::filter(float *l, float *r)
+void ModFilter::filter(float *l, float *r, int nsamples)
 {
     if(left && l)
-        left->filterout(l);
+        left->filterout(l, nsamples);
     if(right && r)
-        right->filterout(r);
+        right->filterout(r, nsamples);
 }
 
 static int current_category(Filter *f)
@@ -10,6 +10,7 @@
   of the License, or (at your option) any later version.
 */
 #pragma once
+#include <cstddef>
 #include "../globals.h"
 #include "../Misc/Time.h"
 
@@ -28,6 +29,10 @@ class ModFilter
                         float        notefreq_);
         ~ModFilter(void);
 
+        //Bytes a ModFilter (and its filters) takes from a NoteArena
+        static size_t footprint(const FilterParams &pars,
+                                const SYNTH_T &synth, bool stereo);
+
         void addMod(LFO      &lfo);
         void addMod(Envelope &env);
 
@@ -39,8 +44,8 @@ class ModFilter
         void updateSense(float velocity,
                 uint8_t scale, uint8_t func);
 
-        //filter stereo/mono signal(s) in-place
-        void filter(float *l, float *r);
+        //filter nsamples of stereo/mono signal(s) in-place
+        void filter(float *l, float *r, int nsamples);
     private:
         void paramUpdate(Filter *&f);
         void svParamUpdate(SVFilter &sv);
@@ -17,12 +17,14 @@
 #include "../Synth/Resonance.h"
 #include "../Misc/WaveShapeSmps.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <cmath>
 #include <cstdio>
 #include <cstddef>
 #include <complex>
+#include <cstring>
 
 #include <unistd.h>
 
@@ -32,10 +34,37 @@
 namespace zyn {
 
 
+/*
+ * Prepare the spectrum and the band-limited tables of o into new buffers and
+ * hand them to the realtime thread (prepare:bb), which swaps them in and
+ * frees the old ones. The non-realtime ports never touch the buffers in use.
+ */
+static void sendPrepared(OscilGen &o, rtosc::RtData &d)
+{
+    //XXX hack hack
+    char  repath[128];
+    strcpy(repath, d.loc);
+    char *edit   = strrchr(repath, '/')+1;
+    strcpy(edit, "prepare");
+    fft_t *data = new fft_t[o.synth.oscilsize / 2];
+    o.prepare(data);
+    float *mips = o.newmips(data);
+    // fprintf(stderr, "sending '%p' of fft data\n", data);
+    d.chain(repath, "bb", sizeof(fft_t*), &data, sizeof(float*), &mips);
+    o.pendingfreqs = data;
+}
+
 #define rObject OscilGen
 const rtosc::Ports OscilGen::non_realtime_ports = {
     rSelf(OscilGen),
-    rPaste,
+    rPresetType,
+    {"paste:b", rProp(internal) rDoc("paste port"), 0,
+        [](const char *m, rtosc::RtData &d){
+            OscilGen &paste = **(OscilGen **)rtosc_argument(m,0).b.data;
+            OscilGen &o = *(OscilGen*)d.obj;
+            o.paste(paste);
+            sendPrepared(o, d);
+        }},
     //TODO ensure min/max
     rOption(Phmagtype, rShort("scale"),
             rOptions(linear,dB scale (-40),
@@ -111,17 +140,7 @@ const rtosc::Ports OscilGen::non_realtime_ports = {
                 d.reply(d.loc, "i", phase);
             else {
                 phase = rtosc_argument(m,0).i;
-                //XXX hack hack
-                char  repath[128];
-                strcpy(repath, d.loc);
-                char *edit   = strrchr(repath, '/')+1;
-                strcpy(edit, "prepare");
-                OscilGen &o = *((OscilGen*)d.obj);
-                fft_t *data = new fft_t[o.synth.oscilsize / 2];
-                o.prepare(data);
-                // fprintf(stderr, "sending '%p' of fft data\n", data);
-                d.chain(repath, "b", sizeof(fft_t*), &data);
-                o.pendingfreqs = data;
+                sendPrepared(*((OscilGen*)d.obj), d);
                 d.broadcast(d.loc, "i", phase);
             }
         }},
@@ -138,17 +157,7 @@ const rtosc::Ports OscilGen::non_realtime_ports = {
             else {
                 mag = rtosc_argument(m,0).i;
                 //printf("setting magnitude\n\n");
-                //XXX hack hack
-                char  repath[128];
-                strcpy(repath, d.loc);
-                char *edit   = strrchr(repath, '/')+1;
-                strcpy(edit, "prepare");
-                OscilGen &o = *((OscilGen*)d.obj);
-                fft_t *data = new fft_t[o.synth.oscilsize / 2];
-                o.prepare(data);
-                // fprintf(stderr, "sending '%p' of fft data\n", data);
-                d.chain(repath, "b", sizeof(fft_t*), &data);
-                o.pendingfreqs = data;
+                sendPrepared(*((OscilGen*)d.obj), d);
                 d.broadcast(d.loc, "i", mag);
             }
         }},
@@ -175,16 +184,12 @@ const rtosc::Ports OscilGen::non_realtime_ports = {
     {"prepare:", rProp(non-realtime) rDoc("Performs setup operation to oscillator"),
         NULL, [](const char *, rtosc::RtData &d) {
             //fprintf(stderr, "prepare: got a message from '%s'\n", m);
-            OscilGen &o = *(OscilGen*)d.obj;
-            fft_t *data = new fft_t[o.synth.oscilsize / 2];
-            o.prepare(data);
-            // fprintf(stderr, "sending '%p' of fft data\n", data);
-            d.chain(d.loc, "b", sizeof(fft_t*), &data);
-            o.pendingfreqs = data;
+            sendPrepared(*(OscilGen*)d.obj, d);
         }},
     {"convert2sine:", rProp(non-realtime) rDoc("Translates waveform into FS"),
         NULL, [](const char *, rtosc::RtData &d) {
             ((OscilGen*)d.obj)->convert2sine();
+            sendPrepared(*(OscilGen*)d.obj, d);
             //XXX hack hack
             char  repath[128];
             strcpy(repath, d.loc);
@@ -195,6 +200,7 @@ const rtosc::Ports OscilGen::non_realtime_ports = {
     {"use-as-base:", rProp(non-realtime) rDoc("Translates current waveform into base"),
         NULL, [](const char *, rtosc::RtData &d) {
             ((OscilGen*)d.obj)->useasbase();
+            sendPrepared(*(OscilGen*)d.obj, d);
             //XXX hack hack
             char  repath[128];
             strcpy(repath, d.loc);
@@ -247,14 +253,20 @@ const rtosc::Ports OscilGen::realtime_ports{
             d.reply(d.loc, "b", n*sizeof(float), spc);
             delete[] spc;
         }},
-    {"prepare:b", rProp(internal) rProp(realtime) rProp(pointer) rDoc("Sets prepared fft data"),
+    {"prepare:bb", rProp(internal) rProp(realtime) rProp(pointer)
+        rDoc("Sets prepared fft data and its band-limited tables"),
         NULL, [](const char *m, rtosc::RtData &d) {
-            // fprintf(stderr, "prepare:b got a message from '%s'\n", m);
+            // fprintf(stderr, "prepare:bb got a message from '%s'\n", m);
             OscilGen &o = *(OscilGen*)d.obj;
             assert(rtosc_argument(m,0).b.len == sizeof(void*));
+            assert(rtosc_argument(m,1).b.len == sizeof(void*));
             d.reply("/free", "sb", "fft_t", sizeof(void*), &o.oscilFFTfreqs);
             assert(o.oscilFFTfreqs !=*(fft_t**)rtosc_argument(m,0).b.data);
             o.oscilFFTfreqs = *(fft_t**)rtosc_argument(m,0).b.data;
+            if(o.mips)
+                d.reply("/free", "sb", "OscilMips", sizeof(void*), &o.mips);
+            o.mips      = *(float**)rtosc_argument(m,1).b.data;
+            o.mipsvalid = o.mips != NULL;
         }},
 
 };
@@ -357,6 +369,11 @@ OscilGen::OscilGen(const SYNTH_T &synth_, FFTwrapper *fft_, Resonance *res_)
     cachedbasefunc = new float[synth.oscilsize];
     cachedbasevalid = false;
     pendingfreqs     = oscilFFTfreqs;
+    mips      = NULL;
+    mipsvalid = false;
+    nmips     = 1;
+    while(mipharmonics(nmips - 1) < synth.oscilsize / 2 - 2)
+        ++nmips;
 
     randseed = 1;
     ADvsPAD  = false;
@@ -371,6 +388,7 @@ OscilGen::~OscilGen()
     delete[] basefuncFFTfreqs;
     delete[] oscilFFTfreqs;
     delete[] cachedbasefunc;
+    delete[] mips;
 }
 
 
@@ -818,6 +836,89 @@ void OscilGen::shiftharmonics(fft_t *freqs)
 void OscilGen::prepare(void)
 {
     prepare(oscilFFTfreqs);
+
+    //The tables no longer match the spectrum. They are not rebuilt here as
+    //the realtime thread may be reading them, new ones come with prepare:bb
+    mipsvalid = false;
+}
+
+void OscilGen::preparemips(void)
+{
+    if(mipsvalid && !needPrepare())
+        return;
+    prepare(oscilFFTfreqs);
+
+    //PADsynth takes the spectrum, the tables would be unused
+    mipsvalid = false;
+    if(ADvsPAD)
+        return;
+    if(!mips)
+        mips = new float[nmips * synth.oscilsize];
+    buildmips(oscilFFTfreqs, mips);
+    mipsvalid = true;
+}
+
+float *OscilGen::newmips(const fft_t *data)
+{
+    if(ADvsPAD)
+        return NULL;
+    float *tables = new float[nmips * synth.oscilsize];
+    buildmips(data, tables);
+    return tables;
+}
+
+int OscilGen::mipharmonics(int level) const
+{
+    //Every count up to 8, then 4 steps per octave (10, 12, 14, 16, 20, ...)
+    int harmonics = level + 1;
+    if(level >= 8) {
+        const int base = 8 << ((level - 8) / 4);
+        harmonics = base + base * ((level - 8) % 4 + 1) / 4;
+    }
+    return std::min(harmonics, synth.oscilsize / 2 - 2);
+}
+
+/*
+ * The band-limited tables are what get() computes for a note whose nyquist
+ * bucket keeps exactly mipharmonics(level) harmonics. They are built
+ * outside of the realtime thread whenever the spectrum changes, with an own
+ * FFT (plan) as the one of the OscilGen may be in use by the realtime
+ * thread.
+ */
+void OscilGen::buildmips(const fft_t *freqs, float *tables)
+{
+    FFTwrapper ifft(synth.oscilsize);
+    fft_t *spectrum = new fft_t[synth.oscilsize / 2];
+
+    for(int level = 0; level < nmips; ++level) {
+        float *smps = tables + level * synth.oscilsize;
+        clearAll(spectrum, synth.oscilsize);
+        for(int i = 1; i <= mipharmonics(level); ++i)
+            spectrum[i] = freqs[i];
+        rmsNormalize(spectrum, synth.oscilsize);
+        ifft.freqs2smps(spectrum, smps);
+        for(int i = 0; i < synth.oscilsize; ++i)
+            smps[i] *= 0.25f;                     //correct the amplitude
+    }
+
+    delete[] spectrum;
+}
+
+void OscilGen::getmip(float *smps, int harmonics) const
+{
+    const int n = synth.oscilsize;
+    if(harmonics <= 0) {
+        memset(smps, 0, n * sizeof(float));
+        return;
+    }
+
+    //The largest table within the harmonics of the note, a larger one
+    //would alias. Between two tables the note lacks at most the top fifth
+    //of its harmonics.
+    int level = 0;
+    while(level + 1 < nmips && mipharmonics(level + 1) <= harmonics)
+        ++level;
+    memcpy(smps, mips + level * n, n * sizeof(float));
 }
 
 void OscilGen::prepare(fft_t *freqs)
@@ -968,7 +1069,7 @@ void OscilGen::adaptiveharmonicpostprocess(fft_t *f, int size)
     par = 1.0f - powf((1.0f - par), 1.5f);
 
     for(int i = 0; i < size; ++i) {
-        inf[i] = f[i] * double(par);
+        inf[i] = f[i] * fftw_real(par);
         f[i]  *= (1.0f - par);
     }
 
@@ -1039,21 +1140,33 @@ bool OscilGen::needPrepare(void)
     return outdated == true || oscilprepared == false;
 }
 
+//RND drawn from a private generator state
+static float rndFrom(prng_t &state)
+{
+    return (prng_r(state) & 0x7fffffff) / (INT32_MAX_FLOAT * 1.0f);
+}
+
 /*
  * Get the oscillator function
  */
 short int OscilGen::get(float *smps, float freqHz, int resonance)
 {
-    if(needPrepare())
-        prepare();
+    if(needPrepare()) {
+        //The tables are not rebuilt in the realtime thread, this note and
+        //the following ones take the slow path until the next prepare
+        prepare(oscilFFTfreqs);
+        mipsvalid = false;
+    }
 
     fft_t *input = freqHz > 0.0f ? oscilFFTfreqs : pendingfreqs;
 
-    unsigned int realrnd = prng();
-    sprng(randseed);
+    //The randomness of this oscillator repeats for every note with the
+    //same randseed, it is drawn from its own stream and never touches the
+    //global generator
+    prng_t stream = randseed;
 
     int outpos =
-        (int)((RND * 2.0f
+        (int)((rndFrom(stream) * 2.0f
                - 1.0f) * synth.oscilsize_f * (Prand - 64.0f) / 64.0f);
     outpos = (outpos + 2 * synth.oscilsize) % synth.oscilsize;
 
@@ -1066,6 +1179,16 @@ short int OscilGen::get(float *smps, float freqHz, int resonance)
     if(nyquist > synth.oscilsize / 2)
         nyquist = synth.oscilsize / 2;
 
+    //Without per-note randomness of the harmonics, adaptive harmonics and
+    //resonance the wave only depends on the nyquist bucket, so it is read
+    //from the band-limited tables instead of doing an inverse FFT
+    if(mipsvalid && (freqHz > 0.0f) && (!ADvsPAD) && (Prand <= 64)
+       && (Pamprandtype == 0) && (Padaptiveharmonics == 0)
+       && !((resonance != 0) && res && res->Penabled)) {
+        getmip(smps, nyquist - 2);
+        return Prand < 64 ? outpos : 0;
+    }
+
     //Process harmonics
     {
         int realnyquist = nyquist;
@@ -1092,7 +1215,7 @@ short int OscilGen::get(float *smps, float freqHz, int resonance)
         const float rnd = PI * powf((Prand - 64.0f) / 64.0f, 2.0f);
         for(int i = 1; i < nyquist - 1; ++i) //to Nyquist only for AntiAliasing
             outoscilFFTfreqs[i] *=
-                FFTpolar<fftw_real>(1.0f, (float)(rnd * i * RND));
+                FFTpolar<fftw_real>(1.0f, (float)(rnd * i * rndFrom(stream)));
     }
 
     //Harmonic Amplitude Randomness
@@ -1105,12 +1228,12 @@ short int OscilGen::get(float *smps, float freqHz, int resonance)
                 power = power * 2.0f - 0.5f;
                 power = powf(15.0f, power);
                 for(int i = 1; i < nyquist - 1; ++i)
-                    outoscilFFTfreqs[i] *= powf(RND, power) * normalize;
+                    outoscilFFTfreqs[i] *= powf(rndFrom(stream), power) * normalize;
                 break;
             case 2:
                 power = power * 2.0f - 0.5f;
                 power = powf(15.0f, power) * 2.0f;
-                float rndfreq = 2 * PI * RND;
+                float rndfreq = 2 * PI * rndFrom(stream);
                 for(int i = 1; i < nyquist - 1; ++i)
                     outoscilFFTfreqs[i] *= powf(fabsf(sinf(i * rndfreq)), power)
                                            * normalize;
@@ -1132,8 +1255,6 @@ short int OscilGen::get(float *smps, float freqHz, int resonance)
             smps[i] *= 0.25f;                     //correct the amplitude
     }
 
-    sprng(realrnd + 1);
-
     if(Prand < 64)
         return outpos;
     else
@@ -1438,7 +1559,8 @@ void OscilGen::getfromXML(XMLwrapper& xml)
         clearDC(basefuncFFTfreqs);
         normalize(basefuncFFTfreqs, synth.oscilsize);
         cachedbasevalid = false;
-    }}
+    }
+}
 
 
 //Define basic functions
@@ -31,6 +31,14 @@ class OscilGen:public Presets
 
         void prepare(fft_t *data);
 
+        /**prepare() and build the band-limited tables in place, only for an
+         * oscillator which the realtime thread does not use yet*/
+        void preparemips();
+
+        /**band-limited tables of the spectrum data for get() (NULL with
+         * ADvsPAD), to be handed over together with data*/
+        float *newmips(const fft_t *data);
+
         /**do the antialiasing(cut off higher freqs.),apply randomness and do a IFFT*/
         //returns where should I start getting samples, used in block type randomness
         short get(float *smps, float freqHz, int resonance = 0);
@@ -117,6 +125,13 @@ class OscilGen:public Presets
         fft_t *oscilFFTfreqs;
 
         fft_t *pendingfreqs;
+
+        /* Band-limited wavetables of oscilFFTfreqs, for every harmonic count
+         * up to 8 and 4 counts per octave above (10, 12, 14, 16, 20, ...
+         * harmonics and the full spectrum), normalized like the output of
+         * get() */
+        float *mips;
+        bool   mipsvalid;
     private:
         //This array stores some temporary data and it has OSCIL_SIZE elements
         float *tmpsmps;
@@ -160,6 +175,15 @@ class OscilGen:public Presets
         //(that's why the sine and cosine components should be processed with a separate call)
         void adaptiveharmonicpostprocess(fft_t *f, int size);
 
+        //Render the band-limited tables of freqs (nmips * oscilsize samples)
+        void buildmips(const fft_t *freqs, float *tables);
+        //Harmonics kept in the table of the given level
+        int mipharmonics(int level) const;
+        //Read the wave of the given harmonic count from the tables, the
+        //largest table which does not exceed it
+        void getmip(float *smps, int harmonics) const;
+        int nmips;
+
         //Internal Data
         unsigned char oldbasefunc, oldbasepar, oldhmagtype,
                       oldwaveshapingfunction, oldwaveshaping;
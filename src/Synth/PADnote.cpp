@@ -14,6 +14,7 @@
 #include <cmath>
 #include "PADnote.h"
 #include "ModFilter.h"
+#include "../DSP/PadKernels.h"
 #include "../Misc/Config.h"
 #include "../Misc/Allocator.h"
 #include "../Params/PADnoteParameters.h"
@@ -106,7 +107,7 @@ void PADnote::setup(float velocity_,
 
 
     if(!legato) { //not sure
-        poshi_l = (int)(RND * (size - 1));
+        poshi_l = (int)(rng.unit() * (size - 1));
         if(pars.PStereo)
             poshi_r = (poshi_l + size / 2) % size;
         else
@@ -118,7 +119,7 @@ void PADnote::setup(float velocity_,
     if(pars.PPanning)
         NoteGlobalPar.Panning = pars.PPanning / 128.0f;
     else if(!legato)
-        NoteGlobalPar.Panning = RND;
+        NoteGlobalPar.Panning = rng.unit();
 
     if(!legato) {
         NoteGlobalPar.Fadein_adjustment =
@@ -148,14 +149,14 @@ void PADnote::setup(float velocity_,
                     wm, (pre+"FreqEnvelope/").c_str);
         NoteGlobalPar.FreqLfo      =
             memory.alloc<LFO>(*pars.FreqLfo, basefreq, time,
-                    wm, (pre+"FreqLfo/").c_str);
+                    wm, (pre+"FreqLfo/").c_str, rng.next());
 
         NoteGlobalPar.AmpEnvelope =
             memory.alloc<Envelope>(*pars.AmpEnvelope, basefreq, synth.dt(),
                     wm, (pre+"AmpEnvelope/").c_str);
         NoteGlobalPar.AmpLfo      =
             memory.alloc<LFO>(*pars.AmpLfo, basefreq, time,
-                    wm, (pre+"AmpLfo/").c_str);
+                    wm, (pre+"AmpLfo/").c_str, rng.next());
     }
 
     NoteGlobalPar.Volume = 4.0f
@@ -164,9 +165,9 @@ void PADnote::setup(float velocity_,
 
     if (!legato) {
         NoteGlobalPar.AmpEnvelope->envout_dB(); //discard the first envelope output
-        globaloldamplitude = globalnewamplitude = NoteGlobalPar.Volume
-                                                  * NoteGlobalPar.AmpEnvelope->
-                                                  envout_dB()
+        globalenvamplitude = NoteGlobalPar.Volume
+                             * NoteGlobalPar.AmpEnvelope->envout_dB();
+        globaloldamplitude = globalnewamplitude = globalenvamplitude
                                                   * NoteGlobalPar.AmpLfo->amplfoout();
     }
 
@@ -182,7 +183,7 @@ void PADnote::setup(float velocity_,
         env = memory.alloc<Envelope>(*pars.FilterEnvelope, basefreq,
                 synth.dt(), wm, (pre+"FilterEnvelope/").c_str);
         lfo = memory.alloc<LFO>(*pars.FilterLfo, basefreq, time,
-                wm, (pre+"FilterLfo/").c_str);
+                wm, (pre+"FilterLfo/").c_str, rng.next());
         flt->addMod(*env);
         flt->addMod(*lfo);
     }
@@ -203,8 +204,18 @@ void PADnote::setup(float velocity_,
 SynthNote *PADnote::cloneLegato(void)
 {
     SynthParams sp{memory, ctl, synth, time, velocity,
-                   (bool)portamento, legato.param.note_log2_freq, true, legato.param.seed};
-    return memory.alloc<PADnote>(&pars, sp, interpolation);
+                   (bool)portamento, legato.param.note_log2_freq, true, legato.param.seed,
+                   audiblefloor};
+    return allocNote<PADnote>(&pars, sp, interpolation);
+}
+
+//Mirrors the allocations of setup()
+size_t PADnote::footprint(const PADnoteParameters &pars, const SYNTH_T &synth)
+{
+    return NoteArena::footprint<PADnote>()
+        + 3 * NoteArena::footprint<Envelope>()
+        + 3 * NoteArena::footprint<LFO>()
+        + ModFilter::footprint(*pars.GlobalFilter, synth, true);
 }
 
 void PADnote::legatonote(const LegatoParams &pars)
@@ -229,22 +240,22 @@ PADnote::~PADnote()
 }
 
 
-inline void PADnote::fadein(float *smps)
+inline void PADnote::fadein(float *smps, int nsamples)
 {
     int zerocrossings = 0;
-    for(int i = 1; i < synth.buffersize; ++i)
+    for(int i = 1; i < nsamples; ++i)
         if((smps[i - 1] < 0.0f) && (smps[i] > 0.0f))
             zerocrossings++;                                  //this is only the positive crossings
 
-    float tmp = (synth.buffersize_f - 1.0f) / (zerocrossings + 1) / 3.0f;
+    float tmp = (nsamples - 1.0f) / (zerocrossings + 1) / 3.0f;
     if(tmp < 8.0f)
         tmp = 8.0f;
     tmp *= NoteGlobalPar.Fadein_adjustment;
 
     int n;
     F2I(tmp, n); //how many samples is the fade-in
-    if(n > synth.buffersize)
-        n = synth.buffersize;
+    if(n > nsamples)
+        n = nsamples;
     for(int i = 0; i < n; ++i) { //fade-in
         float tmp = 0.5f - cosf((float)i / (float) n * PI) * 0.5f;
         smps[i] *= tmp;
@@ -259,8 +270,9 @@ void PADnote::computecurrentparameters()
                            + NoteGlobalPar.FreqLfo->lfoout()
                            * ctl.modwheel.relmod + NoteGlobalPar.Detune);
     globaloldamplitude = globalnewamplitude;
-    globalnewamplitude = NoteGlobalPar.Volume
-                         * NoteGlobalPar.AmpEnvelope->envout_dB()
+    globalenvamplitude = NoteGlobalPar.Volume
+                         * NoteGlobalPar.AmpEnvelope->envout_dB();
+    globalnewamplitude = globalenvamplitude
                          * NoteGlobalPar.AmpLfo->amplfoout();
 
     NoteGlobalPar.GlobalFilter->update(relfreq, ctl.filterq.relq);
@@ -282,93 +294,72 @@ void PADnote::computecurrentparameters()
 int PADnote::Compute_Linear(float *outl,
                             float *outr,
                             int freqhi,
-                            float freqlo)
+                            float freqlo,
+                            int nsamples)
 {
-    const float *smps = pars.sample[nsample].smp;
-    if(smps == NULL) {
+    const PADnoteParameters::Sample &smp = pars.sample[nsample];
+    if(smp.smp == NULL) {
         finished_ = true;
         return 1;
     }
-    int size = pars.sample[nsample].size;
-    for(int i = 0; i < synth.buffersize; ++i) {
-        poshi_l += freqhi;
-        poshi_r += freqhi;
-        poslo   += freqlo;
-        if(poslo >= 1.0f) {
-            poshi_l += 1;
-            poshi_r += 1;
-            poslo   -= 1.0f;
-        }
-        if(poshi_l >= size)
-            poshi_l %= size;
-        if(poshi_r >= size)
-            poshi_r %= size;
-
-        outl[i] = smps[poshi_l] * (1.0f - poslo) + smps[poshi_l + 1] * poslo;
-        outr[i] = smps[poshi_r] * (1.0f - poslo) + smps[poshi_r + 1] * poslo;
-    }
+    if(smp.scale)
+        pad::linear(outl, outr, smp.smp16(), smp.size, smp.scale,
+                    poshi_l, poshi_r, poslo, freqhi, freqlo,
+                    nsamples);
+    else
+        pad::linear(outl, outr, smp.smp, smp.size, 1.0f,
+                    poshi_l, poshi_r, poslo, freqhi, freqlo,
+                    nsamples);
     return 1;
 }
 int PADnote::Compute_Cubic(float *outl,
                            float *outr,
                            int freqhi,
-                           float freqlo)
+                           float freqlo,
+                           int nsamples)
 {
-    float *smps = pars.sample[nsample].smp;
-    if(smps == NULL) {
+    const PADnoteParameters::Sample &smp = pars.sample[nsample];
+    if(smp.smp == NULL) {
         finished_ = true;
         return 1;
     }
-    int   size = pars.sample[nsample].size;
-    float xm1, x0, x1, x2, a, b, c;
-    for(int i = 0; i < synth.buffersize; ++i) {
-        poshi_l += freqhi;
-        poshi_r += freqhi;
-        poslo   += freqlo;
-        if(poslo >= 1.0f) {
-            poshi_l += 1;
-            poshi_r += 1;
-            poslo   -= 1.0f;
-        }
-        if(poshi_l >= size)
-            poshi_l %= size;
-        if(poshi_r >= size)
-            poshi_r %= size;
-
-
-        //left
-        xm1     = smps[poshi_l];
-        x0      = smps[poshi_l + 1];
-        x1      = smps[poshi_l + 2];
-        x2      = smps[poshi_l + 3];
-        a       = (3.0f * (x0 - x1) - xm1 + x2) * 0.5f;
-        b       = 2.0f * x1 + xm1 - (5.0f * x0 + x2) * 0.5f;
-        c       = (x1 - xm1) * 0.5f;
-        outl[i] = (((a * poslo) + b) * poslo + c) * poslo + x0;
-        //right
-        xm1     = smps[poshi_r];
-        x0      = smps[poshi_r + 1];
-        x1      = smps[poshi_r + 2];
-        x2      = smps[poshi_r + 3];
-        a       = (3.0f * (x0 - x1) - xm1 + x2) * 0.5f;
-        b       = 2.0f * x1 + xm1 - (5.0f * x0 + x2) * 0.5f;
-        c       = (x1 - xm1) * 0.5f;
-        outr[i] = (((a * poslo) + b) * poslo + c) * poslo + x0;
-    }
+    if(smp.scale)
+        pad::cubic(outl, outr, smp.smp16(), smp.size, smp.scale,
+                   poshi_l, poshi_r, poslo, freqhi, freqlo,
+                   nsamples);
+    else
+        pad::cubic(outl, outr, smp.smp, smp.size, 1.0f,
+                   poshi_l, poshi_r, poslo, freqhi, freqlo,
+                   nsamples);
     return 1;
 }
 
 
-int PADnote::noteout(float *outl, float *outr)
+void PADnote::nextbuffer(int elapsed)
 {
+    //A release cut the buffer short
+    if(elapsed < synth.buffersize) {
+        if(NoteGlobalPar.AmpEnvelope->finished()) {
+            finished_ = true;
+            return;
+        }
+        globalnewamplitude = INTERPOLATE_AMPLITUDE(globaloldamplitude,
+                                                   globalnewamplitude,
+                                                   elapsed,
+                                                   synth.buffersize);
+    }
     computecurrentparameters();
+}
+
+void PADnote::bufferout(float *outl, float *outr, int pos, int nsamples)
+{
     float *smps = pars.sample[nsample].smp;
     if(smps == NULL) {
-        for(int i = 0; i < synth.buffersize; ++i) {
+        for(int i = 0; i < nsamples; ++i) {
             outl[i] = 0.0f;
             outr[i] = 0.0f;
         }
-        return 1;
+        return;
     }
     float smpfreq = pars.sample[nsample].basefreq;
 
@@ -379,23 +370,23 @@ int PADnote::noteout(float *outl, float *outr)
 
 
     if(interpolation)
-        Compute_Cubic(outl, outr, freqhi, freqlo);
+        Compute_Cubic(outl, outr, freqhi, freqlo, nsamples);
     else
-        Compute_Linear(outl, outr, freqhi, freqlo);
+        Compute_Linear(outl, outr, freqhi, freqlo, nsamples);
 
-    watch_int(outl,synth.buffersize);
+    watch_int(outl, nsamples);
 
     if(firsttime) {
-        fadein(outl);
-        fadein(outr);
+        fadein(outl, nsamples);
+        fadein(outr, nsamples);
         firsttime = false;
     }
 
-    NoteGlobalPar.GlobalFilter->filter(outl, outr);
+    NoteGlobalPar.GlobalFilter->filter(outl, outr, nsamples);
 
     //Apply the punch
     if(NoteGlobalPar.Punch.Enabled != 0)
-        for(int i = 0; i < synth.buffersize; ++i) {
+        for(int i = 0; i < nsamples; ++i) {
             float punchamp = NoteGlobalPar.Punch.initialvalue
                              * NoteGlobalPar.Punch.t + 1.0f;
             outl[i] *= punchamp;
@@ -407,43 +398,42 @@ int PADnote::noteout(float *outl, float *outr)
             }
         }
 
-    watch_punch(outl,synth.buffersize);
+    watch_punch(outl, nsamples);
 
     if(ABOVE_AMPLITUDE_THRESHOLD(globaloldamplitude, globalnewamplitude))
         // Amplitude Interpolation
-        for(int i = 0; i < synth.buffersize; ++i) {
+        for(int i = 0; i < nsamples; ++i) {
             float tmpvol = INTERPOLATE_AMPLITUDE(globaloldamplitude,
                                                  globalnewamplitude,
-                                                 i,
+                                                 pos + i,
                                                  synth.buffersize);
             outl[i] *= tmpvol * NoteGlobalPar.Panning;
             outr[i] *= tmpvol * (1.0f - NoteGlobalPar.Panning);
         }
     else
-        for(int i = 0; i < synth.buffersize; ++i) {
+        for(int i = 0; i < nsamples; ++i) {
             outl[i] *= globalnewamplitude * NoteGlobalPar.Panning;
             outr[i] *= globalnewamplitude * (1.0f - NoteGlobalPar.Panning);
         }
 
-    watch_amp_int(outl,synth.buffersize);
+    watch_amp_int(outl, nsamples);
 
     // Apply legato-specific sound signal modifications
-    legato.apply(*this, outl, outr);
+    legato.apply(*this, outl, outr, nsamples);
 
-    watch_legato(outl,synth.buffersize);
+    watch_legato(outl, nsamples);
 
     // Check if the global amplitude is finished.
     // If it does, disable the note
     if(NoteGlobalPar.AmpEnvelope->finished()) {
-        for(int i = 0; i < synth.buffersize; ++i) { //fade-out
-            float tmp = 1.0f - (float)i / synth.buffersize_f;
+        for(int i = 0; i < nsamples; ++i) { //fade-out
+            float tmp = 1.0f - (float)(pos + i) / synth.buffersize_f;
             outl[i] *= tmp;
             outr[i] *= tmp;
         }
-        finished_ = 1;
+        if(pos + nsamples == synth.buffersize)
+            finished_ = 1;
     }
-
-    return 1;
 }
 
 bool PADnote::finished() const
@@ -454,6 +444,7 @@ bool PADnote::finished() const
 void PADnote::entomb(void)
 {
     NoteGlobalPar.AmpEnvelope->forceFinish();
+    restartbuffer();
 }
 
 void PADnote::releasekey()
@@ -464,6 +455,7 @@ void PADnote::releasekey()
     NoteGlobalPar.FreqLfo->releasekey();
     NoteGlobalPar.FilterLfo->releasekey();
     NoteGlobalPar.AmpLfo->releasekey();
+    restartbuffer();
 }
 
 }
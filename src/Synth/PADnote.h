@@ -28,20 +28,29 @@ class PADnote:public SynthNote
                 const int &interpolation, WatchManager *wm=0, const char *prefix=0);
         ~PADnote();
 
+        /**Bytes a note built from pars takes from its NoteArena*/
+        static size_t footprint(const PADnoteParameters &pars,
+                                const SYNTH_T &synth);
+
         SynthNote *cloneLegato(void);
         void legatonote(const LegatoParams &pars);
 
-        int noteout(float *outl, float *outr);
         bool finished() const;
+        float amplitude(void) const {return globalnewamplitude;}
+        float envelopeAmplitude(void) const {return globalenvamplitude;}
         void entomb(void);
 
         VecWatchPoint watch_int,watch_punch, watch_amp_int, watch_legato;
 
         void releasekey();
     private:
+        void nextbuffer(int elapsed) override;
+        void bufferout(float *outl, float *outr,
+                       int pos, int nsamples) override;
+
         void setup(float velocity, int portamento_,
                    float note_log2_freq, bool legato = false, WatchManager *wm=0, const char *prefix=0);
-        void fadein(float *smps);
+        void fadein(float *smps, int nsamples);
         void computecurrentparameters();
         bool finished_;
         const PADnoteParameters &pars;
@@ -59,11 +68,13 @@ class PADnote:public SynthNote
         int Compute_Linear(float *outl,
                            float *outr,
                            int freqhi,
-                           float freqlo);
+                           float freqlo,
+                           int nsamples);
         int Compute_Cubic(float *outl,
                           float *outr,
                           int freqhi,
-                          float freqlo);
+                          float freqlo,
+                          int nsamples);
 
 
         struct {
@@ -101,6 +112,7 @@ class PADnote:public SynthNote
 
 
         float globaloldamplitude, globalnewamplitude, velocity, realfreq;
+        float globalenvamplitude; //globalnewamplitude without the LFO
         const int& interpolation;
 };
 
@@ -15,6 +15,7 @@
 #include <cstdlib>
 #include <cstdio>
 #include <cassert>
+#include <algorithm>
 #include <iostream>
 #include "../globals.h"
 #include "SUBnote.h"
@@ -107,7 +108,7 @@ void SUBnote::setup(float velocity_,
     if(pars.PPanning != 0)
         panning = pars.PPanning / 127.0f;
     else if (!legato)
-        panning = RND;
+        panning = rng.unit();
 
     if(!legato) { //normal note
         numstages = pars.Pnumstages;
@@ -207,8 +208,29 @@ void SUBnote::setup(float velocity_,
 SynthNote *SUBnote::cloneLegato(void)
 {
     SynthParams sp{memory, ctl, synth, time, velocity,
-                   portamento, legato.param.note_log2_freq, true, legato.param.seed};
-    return memory.alloc<SUBnote>(&pars, sp);
+                   portamento, legato.param.note_log2_freq, true, legato.param.seed,
+                   audiblefloor};
+    return allocNote<SUBnote>(&pars, sp);
+}
+
+//Mirrors the allocations of setup() and initparameters()
+size_t SUBnote::footprint(const SUBnoteParameters &pars, const SYNTH_T &synth)
+{
+    int pos[MAX_SUB_HARMONICS];
+    int harmonics;
+    pars.activeHarmonics(pos, harmonics);
+
+    const bool stereo = pars.Pstereo;
+    const size_t env  = NoteArena::footprint<Envelope>();
+    size_t size = NoteArena::footprint<SUBnote>() + (stereo ? 2 : 1)
+        * NoteArena::footprint<bpfilter>(pars.Pnumstages * harmonics) + env;
+    if(pars.PFreqEnvelopeEnabled)
+        size += env;
+    if(pars.PBandWidthEnvelopeEnabled)
+        size += env;
+    if(pars.PGlobalFilterEnabled)
+        size += env + ModFilter::footprint(*pars.GlobalFilter, synth, stereo);
+    return size;
 }
 
 void SUBnote::legatonote(const LegatoParams &pars)
@@ -298,9 +320,9 @@ void SUBnote::initfilter(bpfilter &filter,
         }
         else {
             float a = 0.1f * mag; //empirically
-            float p = RND * 2.0f * PI;
+            float p = rng.unit() * 2.0f * PI;
             if(start == 1)
-                a *= RND;
+                a *= rng.unit();
             filter.yn1 = a * cosf(p);
             filter.yn2 = a * cosf(p + freq * 2.0f * PI / synth.samplerate_f);
 
@@ -343,13 +365,13 @@ inline void SubFilterB(const float coeff[4], float &src, float work[4])
 
 //This dance is designed to minimize unneeded memory operations which can result
 //in quite a bit of wasted time
-void SUBnote::filter(bpfilter &filter, float *smps)
+void SUBnote::filter(bpfilter &filter, float *smps, int nsamples)
 {
-    assert(synth.buffersize % 8 == 0);
     float coeff[4] = {filter.b0, filter.b2,  -filter.a1, -filter.a2};
     float work[4]  = {filter.xn1, filter.xn2, filter.yn1, filter.yn2};
 
-    for(int i = 0; i < synth.buffersize; i += 8) {
+    int i = 0;
+    for(; i + 8 <= nsamples; i += 8) {
         SubFilterA(coeff, smps[i + 0], work);
         SubFilterB(coeff, smps[i + 1], work);
         SubFilterA(coeff, smps[i + 2], work);
@@ -359,6 +381,18 @@ void SUBnote::filter(bpfilter &filter, float *smps)
         SubFilterA(coeff, smps[i + 6], work);
         SubFilterB(coeff, smps[i + 7], work);
     }
+    for(; i < nsamples; ++i) {
+        if(i % 2)
+            SubFilterB(coeff, smps[i], work);
+        else
+            SubFilterA(coeff, smps[i], work);
+    }
+    //The A and B steps swap the roles of the history slots, so a
+    //remainder of odd length leaves them swapped
+    if(nsamples % 2) {
+        std::swap(work[0], work[1]);
+        std::swap(work[2], work[3]);
+    }
     filter.xn1 = work[0];
     filter.xn2 = work[1];
     filter.yn1 = work[2];
@@ -522,54 +556,72 @@ void SUBnote::chanOutput(float *out, bpfilter *bp, int buffer_size)
     float tmpsmp[buffer_size];
 
     //Initialize Random Input
-    for(int i = 0; i < buffer_size; ++i)
-        tmprnd[i] = RND * 2.0f - 1.0f;
+    rng.fill(tmprnd, buffer_size, -1.0f, 1.0f);
 
     //For each harmonic apply the filter on the random input stream
     //Sum the filter outputs to obtain the output signal
     for(int n = 0; n < numharmonics; ++n) {
         float rolloff = overtone_rolloff[n];
-        memcpy(tmpsmp, tmprnd, synth.bufferbytes);
+        memcpy(tmpsmp, tmprnd, buffer_size * sizeof(float));
 
         for(int nph = 0; nph < numstages; ++nph)
-            filter(bp[nph + n * numstages], tmpsmp);
+            filter(bp[nph + n * numstages], tmpsmp, buffer_size);
 
-        for(int i = 0; i < synth.buffersize; ++i)
+        for(int i = 0; i < buffer_size; ++i)
             out[i] += tmpsmp[i] * rolloff;
     }
 }
 
 /*
- * Note Output
+ * Start the next buffer, the parameters of the first one were computed
+ * with the note
  */
-int SUBnote::noteout(float *outl, float *outr)
+void SUBnote::nextbuffer(int elapsed)
 {
-    memcpy(outl, synth.denormalkillbuf, synth.bufferbytes);
-    memcpy(outr, synth.denormalkillbuf, synth.bufferbytes);
+    if(firsttick)
+        return;
+    //A release cut the buffer short
+    if(elapsed < synth.buffersize) {
+        if(AmpEnvelope->finished()) {
+            KillNote();
+            return;
+        }
+        newamplitude = INTERPOLATE_AMPLITUDE(oldamplitude, newamplitude,
+                                             elapsed, synth.buffersize);
+    }
+    oldamplitude = newamplitude;
+    computecurrentparameters();
+}
 
-    if(!NoteEnabled)
-        return 0;
+/*
+ * Note Output
+ */
+void SUBnote::bufferout(float *outl, float *outr, int pos, int nsamples)
+{
+    const size_t bytes = nsamples * sizeof(float);
+    memcpy(outl, synth.denormalkillbuf + pos, bytes);
+    memcpy(outr, synth.denormalkillbuf + pos, bytes);
 
     if(stereo) {
-        chanOutput(outl, lfilter, synth.buffersize);
-        chanOutput(outr, rfilter, synth.buffersize);
+        chanOutput(outl, lfilter, nsamples);
+        chanOutput(outr, rfilter, nsamples);
 
         if(GlobalFilter)
-            GlobalFilter->filter(outl, outr);
+            GlobalFilter->filter(outl, outr, nsamples);
 
     } else {
-        chanOutput(outl, lfilter, synth.buffersize);
+        chanOutput(outl, lfilter, nsamples);
 
         if(GlobalFilter)
-            GlobalFilter->filter(outl, 0);
+            GlobalFilter->filter(outl, 0, nsamples);
 
-        memcpy(outr, outl, synth.bufferbytes);
+        memcpy(outr, outl, bytes);
     }
-    watch_filter(outl,synth.buffersize);
+    watch_filter(outl, nsamples);
     if(firsttick) {
         int n = 10;
-        if(n > synth.buffersize)
-            n = synth.buffersize;
+        if(n > nsamples)
+            n = nsamples;
         for(int i = 0; i < n; ++i) {
             float ampfadein = 0.5f - 0.5f * cosf(
                 (float) i / (float) n * PI);
@@ -581,36 +633,34 @@ int SUBnote::noteout(float *outl, float *outr)
 
     if(ABOVE_AMPLITUDE_THRESHOLD(oldamplitude, newamplitude))
         // Amplitude interpolation
-        for(int i = 0; i < synth.buffersize; ++i) {
+        for(int i = 0; i < nsamples; ++i) {
             float tmpvol = INTERPOLATE_AMPLITUDE(oldamplitude,
                                                  newamplitude,
-                                                 i,
+                                                 pos + i,
                                                  synth.buffersize);
             outl[i] *= tmpvol * panning;
             outr[i] *= tmpvol * (1.0f - panning);
         }
     else
-        for(int i = 0; i < synth.buffersize; ++i) {
+        for(int i = 0; i < nsamples; ++i) {
             outl[i] *= newamplitude * panning;
             outr[i] *= newamplitude * (1.0f - panning);
         }
-    watch_amp_int(outl,synth.buffersize);
-    oldamplitude = newamplitude;
-    computecurrentparameters();
+    watch_amp_int(outl, nsamples);
 
     // Apply legato-specific sound signal modifications
-    legato.apply(*this, outl, outr);
-    watch_legato(outl,synth.buffersize);
+    legato.apply(*this, outl, outr, nsamples);
+    watch_legato(outl, nsamples);
     // Check if the note needs to be computed more
     if(AmpEnvelope->finished() != 0) {
-        for(int i = 0; i < synth.buffersize; ++i) { //fade-out
-            float tmp = 1.0f - (float)i / synth.buffersize_f;
+        for(int i = 0; i < nsamples; ++i) { //fade-out
+            float tmp = 1.0f - (float)(pos + i) / synth.buffersize_f;
             outl[i] *= tmp;
             outr[i] *= tmp;
         }
-        KillNote();
+        if(pos + nsamples == synth.buffersize)
+            KillNote();
     }
-    return 1;
 }
 
 /*
@@ -625,6 +675,7 @@ void SUBnote::releasekey()
         BandWidthEnvelope->releasekey();
     if(GlobalFilterEnvelope)
         GlobalFilterEnvelope->releasekey();
+    restartbuffer();
 }
 
 /*
@@ -638,6 +689,7 @@ bool SUBnote::finished() const
 void SUBnote::entomb(void)
 {
     AmpEnvelope->forceFinish();
+    restartbuffer();
 }
 
 }
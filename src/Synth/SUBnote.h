@@ -27,12 +27,17 @@ class SUBnote:public SynthNote
                 WatchManager *wm = 0, const char *prefix = 0);
         ~SUBnote();
 
+        /**Bytes a note built from pars takes from its NoteArena*/
+        static size_t footprint(const SUBnoteParameters &pars,
+                                const SYNTH_T &synth);
+
         SynthNote *cloneLegato(void);
         void legatonote(const LegatoParams &pars);
         VecWatchPoint watch_filter,watch_amp_int, watch_legato;
-        int noteout(float *outl, float *outr); //note output,return 0 if the note is finished
         void releasekey();
         bool finished() const;
+        float amplitude(void) const {return newamplitude;}
+        float envelopeAmplitude(void) const {return newamplitude;}
         void entomb(void);
     private:
 
@@ -80,6 +85,10 @@ class SUBnote:public SynthNote
             float xn1, xn2, yn1, yn2; //filter internal values
         };
 
+        void nextbuffer(int elapsed) override;
+        void bufferout(float *outl, float *outr,
+                       int pos, int nsamples) override;
+
         void chanOutput(float *out, bpfilter *bp, int buffer_size);
 
         void initfilter(bpfilter &filter,
@@ -94,7 +103,7 @@ class SUBnote:public SynthNote
                                 float freq,
                                 float bw,
                                 float gain);
-        inline void filter(bpfilter &filter, float *smps);
+        inline void filter(bpfilter &filter, float *smps, int nsamples);
 
         bpfilter *lfilter, *rfilter;
 
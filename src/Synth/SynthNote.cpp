@@ -14,6 +14,7 @@
 #include "../Misc/Util.h"
 #include "../globals.h"
 #include <cstring>
+#include <algorithm>
 #include <new>
 #include <iostream>
 
@@ -22,9 +23,34 @@ namespace zyn {
 SynthNote::SynthNote(const SynthParams &pars)
     :memory(pars.memory),
     legato(pars.synth, pars.velocity, pars.portamento,
-            pars.note_log2_freq, pars.quiet, pars.seed), ctl(pars.ctl), synth(pars.synth), time(pars.time)
+            pars.note_log2_freq, pars.quiet, pars.seed),
+    rng(pars.seed), audiblefloor(pars.audiblefloor), ctl(pars.ctl), synth(pars.synth), time(pars.time),
+    bufferpos(pars.synth.buffersize), restart(false)
 {}
 
+int SynthNote::noteout(float *outl, float *outr, int nsamples)
+{
+    int done = 0;
+    while(done < nsamples) {
+        if(bufferpos == synth.buffersize || restart) {
+            if(!finished())
+                nextbuffer(bufferpos);
+            bufferpos = 0;
+            restart   = false;
+        }
+        if(finished()) {
+            memset(outl + done, 0, (nsamples - done) * sizeof(float));
+            memset(outr + done, 0, (nsamples - done) * sizeof(float));
+            return 0;
+        }
+        const int n = std::min(nsamples - done, synth.buffersize - bufferpos);
+        bufferout(outl + done, outr + done, bufferpos, n);
+        bufferpos += n;
+        done      += n;
+    }
+    return 1;
+}
+
 SynthNote::Legato::Legato(const SYNTH_T &synth_, float vel, int port,
                           float note_log2_freq, bool quiet, prng_t seed)
     :synth(synth_)
@@ -70,12 +96,13 @@ int SynthNote::Legato::update(const LegatoParams &pars)
     return 0;
 }
 
-void SynthNote::Legato::apply(SynthNote &note, float *outl, float *outr)
+void SynthNote::Legato::apply(SynthNote &note, float *outl, float *outr,
+                              int nsamples)
 {
     if(silent) // Silencer
         if(msg != LM_FadeIn) {
-            memset(outl, 0, synth.bufferbytes);
-            memset(outr, 0, synth.bufferbytes);
+            memset(outl, 0, nsamples * sizeof(float));
+            memset(outr, 0, nsamples * sizeof(float));
         }
     try {
         switch (msg) {
@@ -83,7 +110,7 @@ void SynthNote::Legato::apply(SynthNote &note, float *outl, float *outr)
                 if (decounter == -10)
                     decounter = fade.length;
                 //Yea, could be done without the loop...
-                for (int i = 0; i < synth.buffersize; ++i) {
+                for (int i = 0; i < nsamples; ++i) {
                     decounter--;
                     if (decounter < 1) {
                         // Catching-up done, we can finally set
@@ -101,7 +128,7 @@ void SynthNote::Legato::apply(SynthNote &note, float *outl, float *outr)
                 if (decounter == -10)
                     decounter = fade.length;
                 silent = false;
-                for (int i = 0; i < synth.buffersize; ++i) {
+                for (int i = 0; i < nsamples; ++i) {
                     decounter--;
                     if (decounter < 1) {
                         decounter = -10;
@@ -116,10 +143,10 @@ void SynthNote::Legato::apply(SynthNote &note, float *outl, float *outr)
             case LM_FadeOut: // Fade-out, then set the catch-up
                 if (decounter == -10)
                     decounter = fade.length;
-                for (int i = 0; i < synth.buffersize; ++i) {
+                for (int i = 0; i < nsamples; ++i) {
                     decounter--;
                     if (decounter < 1) {
-                        for (int j = i; j < synth.buffersize; ++j) {
+                        for (int j = i; j < nsamples; ++j) {
                             outl[j] = 0.0f;
                             outr[j] = 0.0f;
                         }
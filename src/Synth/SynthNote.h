@@ -14,11 +14,12 @@
 #define SYNTH_NOTE_H
 #include "../globals.h"
 #include "../Misc/Util.h"
+#include "../Misc/Allocator.h"
+#include "../Misc/Rng.h"
 #include "../Containers/NotePool.h"
 
 namespace zyn {
 
-class Allocator;
 class Controller;
 struct SynthParams
 {
@@ -31,6 +32,7 @@ struct SynthParams
     float     note_log2_freq; //Floating point value of the note
     bool      quiet;     //Initial output condition for legato notes
     prng_t    seed;      //Random seed
+    float     audiblefloor; //Released voices quieter than this are retired, 0 = never
 };
 
 struct LegatoParams
@@ -48,9 +50,20 @@ class SynthNote
         SynthNote(const SynthParams &pars);
         virtual ~SynthNote() {}
 
-        /**Compute Output Samples
+        /**Compute nsamples Output Samples
+         *
+         * The control parameters (envelopes, LFOs, ...) advance every
+         * synth.buffersize samples of the note, whatever the lengths of the
+         * calls. A release starts a new buffer right away.
          * @return 0 if note is finished*/
-        virtual int noteout(float *outl, float *outr) = 0;
+        int noteout(float *outl, float *outr, int nsamples);
+
+        /**Compute synth.buffersize Output Samples
+         * @return 0 if note is finished*/
+        int noteout(float *outl, float *outr)
+        {
+            return noteout(outl, outr, synth.buffersize);
+        }
 
         //TODO fix this spelling error [noisey commit]
         /**Release the key for the note and start release portion of envelopes.*/
@@ -67,6 +80,14 @@ class SynthNote
 
         virtual SynthNote *cloneLegato(void) = 0;
 
+        /**Current amplitude (volume, envelope and LFO) of the note*/
+        virtual float amplitude(void) const = 0;
+
+        /**Volume times amplitude envelope of the note, the level compared
+         * to the audible floor (LFOs are left out, a deep tremolo would
+         * retire the note at its first trough)*/
+        virtual float envelopeAmplitude(void) const = 0;
+
         /* For polyphonic aftertouch needed */
         void setVelocity(float velocity_);
 
@@ -84,6 +105,19 @@ class SynthNote
         //Realtime Safe Memory Allocator For notes
         class Allocator  &memory;
     protected:
+        /**Update the control parameters for the next buffer
+         * @param elapsed samples output of the previous buffer, less than
+         *        synth.buffersize if it was cut short by a release*/
+        virtual void nextbuffer(int elapsed) = 0;
+
+        /**Compute the samples [pos, pos+nsamples) of the current buffer*/
+        virtual void bufferout(float *outl, float *outr,
+                               int pos, int nsamples) = 0;
+
+        /**Start the next buffer at the next output sample, for the
+         * changes of releasekey() and entomb()*/
+        void restartbuffer(void) {restart = true; }
+
         // Legato transitions
         class Legato
         {
@@ -91,7 +125,8 @@ class SynthNote
                 Legato(const SYNTH_T &synth_, float vel, int port,
                        float note_log2_freq, bool quiet, prng_t seed);
 
-                void apply(SynthNote &note, float *outl, float *outr);
+                void apply(SynthNote &note, float *outl, float *outr,
+                           int nsamples);
                 int update(const LegatoParams &pars);
 
             private:
@@ -124,13 +159,45 @@ class SynthNote
 
         prng_t initial_seed;
         prng_t current_prng_state;
+        //Randomness of the note (noise, unison, oscillator seeds, LFOs),
+        //keyed by the seed, so it never touches the global generator
+        RngStream rng;
+        float audiblefloor; //see SynthParams
         const Controller &ctl;
         const SYNTH_T    &synth;
         const AbsTime    &time;
         WatchManager     *wm;
         smooth_float     filtercutoff_relfreq;
+    private:
+        int  bufferpos; //samples output of the current buffer
+        bool restart;   //see restartbuffer()
 };
 
+/**
+ * Build a note of type T in its own NoteArena, sized by T::footprint()
+ * The note and its subcomponents allocate from the arena, which returns its
+ * block when the note is deallocated.
+ * @throw std::bad_alloc if no memory could be allocated
+ */
+template <typename T, typename P, typename... Ts>
+T *allocNote(P *pars, const SynthParams &spars, Ts&&... ts)
+{
+    NoteArena *arena = NoteArena::create(spars.memory,
+                                         T::footprint(*pars, spars.synth));
+    if(!arena)
+        throw std::bad_alloc();
+
+    SynthParams sp{*arena, spars.ctl, spars.synth, spars.time,
+                   spars.velocity, spars.portamento, spars.note_log2_freq,
+                   spars.quiet, spars.seed, spars.audiblefloor};
+    try {
+        return arena->alloc<T>(pars, sp, std::forward<Ts>(ts)...);
+    } catch(std::bad_alloc &) {
+        arena->discard();
+        throw;
+    }
+}
+
 }
 
 #endif
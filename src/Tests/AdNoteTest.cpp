@@ -16,10 +16,13 @@
 #include <fstream>
 #include <ctime>
 #include <string>
+#include <algorithm>
+#include <cmath>
 #include "../Misc/Master.h"
 #include "../Misc/Util.h"
 #include "../Misc/Allocator.h"
 #include "../Synth/ADnote.h"
+#include "../Synth/OscilGen.h"
 #include "../Params/Presets.h"
 #include "../DSP/FFTwrapper.h"
 #include "../Synth/LFO.h"
@@ -133,6 +136,14 @@ class AdNoteTest
             //verify xml was loaded
             TS_ASSERT(defaultPreset->VoicePar[1].Enabled);
 
+            //only the oscillators played by the enabled voices get their
+            //tables, voice 1 plays the oscillator of voice 0
+            TS_ASSERT(defaultPreset->VoicePar[0].OscilGn->mipsvalid);
+            TS_ASSERT(defaultPreset->VoicePar[0].FmGn->mipsvalid);
+            TS_ASSERT(!defaultPreset->VoicePar[1].OscilGn->mipsvalid);
+            TS_ASSERT(!defaultPreset->VoicePar[4].Enabled);
+            TS_ASSERT(!defaultPreset->VoicePar[4].OscilGn->mipsvalid);
+
 
 
             controller = new Controller(*synth, time);
@@ -171,29 +182,29 @@ class AdNoteTest
 
 #endif
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], 0.25552f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], 0.43345f, 0.0001f);
             note->releasekey();
 
             TS_ASSERT(!tr->hasNext());
             w->add_watch("noteout/be4_mix");
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], -0.46883f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], -0.10794f, 0.0001f);
             w->tick();
             TS_ASSERT(tr->hasNext());
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
             w->tick();
-            TS_ASSERT_DELTA(outL[255], 0.06695f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], -0.11840f, 0.0001f);
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], 0.11621f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], -0.04344f, 0.0001f);
             w->tick();
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], -0.1169f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], 0.22907f, 0.0001f);
             w->tick();
 
             TS_ASSERT(tr->hasNext());
@@ -231,6 +242,43 @@ class AdNoteTest
 
         }
 
+        //The largest difference of the samples [from, to) of a and b
+        float maxDiff(const float *a, const float *b, int from, int to) {
+            float diff = 0.0f;
+            for(int i = from; i < to; ++i)
+                diff = std::max(diff, fabsf(a[i] - b[i]));
+            return diff;
+        }
+
+        //A buffer rendered in pieces matches the whole buffer, a release
+        //within the buffer takes effect at its sample
+        void testPieces() {
+            const int N = synth->buffersize;
+            SynthParams pars{memory, *controller, *synth, *time, 120, 0,
+                             test_freq_log2, false, 1234};
+            ADnote whole(defaultPreset, pars);
+            ADnote pieces(defaultPreset, pars);
+            float wl[N], wr[N], pl[N], pr[N];
+
+            //the first buffer fades in over the samples of the call
+            whole.noteout(wl, wr);
+            pieces.noteout(pl, pr);
+            for(int i = 0; i < 4; ++i) {
+                whole.noteout(wl, wr);
+                pieces.noteout(pl, pr, 100);
+                pieces.noteout(pl + 100, pr + 100, N - 100);
+                TS_ASSERT(maxDiff(wl, pl, 0, N) < 1e-5f);
+                TS_ASSERT(maxDiff(wr, pr, 0, N) < 1e-5f);
+            }
+
+            whole.noteout(wl, wr);
+            pieces.noteout(pl, pr, 100);
+            pieces.releasekey();
+            pieces.noteout(pl + 100, pr + 100, N - 100);
+            TS_ASSERT(maxDiff(wl, pl, 0, 100) < 1e-5f);
+            TS_ASSERT(maxDiff(wl, pl, 100, N) > 1e-3f);
+        }
+
 #define OUTPUT_PROFILE
 #ifdef OUTPUT_PROFILE
         void testSpeed() {
@@ -254,5 +302,8 @@ int main()
     test.setUp();
     test.testDefaults();
     test.tearDown();
+    test.setUp();
+    test.testPieces();
+    test.tearDown();
     return test_summary();
 }
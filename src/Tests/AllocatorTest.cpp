@@ -105,6 +105,43 @@ class AllocatorTest
             //delete [] bufB;
         }
 
+        void testArena()
+        {
+            Allocator &memory = *memory_;
+            const size_t doubles = NoteArena::footprint<double>(4);
+            const size_t size    = doubles + NoteArena::footprint<char>(3);
+            TS_ASSERT(doubles >= 4*sizeof(double) && size > doubles);
+
+            NoteArena *arena = NoteArena::create(memory, size);
+            TS_NON_NULL(arena);
+            TS_ASSERT_EQUAL_INT((int)size, (int)arena->capacity());
+
+            double *a = arena->valloc<double>(4);
+            char   *b = arena->valloc<char>(3);
+            TS_ASSERT((size_t)((char*)b - (char*)a) == doubles);
+            TS_ASSERT_EQUAL_INT((int)size, (int)arena->used());
+
+            //Does not fit anymore, taken from the parent
+            float *c = arena->valloc<float>(1);
+            TS_NON_NULL(c);
+            TS_ASSERT((char*)c < (char*)arena || (char*)c >= (char*)a + size);
+            TS_ASSERT_EQUAL_INT((int)size, (int)arena->used());
+            arena->devalloc(c);
+
+            //Arenas of arenas come from the parent
+            NoteArena *inner = NoteArena::create(*arena, 16);
+            TS_NON_NULL(inner);
+            inner->discard();
+
+            //The block is returned with the last allocation in it
+            void *block = arena;
+            arena->devalloc(a);
+            arena->devalloc(b);
+            void *again = memory.alloc_mem(64);
+            TS_ASSERT(again == block);
+            memory.dealloc_mem(again);
+        }
+
 };
 
 int main()
@@ -113,5 +150,6 @@ int main()
     RUN_TEST(testBasic);
     RUN_TEST(testTooBig);
     RUN_TEST(testEnlarge);
+    RUN_TEST(testArena);
     return test_summary();
 }
@@ -0,0 +1,113 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  DenormalBench.cpp - Effect CPU load on decaying tails per denormal policy
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "../globals.h"
+#include "../DSP/Denormal.h"
+#include "../Effects/EffectMgr.h"
+#include "../Misc/Allocator.h"
+
+using namespace zyn;
+
+//Half a second of noise, then the tail is measured while it decays
+#define BURST_SEC 0.5f
+#define TAIL_SEC  30.0f
+
+static const char *effectNames[] = {
+    "", "Reverb", "Echo", "Chorus", "Phaser", "Alienwah", "Distortion",
+    "EQ", "DynFilter"
+};
+
+typedef std::chrono::steady_clock bench_clock;
+
+struct TailStats {
+    double burst; //us per buffer while fed with noise
+    double mean;  //us per buffer over the tail
+    double worst; //slowest tail buffer
+};
+
+static TailStats runEffect(SYNTH_T &synth, Allocator &alloc, int type)
+{
+    EffectMgr efx(alloc, synth, true);
+    efx.changeeffect(type);
+    efx.init();
+
+    const int bs = synth.buffersize;
+    float l[bs], r[bs];
+    const int burst = BURST_SEC * synth.samplerate_f / bs;
+    const int tail  = TAIL_SEC * synth.samplerate_f / bs;
+
+    TailStats st = {0.0, 0.0, 0.0};
+    srand(0);
+    for(int b = 0; b < burst + tail; ++b) {
+        for(int i = 0; i < bs; ++i)
+            l[i] = r[i] = b < burst ? rand() / (float)RAND_MAX - 0.5f : 0.0f;
+
+        const auto start = bench_clock::now();
+        efx.out(l, r);
+        const double us = std::chrono::duration<double, std::micro>(
+                bench_clock::now() - start).count();
+
+        if(b < burst)
+            st.burst += us / burst;
+        else {
+            st.mean += us / tail;
+            if(us > st.worst)
+                st.worst = us;
+        }
+    }
+    return st;
+}
+
+int main()
+{
+    SYNTH_T synth;
+    synth.buffersize = 256;
+    synth.samplerate = 48000;
+    AllocatorClass alloc;
+
+    printf("%d samples per buffer, %.1f s noise, %.1f s tail\n",
+           synth.buffersize, BURST_SEC, TAIL_SEC);
+    printf("%-7s %-10s %10s %10s %10s\n", "policy", "effect",
+           "burst us", "tail us", "worst us");
+
+    const denormal::Policy policies[] = {denormal::POLICY_NOISE,
+                                         denormal::POLICY_FLUSH};
+    for(denormal::Policy p:policies) {
+        denormal::setPolicy(p);
+        if(denormal::policy() != p) {
+            printf("%-7s not supported\n", denormal::policyName(p));
+            continue;
+        }
+        synth.alias();
+        denormal::ScopedFlush flush;
+
+        for(int type = 1; type <= 8; ++type) {
+            const TailStats st = runEffect(synth, alloc, type);
+            printf("%-7s %-10s %10.2f %10.2f %10.2f\n",
+                   denormal::policyName(p), effectNames[type],
+                   st.burst, st.mean, st.worst);
+        }
+    }
+
+    //Without any protection, for reference
+    denormal::setPolicy(denormal::POLICY_NOISE);
+    synth.alias(false);
+    for(int type = 1; type <= 8; ++type) {
+        const TailStats st = runEffect(synth, alloc, type);
+        printf("%-7s %-10s %10.2f %10.2f %10.2f\n", "none", effectNames[type],
+               st.burst, st.mean, st.worst);
+    }
+    return 0;
+}
@@ -0,0 +1,170 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  FmBench.cpp - CPU load of ADsynth presets using FM, PM or PWM
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include "../globals.h"
+#include "../Misc/Allocator.h"
+#include "../Misc/Microtonal.h"
+#include "../Misc/Part.h"
+#include "../Misc/Time.h"
+#include "../DSP/FFTwrapper.h"
+#include "../Params/ADnoteParameters.h"
+
+using namespace std;
+using namespace zyn;
+
+//A six note chord is held while the buffers are timed
+#define CHORD_NOTES 6
+#define WARMUP      20
+#define BUFFERS     400
+
+typedef std::chrono::steady_clock bench_clock;
+
+static SYNTH_T     synth;
+static Alloc       alloc;
+static int         compress = 0;
+static int         interp   = 1;
+static Microtonal *microtonal;
+static FFTwrapper *fft;
+static AbsTime    *time_;
+
+//Collects the .xiz files in path and its subdirectories
+static void findPresets(const string &path, vector<string> &files)
+{
+    const size_t n = path.size();
+    if(n > 4 && path.compare(n - 4, 4, ".xiz") == 0) {
+        files.push_back(path);
+        return;
+    }
+
+    DIR *d = opendir(path.c_str());
+    if(!d)
+        return;
+    while(dirent *e = readdir(d))
+        if(e->d_name[0] != '.')
+            findPresets(path + "/" + e->d_name, files);
+    closedir(d);
+}
+
+static bool isModulated(FMTYPE type)
+{
+    return type == FMTYPE::FREQ_MOD || type == FMTYPE::PHASE_MOD
+           || type == FMTYPE::PW_MOD;
+}
+
+//Number of enabled ADsynth voices using FM, PM or PWM
+static int modulatedVoices(const Part &p)
+{
+    int voices = 0;
+    for(int k = 0; k < NUM_KIT_ITEMS; ++k) {
+        const Part::Kit &kit = p.kit[k];
+        if(!kit.Penabled || !kit.Padenabled || !kit.adpars)
+            continue;
+        for(int v = 0; v < NUM_VOICES; ++v) {
+            const ADnoteVoiceParam &vp = kit.adpars->VoicePar[v];
+            voices += vp.Enabled && isModulated(vp.PFMEnabled);
+        }
+    }
+    return voices;
+}
+
+//Voice 0 modulates voice 1 (FM), voice 2 has its own modulator (PM) and
+//four unison subvoices, voice 3 is PWM
+static void builtinPatch(Part &p)
+{
+    ADnoteParameters &ad = *p.kit[0].adpars;
+    ad.VoicePar[1].Enabled    = 1;
+    ad.VoicePar[1].PFMEnabled = FMTYPE::FREQ_MOD;
+    ad.VoicePar[1].PFMVoice   = 0;
+    ad.VoicePar[2].Enabled     = 1;
+    ad.VoicePar[2].PFMEnabled  = FMTYPE::PHASE_MOD;
+    ad.VoicePar[2].Unison_size = 4;
+    ad.VoicePar[3].Enabled    = 1;
+    ad.VoicePar[3].PFMEnabled = FMTYPE::PW_MOD;
+}
+
+//Microseconds per buffer with a chord held
+static double run(Part &p)
+{
+    p.applyparameters();
+    p.initialize_rt();
+    for(int i = 0; i < CHORD_NOTES; ++i)
+        p.NoteOn(48 + 4 * i, 100, 0);
+
+    for(int i = 0; i < WARMUP; ++i)
+        p.ComputePartSmps();
+    const auto start = bench_clock::now();
+    for(int i = 0; i < BUFFERS; ++i)
+        p.ComputePartSmps();
+    const double us = std::chrono::duration<double, std::micro>(
+            bench_clock::now() - start).count() / BUFFERS;
+
+    p.AllNotesOff();
+    p.ComputePartSmps();
+    return us;
+}
+
+int main(int argc, char **argv)
+{
+    synth.buffersize = 256;
+    synth.samplerate = 48000;
+    synth.alias();
+    time_      = new AbsTime(synth);
+    microtonal = new Microtonal(compress);
+    fft        = new FFTwrapper(synth.oscilsize);
+    //for those patches that are just really big
+    alloc.addMemory(malloc(16 * 1024 * 1024), 16 * 1024 * 1024);
+
+    vector<string> files;
+    for(int i = 1; i < argc; ++i)
+        findPresets(argv[i], files);
+    if(argc == 1)
+        findPresets(string(SOURCE_DIR) + "/../../instruments/banks", files);
+
+    printf("%d samples per buffer, %d note chord, us per buffer\n",
+           synth.buffersize, CHORD_NOTES);
+
+    double total = 0.0;
+    int    n     = 0;
+    {
+        Part p(alloc, synth, *time_, compress, interp, microtonal, fft);
+        builtinPatch(p);
+        const double us = run(p);
+        printf("%10.2f  %d voices  (builtin)\n", us, modulatedVoices(p));
+    }
+    for(const string &file:files) {
+        Part p(alloc, synth, *time_, compress, interp, microtonal, fft);
+        if(p.loadXMLinstrument(file.c_str()) < 0)
+            continue;
+        const int voices = modulatedVoices(p);
+        if(!voices)
+            continue;
+        const double us = run(p);
+        printf("%10.2f  %d voices  %s\n", us, voices, file.c_str());
+        total += us;
+        ++n;
+    }
+    if(n)
+        printf("%10.2f  mean of %d FM presets\n", total / n, n);
+    else
+        printf("No FM presets found (pass .xiz files or directories)\n");
+
+    delete fft;
+    delete microtonal;
+    delete time_;
+    FFT_cleanup();
+    return 0;
+}
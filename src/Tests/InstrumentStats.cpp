@@ -11,6 +11,7 @@
 */
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -68,6 +69,7 @@ double toc()
 }
 
 int interp=1;
+int audible_floor=0; //dB, see Part::Paudiblefloor
 void setup() {
     synth = new SYNTH_T;
     synth->buffersize = 256;
@@ -101,6 +103,7 @@ void load()
     double t_on = tic();
     p->applyparameters();
     p->initialize_rt();
+    p->Paudiblefloor = audible_floor;
     double t_off = toc();
     if(mode == MODE_PROFILE)
         printf("%f, ", t_off - t_on);
@@ -134,6 +137,26 @@ void speed()
         printf("%f, %d, ", t_off - t_on, samps*synth->buffersize);
 }
 
+//Release the keys and render the release tails until the part falls silent
+//(at most 20 seconds), the audible floor retires the tails early
+void release()
+{
+    const int max_bufs = 20 * synth->samplerate / synth->buffersize;
+    int bufs = 0;
+
+    double t_on = tic(); // timer before calling func
+    for(int i=40; i<100; ++i)
+        p->NoteOff(i);
+    while(!p->idle() && bufs < max_bufs) {
+        p->ComputePartSmps();
+        ++bufs;
+    }
+    double t_off = toc(); // timer when func returns
+
+    if(mode==MODE_PROFILE)
+        printf("%f, %d, ", t_off - t_on, bufs*synth->buffersize);
+}
+
 void noteOff()
 {
     double t_on = tic(); // timer before calling func
@@ -373,6 +396,12 @@ void usage_stats(void)
 
 int main(int argc, char **argv)
 {
+    //ins-test [--floor dB] file.xiz
+    if(argc > 3 && !strcmp(argv[1], "--floor")) {
+        audible_floor = atoi(argv[2]);
+        argc -= 2;
+        argv += 2;
+    }
     if(argc < 2) {
         fprintf(stderr, "Please supply a xiz file\n");
         return 1;
@@ -386,6 +415,7 @@ int main(int argc, char **argv)
         printf(", ");
         noteOn();
         speed();
+        release();
         noteOff();
         memUsage();
         printf("\n");
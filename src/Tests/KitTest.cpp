@@ -1023,6 +1023,100 @@ class KitTest
             TS_ASSERT_EQUAL_INT(pool.ndesc[3].note, 65);
         }
 
+        //A part is idle only once its notes have finished
+        void testIdle(void)
+        {
+            TS_ASSERT(part->idle());
+            part->ComputePartSmps();
+            TS_ASSERT(part->idle());
+
+            part->NoteOn(64, 127, 0);
+            part->ComputePartSmps();
+            TS_ASSERT(!part->idle());
+
+            part->NoteOff(64);
+            int buffers = 0;
+            while(!part->idle() && buffers < 10 * synth->samplerate / synth->buffersize) {
+                part->ComputePartSmps();
+                buffers++;
+            }
+            TS_ASSERT(part->idle());
+            TS_ASSERT(part->notePool.empty());
+
+            //Idle parts output silence
+            part->ComputePartSmps();
+            bool quiet = true;
+            for(int i = 0; i < synth->buffersize; ++i)
+                quiet &= part->partoutl[i] == 0.0f && part->partoutr[i] == 0.0f;
+            TS_ASSERT(quiet);
+        }
+
+        //Buffers until a released note is gone
+        int releaseTail(void)
+        {
+            part->NoteOn(64, 127, 0);
+            for(int i = 0; i < 10; ++i)
+                part->ComputePartSmps();
+            part->NoteOff(64);
+            int buffers = 0;
+            while(!part->notePool.empty() && buffers < 10 * synth->samplerate / synth->buffersize) {
+                part->ComputePartSmps();
+                buffers++;
+            }
+            return buffers;
+        }
+
+        void testAudibleFloor(void)
+        {
+            const int full = releaseTail();
+            TS_ASSERT(part->notePool.empty());
+
+            //Released notes below the floor are retired early
+            part->Paudiblefloor = -30;
+            const int retired = releaseTail();
+            TS_ASSERT(part->notePool.empty());
+            TS_ASSERT(retired < full);
+
+            //Held notes are never retired
+            part->NoteOn(64, 1, 0);
+            for(int i = 0; i < 100; ++i)
+                part->ComputePartSmps();
+            TS_ASSERT(!part->notePool.empty());
+        }
+
+        void testNoteLookup(void)
+        {
+            auto &pool = part->notePool;
+            part->NoteOn(64, 127, 0);
+            part->NoteOn(65, 127, 0);
+            part->NoteOn(64, 127, 0);
+            part->NoteOn(66, 127, 0);
+
+            int found = 0;
+            for(auto &d:pool.activeDesc(64)) {
+                TS_ASSERT_EQUAL_INT(d.note, 64);
+                found++;
+            }
+            TS_ASSERT_EQUAL_INT(found, 2);
+
+            //Killing a note in the middle keeps the others reachable
+            pool.killNote(65);
+            found = 0;
+            for(auto &d:pool.activeDesc(66)) {
+                TS_ASSERT_EQUAL_INT(d.note, 66);
+                TS_ASSERT(d.playing());
+                found++;
+            }
+            TS_ASSERT_EQUAL_INT(found, 1);
+            TS_ASSERT_EQUAL_INT(pool.usedNoteDesc(), 3);
+
+            part->NoteOff(64);
+            for(auto &d:pool.activeDesc(64))
+                TS_ASSERT(d.released());
+            for(auto &d:pool.activeDesc(66))
+                TS_ASSERT(d.playing());
+        }
+
         void tearDown() {
             delete part;
             delete[] outL;
@@ -1049,5 +1143,8 @@ int main()
     RUN_TEST(testSingleKitNoLegatoYesMono);
     RUN_TEST(testKeyLimit);
     RUN_TEST(testVoiceLimit);
+    RUN_TEST(testIdle);
+    RUN_TEST(testAudibleFloor);
+    RUN_TEST(testNoteLookup);
     return test_summary();
 }
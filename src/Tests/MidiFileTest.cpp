@@ -0,0 +1,88 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  MidiFileTest.cpp - Test the standard MIDI file reader
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include "test-suite.h"
+#include <cstring>
+#include "../Misc/MidiFile.h"
+
+using namespace zyn;
+
+//Format 1, 96 ticks per quarter note
+//Track 1: tempo 60 BPM at tick 0, 120 BPM at tick 96
+//Track 2: note on at tick 48, note off (running status) at tick 144,
+//         SysEx and a text event that have to be skipped
+static const uint8_t smf[] = {
+    'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, 2, 0, 96,
+
+    'M', 'T', 'r', 'k', 0, 0, 0, 18,
+    0x00, 0xff, 0x51, 0x03, 0x0f, 0x42, 0x40,
+    0x60, 0xff, 0x51, 0x03, 0x07, 0xa1, 0x20,
+    0x00, 0xff, 0x2f, 0x00,
+
+    'M', 'T', 'r', 'k', 0, 0, 0, 25,
+    0x00, 0xf0, 0x02, 0x7e, 0xf7,
+    0x00, 0xff, 0x01, 0x02, 'h', 'i',
+    0x30, 0x90, 0x40, 0x64,
+    0x60, 0x40, 0x00,
+    0x00, 0xc1, 0x05,
+    0x00, 0xff, 0x2f, 0x00,
+};
+
+class MidiFileTest
+{
+    public:
+        MidiFile midi;
+
+        void setUp() {}
+        void tearDown() {}
+
+        void testParse() {
+            TS_ASSERT_EQUAL_INT(0, midi.parse(smf, sizeof(smf)));
+            const std::vector<MidiFileEvent> &ev = midi.events();
+            TS_ASSERT_EQUAL_INT(3, (int)ev.size());
+            if(ev.size() != 3)
+                return;
+
+            //half a beat at 60 BPM
+            TS_ASSERT_DELTA(0.5, ev[0].time, 1e-9);
+            TS_ASSERT_EQUAL_INT(0x90, ev[0].data[0]);
+            TS_ASSERT_EQUAL_INT(0x40, ev[0].data[1]);
+            TS_ASSERT_EQUAL_INT(100,  ev[0].data[2]);
+
+            //another half beat at 60 BPM and half a beat at 120 BPM
+            TS_ASSERT_DELTA(1.25, ev[1].time, 1e-9);
+            TS_ASSERT_EQUAL_INT(0x90, ev[1].data[0]);
+            TS_ASSERT_EQUAL_INT(0,    ev[1].data[2]);
+            TS_ASSERT_EQUAL_INT(3,    ev[1].size);
+
+            TS_ASSERT_EQUAL_INT(0xc1, ev[2].data[0]);
+            TS_ASSERT_EQUAL_INT(2,    ev[2].size);
+            TS_ASSERT_DELTA(1.25, midi.length(), 1e-9);
+        }
+
+        void testInvalid() {
+            TS_ASSERT(midi.parse(smf, 10) < 0);
+            uint8_t broken[sizeof(smf)];
+            memcpy(broken, smf, sizeof(smf));
+            broken[0] = 'X';
+            TS_ASSERT(midi.parse(broken, sizeof(broken)) < 0);
+            //cut into the last track
+            TS_ASSERT(midi.parse(smf, sizeof(smf) - 4) < 0);
+        }
+};
+
+int main()
+{
+    MidiFileTest test;
+    RUN_TEST(testParse);
+    RUN_TEST(testInvalid);
+    return test_summary();
+}
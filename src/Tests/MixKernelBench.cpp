@@ -0,0 +1,88 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  MixKernelBench.cpp - Micro benchmark of the mixing kernels
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "../DSP/MixKernels.h"
+
+using namespace zyn;
+
+//Simulates the master mix of 16 parts with 4 system effect sends
+#define PARTS   16
+#define SENDS   4
+#define BUFSIZE 256
+#define ROUNDS  20000
+
+static float partl[PARTS][BUFSIZE], partr[PARTS][BUFSIZE];
+static float ramp[BUFSIZE];
+static float sendl[SENDS][BUFSIZE], sendr[SENDS][BUFSIZE];
+static float outl[BUFSIZE], outr[BUFSIZE];
+
+static double run(void)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(int r = 0; r < ROUNDS; ++r) {
+        for(int p = 0; p < PARTS; ++p) {
+            mix::scaleBuf(partl[p], ramp, BUFSIZE);
+            mix::scale(partr[p], 0.999f, BUFSIZE);
+            for(int s = 0; s < SENDS; ++s) {
+                mix::addScaled(sendl[s], partl[p], 0.1f, BUFSIZE);
+                mix::addScaled(sendr[s], partr[p], 0.1f, BUFSIZE);
+            }
+        }
+        for(int s = 0; s < SENDS; ++s) {
+            mix::crossfade(sendl[s], sendr[s], 0.5f, 0.5f, BUFSIZE);
+            mix::addScaled(outl, sendl[s], 0.2f, BUFSIZE);
+            mix::addScaled(outr, sendr[s], 0.2f, BUFSIZE);
+        }
+        for(int p = 0; p < PARTS; ++p) {
+            mix::add(outl, partl[p], BUFSIZE);
+            mix::add(outr, partr[p], BUFSIZE);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+static void fill(void)
+{
+    srand(0);
+    for(int i = 0; i < BUFSIZE; ++i) {
+        ramp[i] = 1.0f - i * 1e-6f;
+        outl[i] = outr[i] = 0.0f;
+        for(int p = 0; p < PARTS; ++p) {
+            partl[p][i] = rand() / (float)RAND_MAX - 0.5f;
+            partr[p][i] = rand() / (float)RAND_MAX - 0.5f;
+        }
+        for(int s = 0; s < SENDS; ++s)
+            sendl[s][i] = sendr[s][i] = 0.0f;
+    }
+}
+
+int main()
+{
+    printf("%d parts, %d sends, %d samples, %d buffers\n",
+           PARTS, SENDS, BUFSIZE, ROUNDS);
+    double scalar = 0.0;
+    for(int i = 0; i < mix::ISA_COUNT; ++i) {
+        mix::Isa isa = (mix::Isa)i;
+        if(!mix::setIsa(isa))
+            continue;
+        fill();
+        const double t = run();
+        if(isa == mix::ISA_SCALAR)
+            scalar = t;
+        printf("%-8s %8.3f ms  %6.2f us/buffer  x%.2f\n", mix::isaName(isa),
+               t * 1e3, t * 1e6 / ROUNDS, scalar / t);
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  MixKernelTest.cpp - Test the vectorized mixing kernels against scalar code
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include "test-suite.h"
+#include <cmath>
+#include <cstdlib>
+#include "../DSP/MixKernels.h"
+
+using namespace zyn;
+
+//Large enough for a few vectors plus every possible tail/offset
+#define LEN 77
+#define PAD 8
+
+class MixKernelTest
+{
+    public:
+        float dst[LEN + PAD], ref[LEN + PAD], src[LEN + PAD], gain[LEN + PAD];
+
+        void setUp() {
+            srand(42);
+            for(int i = 0; i < LEN + PAD; ++i) {
+                dst[i]  = ref[i] = rand() / (float)RAND_MAX - 0.5f;
+                src[i]  = rand() / (float)RAND_MAX - 0.5f;
+                gain[i] = rand() / (float)RAND_MAX;
+            }
+        }
+
+        void tearDown() {
+            mix::setIsa(mix::ISA_SCALAR);
+        }
+
+        //Run one kernel on every offset and length with the scalar
+        //reference and the vector implementation under test
+        template<class F>
+        bool matches(mix::Isa isa, F kernel) {
+            bool ok = true;
+            for(int off = 0; off < PAD; ++off)
+                for(int n = 0; n <= LEN; ++n) {
+                    setUp();
+                    mix::setIsa(mix::ISA_SCALAR);
+                    kernel(ref + off, n);
+                    mix::setIsa(isa);
+                    kernel(dst + off, n);
+                    for(int i = 0; i < LEN + PAD; ++i)
+                        ok &= fabsf(dst[i] - ref[i]) <= 1e-6f;
+                }
+            return ok;
+        }
+
+        void testDispatch() {
+            TS_ASSERT(mix::supported(mix::ISA_SCALAR));
+            TS_ASSERT(!mix::setIsa(mix::ISA_COUNT));
+            for(int i = 0; i < mix::ISA_COUNT; ++i) {
+                mix::Isa isa = (mix::Isa)i;
+                TS_ASSERT_EQUAL_INT(mix::supported(isa), mix::setIsa(isa));
+                if(mix::supported(isa))
+                    TS_ASSERT_EQUAL_INT(isa, mix::isa());
+            }
+        }
+
+        void testKernels() {
+            for(int i = 0; i < mix::ISA_COUNT; ++i) {
+                mix::Isa isa = (mix::Isa)i;
+                if(!mix::supported(isa))
+                    continue;
+                printf("Checking %s kernels\n", mix::isaName(isa));
+                const float *s = src, *g = gain;
+                TS_ASSERT(matches(isa, [s](float *d, int n) {
+                    mix::add(d, s, n);}));
+                TS_ASSERT(matches(isa, [s](float *d, int n) {
+                    mix::addScaled(d, s, 0.3f, n);}));
+                TS_ASSERT(matches(isa, [](float *d, int n) {
+                    mix::scale(d, 0.7f, n);}));
+                TS_ASSERT(matches(isa, [g](float *d, int n) {
+                    mix::scaleBuf(d, g, n);}));
+                TS_ASSERT(matches(isa, [s](float *d, int n) {
+                    mix::crossfade(d, s, 0.25f, 1.5f, n);}));
+            }
+        }
+
+        void testValues() {
+            float a[5] = {1, 2, 3, 4, 5};
+            float b[5] = {1, 1, 1, 1, 1};
+            mix::addScaled(a, b, 2.0f, 5);
+            TS_ASSERT_EQUAL_INT(7, (int)a[4]);
+            mix::crossfade(a, b, 0.5f, 1.0f, 5);
+            TS_ASSERT_EQUAL_INT(2, (int)a[0]);
+            TS_ASSERT_EQUAL_INT(4, (int)a[3]);
+        }
+};
+
+int main()
+{
+    MixKernelTest test;
+    RUN_TEST(testDispatch);
+    RUN_TEST(testKernels);
+    RUN_TEST(testValues);
+    return test_summary();
+}
@@ -12,6 +12,7 @@
 */
 #include "test-suite.h"
 #include <string>
+#include <algorithm>
 #include "../Synth/OscilGen.h"
 #include "../Misc/XMLwrapper.h"
 #include "../DSP/FFTwrapper.h"
@@ -105,6 +106,72 @@ class OscilGenTest
             TS_ASSERT_DELTA(outR[66], 0.001293f, 0.0001f);
         }
 
+        //Frequency at which the per-note path keeps the given harmonics
+        float freqFor(int harmonics) {
+            return synth->samplerate_f * 0.5f / (harmonics + 0.5f);
+        }
+
+        //Get the wave of freq via the per-note path and via the
+        //band-limited tables and compare them
+        bool matchesTables(float f) {
+            //a changed parameter makes get() prepare in place, which
+            //invalidates the tables
+            oscil->Psapar++;
+            oscil->newrandseed(3);
+            const short refpos = oscil->get(outR, f);
+            oscil->preparemips();
+            oscil->newrandseed(3);
+            const short pos = oscil->get(outL, f);
+
+            bool ok = pos == refpos;
+            for(int i = 0; i < synth->oscilsize; ++i)
+                ok &= fabsf(outL[i] - outR[i]) < 1e-5f;
+            return ok;
+        }
+
+        void testMips(void)
+        {
+            oscil->Prand = 40; //block randomness only moves the start
+            TS_ASSERT(matchesTables(20.0f));  //all harmonics
+            TS_ASSERT(matchesTables(342.0f)); //64 harmonics
+            TS_ASSERT(matchesTables(5000.0f)); //4 harmonics
+
+            //Harmonic counts which are not a power of two have their own table
+            TS_ASSERT(matchesTables(freqFor(6)));
+            TS_ASSERT(matchesTables(freqFor(12)));
+            TS_ASSERT(matchesTables(freqFor(40)));
+            TS_ASSERT(matchesTables(freqFor(48)));
+
+            //Between two tables the smaller one is used, so nothing above
+            //the harmonics of the note is played
+            oscil->Psapar++;
+            oscil->newrandseed(3);
+            oscil->get(outR, freqFor(40));
+            oscil->preparemips();
+            oscil->newrandseed(3);
+            oscil->get(outL, freqFor(45));
+            float diff = 0.0f;
+            for(int i = 0; i < synth->oscilsize; ++i)
+                diff = std::max(diff, fabsf(outL[i] - outR[i]));
+            TS_ASSERT_DELTA(diff, 0.0f, 1e-5f);
+
+            //prepare() leaves the tables in use alone, they are replaced
+            //via prepare:bb
+            const float *tables = oscil->mips;
+            oscil->Psapar++;
+            oscil->prepare();
+            TS_ASSERT(!oscil->mipsvalid);
+            TS_ASSERT(oscil->mips == tables);
+
+            //Per-harmonic randomness needs the per-note path
+            oscil->Prand = 127;
+            oscil->newrandseed(3);
+            oscil->get(outL, 342.0f);
+            oscil->newrandseed(4);
+            oscil->get(outR, 342.0f);
+            TS_ASSERT(memcmp(outL, outR, sizeof(float) * synth->oscilsize));
+        }
+
         //performance testing
 #ifdef __linux__
         void testSpeed() {
@@ -135,6 +202,7 @@ int main()
     RUN_TEST(testInit);
     RUN_TEST(testOutput);
     RUN_TEST(testSpectrum);
+    RUN_TEST(testMips);
 #ifdef __linux__
     RUN_TEST(testSpeed);
 #endif
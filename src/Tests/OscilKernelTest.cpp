@@ -0,0 +1,135 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  OscilKernelTest.cpp - Test the vectorized unison oscillators against scalar
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include "test-suite.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "../DSP/OscilKernels.h"
+
+using namespace zyn;
+
+#define OSCILSIZE  256
+#define EXTRA      5
+#define MAXUNISON  21
+#define MAXSMPS    70
+
+class OscilKernelTest
+{
+    public:
+        float smps[OSCILSIZE + EXTRA];
+        int   freqhi[MAXUNISON];
+        float freqlo[MAXUNISON];
+
+        struct State {
+            int   poshi[MAXUNISON];
+            float poslo[MAXUNISON];
+            float buf[MAXUNISON][MAXSMPS];
+            float *out[MAXUNISON];
+        } ref, dst;
+
+        void setUp() {
+            srand(7);
+            for(int i = 0; i < OSCILSIZE; ++i)
+                smps[i] = sinf(i * 2 * M_PI / OSCILSIZE)
+                          + rand() / (float)RAND_MAX - 0.5f;
+            for(int i = 0; i < EXTRA; ++i)
+                smps[OSCILSIZE + i] = smps[i];
+            for(int k = 0; k < MAXUNISON; ++k) {
+                //from deep bass to several samples per step
+                freqhi[k] = rand() % 7;
+                freqlo[k] = rand() / (RAND_MAX + 1.0f);
+                ref.poshi[k] = rand() % OSCILSIZE;
+                ref.poslo[k] = rand() / (RAND_MAX + 1.0f);
+            }
+            reset(ref);
+            dst = ref;
+            reset(dst);
+        }
+
+        void tearDown() {
+            oscil::setIsa(mix::ISA_SCALAR);
+        }
+
+        void reset(State &s) {
+            memset(s.buf, 0, sizeof(s.buf));
+            for(int k = 0; k < MAXUNISON; ++k)
+                s.out[k] = s.buf[k];
+        }
+
+        //Run a few buffers of every unison size and buffer length with the
+        //scalar and the vector code. The phases have to agree exactly, the
+        //samples up to FMA contraction of the scalar code (see
+        //OscilKernels.h)
+        bool matches(mix::Isa isa, bool sinc) {
+            bool ok = true;
+            for(int nunison = 1; nunison <= MAXUNISON; nunison += 2)
+                for(int n = MAXSMPS - 7; n <= MAXSMPS; ++n) {
+                    setUp();
+                    for(int run = 0; run < 3; ++run) {
+                        render(ref, mix::ISA_SCALAR, sinc, nunison, n);
+                        render(dst, isa, sinc, nunison, n);
+                        for(int k = 0; k < MAXUNISON; ++k)
+                            for(int i = 0; i < MAXSMPS; ++i)
+                                ok &= fabsf(ref.buf[k][i] - dst.buf[k][i])
+                                      < 1e-5f;
+                        ok &= !memcmp(ref.poshi, dst.poshi, sizeof(ref.poshi));
+                        ok &= !memcmp(ref.poslo, dst.poslo, sizeof(ref.poslo));
+                    }
+                }
+            return ok;
+        }
+
+        void render(State &s, mix::Isa isa, bool sinc, int nunison, int n) {
+            oscil::setIsa(isa);
+            if(sinc)
+                oscil::sinc(s.out, smps, OSCILSIZE, s.poshi, s.poslo,
+                            freqhi, freqlo, nunison, n);
+            else
+                oscil::linear(s.out, smps, OSCILSIZE, s.poshi, s.poslo,
+                              freqhi, freqlo, nunison, n);
+        }
+
+        void testKernels() {
+            TS_ASSERT(oscil::setIsa(mix::ISA_SCALAR));
+            for(int i = 0; i < mix::ISA_COUNT; ++i) {
+                mix::Isa isa = (mix::Isa)i;
+                if(!oscil::setIsa(isa))
+                    continue;
+                printf("Checking %s oscillators\n", mix::isaName(isa));
+                TS_ASSERT(matches(isa, false));
+                TS_ASSERT(matches(isa, true));
+            }
+        }
+
+        void testValues() {
+            //Half a sample per step interpolates between the samples
+            float buf[4];
+            float *out = buf;
+            int   poshi  = 0, freqhi = 0;
+            float poslo  = 0.0f, freqlo = 0.5f;
+            oscil::linear(&out, smps, OSCILSIZE, &poshi, &poslo,
+                          &freqhi, &freqlo, 1, 4);
+            TS_ASSERT_DELTA(smps[0], buf[0], 1e-6);
+            TS_ASSERT_DELTA((smps[0] + smps[1]) / 2, buf[1], 1e-6);
+            TS_ASSERT_DELTA(smps[1], buf[2], 1e-6);
+            TS_ASSERT_EQUAL_INT(2, poshi);
+            TS_ASSERT_DELTA(0.0f, poslo, 1e-6);
+        }
+};
+
+int main()
+{
+    OscilKernelTest test;
+    RUN_TEST(testKernels);
+    RUN_TEST(testValues);
+    return test_summary();
+}
@@ -0,0 +1,341 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  PadCacheTest.cpp - Test for the on disk cache, the shared storage and
+                     the draft sets of PADsynth samples
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include "test-suite.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#define private public
+#include "../Params/PADnoteParameters.h"
+#undef private
+#include "../Params/PADcache.h"
+#include "../Params/PADstore.h"
+#include "../Misc/Time.h"
+#include "../Misc/WorkPool.h"
+#include "../DSP/FFTwrapper.h"
+#include "../globals.h"
+
+using namespace std;
+using namespace zyn;
+
+SYNTH_T *synth;
+
+//Files of the cache directory
+static vector<string> cacheFiles(void)
+{
+    vector<string> files;
+    const string dir = padcache::directory();
+    DIR *d = opendir(dir.c_str());
+    if(!d)
+        return files;
+    while(struct dirent *fn = readdir(d))
+        if(fn->d_name[0] != '.')
+            files.push_back(dir + "/" + fn->d_name);
+    closedir(d);
+    return files;
+}
+
+class PadCacheTest
+{
+    public:
+        PADnoteParameters *pars;
+        FFTwrapper        *fft;
+        AbsTime           *time;
+        char               dir[64];
+        //Kept for the whole test, as MiddleWare does
+        std::shared_ptr<WorkPool> workers;
+
+        void setUp() {
+            //Keep the cache of the user out of the test
+            strcpy(dir, "/tmp/zyn-padcache-XXXXXX");
+            TS_NON_NULL(mkdtemp(dir));
+            setenv("ZYNADDSUBFX_PADCACHE", dir, 1);
+            padcache::setLimit(256 << 20);
+
+            workers = WorkPool::shared();
+            synth = new SYNTH_T;
+            time  = new AbsTime(*synth);
+            fft   = new FFTwrapper(synth->oscilsize);
+            pars  = create();
+        }
+
+        PADnoteParameters *create(void) {
+            PADnoteParameters *p = new PADnoteParameters(*synth, fft, time);
+            //Small samples to keep the test quick
+            p->Pquality.samplesize = 0;
+            p->Pquality.oct        = 1;
+            return p;
+        }
+
+        //Start over with an instance without samples, which also drops the
+        //samples of the old one from memory
+        void renew(void) {
+            delete pars;
+            pars = create();
+        }
+
+        void tearDown() {
+            delete pars;
+            delete fft;
+            delete time;
+            FFT_cleanup();
+            delete synth;
+
+            for(auto file : cacheFiles())
+                remove(file.c_str());
+            rmdir(dir);
+            padcache::setLimit(0);
+            workers.reset();
+        }
+
+        //Snapshot of the first sample, with its interpolation tail
+        vector<float> first(void) {
+            const auto &s = pars->sample[0];
+            vector<float> values(s.size + 5);
+            for(int i = 0; i < s.size + 5; ++i)
+                values[i] = s.value(i);
+            return values;
+        }
+
+        //Generating a set again gives the same samples, so a cached set is
+        //told apart by a mark in its last float (the last interpolation
+        //sample of the last sample)
+        void mark(const string &file) {
+            const float marker = 1234.0f;
+            FILE *f = fopen(file.c_str(), "r+b");
+            TS_NON_NULL(f);
+            fseek(f, -(long)sizeof(float), SEEK_END);
+            fwrite(&marker, sizeof(float), 1, f);
+            fclose(f);
+        }
+
+        bool marked(void) {
+            const auto &s = pars->sample[pars->sampleCount() - 1];
+            return s.smp[s.size + 4] == 1234.0f;
+        }
+
+        void testHit() {
+            pars->applyparameters();
+            const vector<float> generated = first();
+            const vector<string> files = cacheFiles();
+            TS_ASSERT_EQUAL_INT(1, (int)files.size());
+            TS_ASSERT(!marked());
+
+            mark(files[0]);
+            renew();
+            pars->applyparameters();
+            TS_ASSERT(marked());
+            TS_ASSERT(generated == first());
+            TS_ASSERT_EQUAL_INT(1, (int)cacheFiles().size());
+        }
+
+        void testKey() {
+            const uint64_t key = pars->sampleKey();
+            TS_ASSERT(key == pars->sampleKey());
+
+            pars->Pbandwidth += 10;
+            TS_ASSERT(key != pars->sampleKey());
+            pars->Pbandwidth -= 10;
+
+            //Parameters of the playback are not part of the key
+            pars->PVolume += 10;
+            TS_ASSERT(key == pars->sampleKey());
+        }
+
+        void testMiss() {
+            pars->applyparameters();
+            const vector<float> generated = first();
+
+            //Another seed gives other phases, which are another set
+            pars->Pphaseseed += 1;
+            pars->applyparameters();
+            TS_ASSERT(generated != first());
+            TS_ASSERT_EQUAL_INT(2, (int)cacheFiles().size());
+        }
+
+        void testDisabled() {
+            padcache::setLimit(0);
+            pars->applyparameters();
+            const vector<float> generated = first();
+            TS_ASSERT_EQUAL_INT(0, (int)cacheFiles().size());
+
+            //Generated again, to the same samples
+            renew();
+            pars->applyparameters();
+            TS_ASSERT(generated == first());
+            TS_ASSERT_EQUAL_INT(0, (int)cacheFiles().size());
+        }
+
+        void testShare() {
+            padcache::setLimit(0);
+            PADnoteParameters *other = create();
+            pars->applyparameters();
+            const int samples = padstore::buffers();
+            TS_ASSERT(samples > 0);
+
+            //An identical instance uses the same buffers
+            other->applyparameters();
+            TS_ASSERT_EQUAL_INT(samples, padstore::buffers());
+            for(int i = 0; i < PAD_MAX_SAMPLES; ++i)
+                TS_ASSERT(pars->sample[i].smp == other->sample[i].smp);
+
+            //which outlive the instance that generated them
+            const vector<float> generated = first();
+            delete pars;
+            pars = other;
+            TS_ASSERT(generated == first());
+            TS_ASSERT_EQUAL_INT(samples, padstore::buffers());
+
+            //A different one gets its own
+            other = create();
+            other->Pbandwidth += 10;
+            other->applyparameters();
+            TS_ASSERT_EQUAL_INT(2 * samples, padstore::buffers());
+            TS_ASSERT(pars->sample[0].smp != other->sample[0].smp);
+
+            delete other;
+            TS_ASSERT_EQUAL_INT(samples, padstore::buffers());
+        }
+
+        void testShareParallel() {
+            //Identical instances applied at the same time share one set
+            padcache::setLimit(0);
+            PADnoteParameters *other = create();
+            std::thread t([other]{other->applyparameters();});
+            pars->applyparameters();
+            t.join();
+            TS_ASSERT_EQUAL_INT(pars->sampleCount(), padstore::buffers());
+            for(int i = 0; i < PAD_MAX_SAMPLES; ++i)
+                TS_ASSERT(pars->sample[i].smp == other->sample[i].smp);
+            delete other;
+        }
+
+        void testDraft() {
+            //The smallest samples need no draft
+            TS_ASSERT(!pars->needsDraft());
+
+            pars->Pquality.samplesize = 1;
+            pars->Pquality.smpoct     = 2;
+            TS_ASSERT(pars->needsDraft());
+            pars->applyparameters([]{return false;}, 0, true);
+            TS_ASSERT_EQUAL_INT(1 << 14, pars->sample[0].size);
+            TS_ASSERT_EQUAL_INT(2, pars->sampleCount(true));
+            TS_NON_NULL(pars->sample[1].smp);
+            TS_ASSERT(!pars->sample[2].smp);
+            //Drafts are not kept
+            TS_ASSERT(pars->needsDraft());
+            TS_ASSERT_EQUAL_INT(0, (int)cacheFiles().size());
+
+            pars->applyparameters();
+            TS_ASSERT_EQUAL_INT(1 << 15, pars->sample[0].size);
+            TS_ASSERT_EQUAL_INT(4, pars->sampleCount());
+            TS_NON_NULL(pars->sample[3].smp);
+            TS_ASSERT(!pars->needsDraft());
+
+            //Cached on disk, so a new instance needs no draft either
+            renew();
+            pars->Pquality.samplesize = 1;
+            pars->Pquality.smpoct     = 2;
+            TS_ASSERT(!pars->needsDraft());
+        }
+
+        void testCompact() {
+            pars->applyparameters();
+            TS_ASSERT(pars->sample[0].scale == 0.0f);
+            const vector<float> generated = first();
+
+            //The same set in 16 bit, as precise as 16 bit allow
+            pars->Pquality.storage = PADnoteParameters::storage_int16;
+            pars->applyparameters();
+            const float scale = pars->sample[0].scale;
+            TS_ASSERT(scale > 0.0f);
+            const vector<float> compact = first();
+            float error = 0.0f;
+            for(unsigned i = 0; i < compact.size(); ++i)
+                error = max(error, fabsf(compact[i] - generated[i]));
+            TS_ASSERT(error <= scale);
+            TS_ASSERT_EQUAL_INT(2, (int)cacheFiles().size());
+
+            //and cached as such
+            renew();
+            pars->Pquality.storage = PADnoteParameters::storage_int16;
+            pars->applyparameters();
+            TS_ASSERT(pars->sample[0].scale == scale);
+            TS_ASSERT(compact == first());
+            TS_ASSERT_EQUAL_INT(2, (int)cacheFiles().size());
+        }
+
+        void testEvict() {
+            pars->applyparameters();
+            const vector<string> files = cacheFiles();
+            TS_ASSERT_EQUAL_INT(1, (int)files.size());
+            mark(files[0]);
+
+            //Make the first set the least recently used one
+            sleep(1);
+            pars->Pbandwidth += 10;
+            pars->applyparameters();
+            TS_ASSERT_EQUAL_INT(2, (int)cacheFiles().size());
+
+            //Room for one set only
+            FILE *f = fopen(files[0].c_str(), "rb");
+            TS_NON_NULL(f);
+            fseek(f, 0, SEEK_END);
+            padcache::setLimit(ftell(f));
+            fclose(f);
+            padcache::evict();
+            TS_ASSERT_EQUAL_INT(1, (int)cacheFiles().size());
+
+            //The first set is gone
+            pars->Pbandwidth -= 10;
+            pars->applyparameters();
+            TS_ASSERT(!marked());
+        }
+
+        void testStaleTmp() {
+            //A crashed writer left its temporary file hours ago, another
+            //one is still writing
+            const string stale = string(dir) + "/0000000000000001.pad.1-0.tmp";
+            const string live  = string(dir) + "/0000000000000002.pad.1-0.tmp";
+            fclose(fopen(stale.c_str(), "wb"));
+            fclose(fopen(live.c_str(), "wb"));
+            struct utimbuf old;
+            old.actime = old.modtime = ::time(NULL) - 2 * 3600;
+            utime(stale.c_str(), &old);
+
+            padcache::evict();
+            TS_ASSERT(access(stale.c_str(), F_OK) != 0);
+            TS_ASSERT(access(live.c_str(), F_OK) == 0);
+        }
+};
+
+int main()
+{
+    PadCacheTest test;
+    RUN_TEST(testHit);
+    RUN_TEST(testKey);
+    RUN_TEST(testMiss);
+    RUN_TEST(testDisabled);
+    RUN_TEST(testShare);
+    RUN_TEST(testShareParallel);
+    RUN_TEST(testDraft);
+    RUN_TEST(testCompact);
+    RUN_TEST(testEvict);
+    RUN_TEST(testStaleTmp);
+    return test_summary();
+}
@@ -0,0 +1,176 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  PadKernelTest.cpp - Test the vectorized PADnote playback against scalar
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include "test-suite.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "../DSP/PadKernels.h"
+
+using namespace zyn;
+
+//Small samples, so most buffers wrap around the end
+#define SIZE    200
+#define EXTRA   5
+#define MAXSMPS 70
+
+class PadKernelTest
+{
+    public:
+        float   smps[SIZE + EXTRA];
+        int16_t smps16[SIZE + EXTRA];
+
+        struct State {
+            int   poshi_l, poshi_r;
+            float poslo;
+            float outl[MAXSMPS], outr[MAXSMPS];
+        } ref, dst;
+
+        void setUp() {
+            srand(11);
+            for(int i = 0; i < SIZE; ++i) {
+                smps[i]   = sinf(i * 2 * M_PI / SIZE)
+                            + rand() / (float)RAND_MAX - 0.5f;
+                smps16[i] = (int16_t)(smps[i] * 20000.0f);
+            }
+            for(int i = 0; i < EXTRA; ++i) {
+                smps[SIZE + i]   = smps[i];
+                smps16[SIZE + i] = smps16[i];
+            }
+        }
+
+        void tearDown() {
+            pad::setIsa(mix::ISA_SCALAR);
+        }
+
+        void start(State &s) {
+            memset(&s, 0, sizeof(s));
+            s.poshi_l = rand() % SIZE;
+            s.poshi_r = (s.poshi_l + SIZE / 2) % SIZE;
+            s.poslo   = rand() / (RAND_MAX + 1.0f);
+        }
+
+        void render(State &s, mix::Isa isa, bool cubic, bool compact,
+                    int freqhi, float freqlo, int n) {
+            pad::setIsa(isa);
+            if(compact && cubic)
+                pad::cubic(s.outl, s.outr, smps16, SIZE, 1.0f / 20000.0f,
+                           s.poshi_l, s.poshi_r, s.poslo, freqhi, freqlo, n);
+            else if(compact)
+                pad::linear(s.outl, s.outr, smps16, SIZE, 1.0f / 20000.0f,
+                            s.poshi_l, s.poshi_r, s.poslo, freqhi, freqlo, n);
+            else if(cubic)
+                pad::cubic(s.outl, s.outr, smps, SIZE, 1.0f,
+                           s.poshi_l, s.poshi_r, s.poslo, freqhi, freqlo, n);
+            else
+                pad::linear(s.outl, s.outr, smps, SIZE, 1.0f,
+                            s.poshi_l, s.poshi_r, s.poslo, freqhi, freqlo, n);
+        }
+
+        //Run a few buffers of every length from deep bass to several
+        //samples per step with the scalar and the vector code. The positions
+        //have to agree exactly, the samples up to FMA contraction of the
+        //scalar code (see PadKernels.h)
+        bool matches(mix::Isa isa, bool cubic, bool compact) {
+            bool ok = true;
+            for(int n = 1; n <= MAXSMPS; ++n) {
+                const int   freqhi = rand() % 7;
+                const float freqlo = rand() / (RAND_MAX + 1.0f);
+                start(ref);
+                dst = ref;
+                for(int run = 0; run < 3; ++run) {
+                    render(ref, mix::ISA_SCALAR, cubic, compact,
+                           freqhi, freqlo, n);
+                    render(dst, isa, cubic, compact, freqhi, freqlo, n);
+                    for(int i = 0; i < MAXSMPS; ++i) {
+                        ok &= fabsf(ref.outl[i] - dst.outl[i]) < 1e-5f;
+                        ok &= fabsf(ref.outr[i] - dst.outr[i]) < 1e-5f;
+                    }
+                    ok &= ref.poshi_l == dst.poshi_l;
+                    ok &= ref.poshi_r == dst.poshi_r;
+                    ok &= ref.poslo == dst.poslo;
+                }
+            }
+            return ok;
+        }
+
+        void testKernels() {
+            TS_ASSERT(pad::setIsa(mix::ISA_SCALAR));
+            for(int i = 0; i < mix::ISA_COUNT; ++i) {
+                mix::Isa isa = (mix::Isa)i;
+                if(!pad::setIsa(isa))
+                    continue;
+                printf("Checking %s PADnote playback\n", mix::isaName(isa));
+                TS_ASSERT(matches(isa, false, false));
+                TS_ASSERT(matches(isa, true, false));
+                TS_ASSERT(matches(isa, false, true));
+                TS_ASSERT(matches(isa, true, true));
+            }
+        }
+
+        void testWrap() {
+            //The positions advance and wrap as a step at a time would
+            for(int i = 0; i < mix::ISA_COUNT; ++i) {
+                if(!pad::setIsa((mix::Isa)i))
+                    continue;
+                State s;
+                start(s);
+                int   poshi_l = s.poshi_l, poshi_r = s.poshi_r;
+                float poslo   = s.poslo;
+                for(int k = 0; k < MAXSMPS; ++k) {
+                    poslo += 0.25f;
+                    poshi_l += 3 + (poslo >= 1.0f);
+                    poshi_r += 3 + (poslo >= 1.0f);
+                    poslo   -= poslo >= 1.0f ? 1.0f : 0.0f;
+                    poshi_l %= SIZE;
+                    poshi_r %= SIZE;
+                }
+                render(s, (mix::Isa)i, false, false, 3, 0.25f, MAXSMPS);
+                TS_ASSERT_EQUAL_INT(poshi_l, s.poshi_l);
+                TS_ASSERT_EQUAL_INT(poshi_r, s.poshi_r);
+                TS_ASSERT_DELTA(poslo, s.poslo, 1e-6);
+            }
+        }
+
+        void testValues() {
+            //Half a sample per step interpolates between the samples, the
+            //channels read their own positions
+            State s;
+            memset(&s, 0, sizeof(s));
+            s.poshi_l = 0;
+            s.poshi_r = SIZE - 1;
+            pad::linear(s.outl, s.outr, smps, SIZE, 1.0f,
+                        s.poshi_l, s.poshi_r, s.poslo, 0, 0.5f, 4);
+            TS_ASSERT_DELTA((smps[0] + smps[1]) / 2, s.outl[0], 1e-6);
+            TS_ASSERT_DELTA(smps[1], s.outl[1], 1e-6);
+            TS_ASSERT_DELTA((smps[1] + smps[2]) / 2, s.outl[2], 1e-6);
+            TS_ASSERT_DELTA((smps[SIZE - 1] + smps[0]) / 2, s.outr[0], 1e-6);
+            TS_ASSERT_DELTA(smps[0], s.outr[1], 1e-6);
+            TS_ASSERT_EQUAL_INT(2, s.poshi_l);
+            TS_ASSERT_EQUAL_INT(1, s.poshi_r);
+            TS_ASSERT_DELTA(0.0f, s.poslo, 1e-6);
+
+            //16 bit values are scaled
+            pad::linear(s.outl, s.outr, smps16, SIZE, 0.5f,
+                        s.poshi_l, s.poshi_r, s.poslo, 1, 0.0f, 1);
+            TS_ASSERT_DELTA(smps16[3] * 0.5f, s.outl[0], 1e-3);
+            TS_ASSERT_DELTA(smps16[2] * 0.5f, s.outr[0], 1e-3);
+        }
+};
+
+int main()
+{
+    PadKernelTest test;
+    RUN_TEST(testKernels);
+    RUN_TEST(testWrap);
+    RUN_TEST(testValues);
+    return test_summary();
+}
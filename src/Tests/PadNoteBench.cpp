@@ -0,0 +1,204 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  PadNoteBench.cpp - Micro benchmark of the PADnote playback kernels
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../DSP/PadKernels.h"
+
+using namespace zyn;
+
+//Simulates 32 notes held on one pad with the default sample size
+#define NOTES   32
+#define SIZE    (1 << 17)
+#define EXTRA   5
+#define BUFSIZE 256
+#define ROUNDS  2000
+
+static float   smps[SIZE + EXTRA];
+static int16_t smps16[SIZE + EXTRA];
+static float   outl[BUFSIZE], outr[BUFSIZE];
+
+struct Note {
+    int   poshi_l, poshi_r, freqhi;
+    float poslo, freqlo;
+};
+
+static Note notes[NOTES];
+
+//The loop PADnote used before the kernels, one sample at a time
+static void legacy_linear(Note &n)
+{
+    for(int i = 0; i < BUFSIZE; ++i) {
+        n.poshi_l += n.freqhi;
+        n.poshi_r += n.freqhi;
+        n.poslo   += n.freqlo;
+        if(n.poslo >= 1.0f) {
+            n.poshi_l += 1;
+            n.poshi_r += 1;
+            n.poslo   -= 1.0f;
+        }
+        if(n.poshi_l >= SIZE)
+            n.poshi_l %= SIZE;
+        if(n.poshi_r >= SIZE)
+            n.poshi_r %= SIZE;
+
+        outl[i] = smps[n.poshi_l] * (1.0f - n.poslo)
+                  + smps[n.poshi_l + 1] * n.poslo;
+        outr[i] = smps[n.poshi_r] * (1.0f - n.poslo)
+                  + smps[n.poshi_r + 1] * n.poslo;
+    }
+}
+
+static void legacy_cubic(Note &n)
+{
+    float xm1, x0, x1, x2, a, b, c;
+    for(int i = 0; i < BUFSIZE; ++i) {
+        n.poshi_l += n.freqhi;
+        n.poshi_r += n.freqhi;
+        n.poslo   += n.freqlo;
+        if(n.poslo >= 1.0f) {
+            n.poshi_l += 1;
+            n.poshi_r += 1;
+            n.poslo   -= 1.0f;
+        }
+        if(n.poshi_l >= SIZE)
+            n.poshi_l %= SIZE;
+        if(n.poshi_r >= SIZE)
+            n.poshi_r %= SIZE;
+
+        xm1     = smps[n.poshi_l];
+        x0      = smps[n.poshi_l + 1];
+        x1      = smps[n.poshi_l + 2];
+        x2      = smps[n.poshi_l + 3];
+        a       = (3.0f * (x0 - x1) - xm1 + x2) * 0.5f;
+        b       = 2.0f * x1 + xm1 - (5.0f * x0 + x2) * 0.5f;
+        c       = (x1 - xm1) * 0.5f;
+        outl[i] = (((a * n.poslo) + b) * n.poslo + c) * n.poslo + x0;
+        xm1     = smps[n.poshi_r];
+        x0      = smps[n.poshi_r + 1];
+        x1      = smps[n.poshi_r + 2];
+        x2      = smps[n.poshi_r + 3];
+        a       = (3.0f * (x0 - x1) - xm1 + x2) * 0.5f;
+        b       = 2.0f * x1 + xm1 - (5.0f * x0 + x2) * 0.5f;
+        c       = (x1 - xm1) * 0.5f;
+        outr[i] = (((a * n.poslo) + b) * n.poslo + c) * n.poslo + x0;
+    }
+}
+
+enum Variant {
+    LEGACY,
+    FLOAT,
+    INT16
+};
+
+static void render(Note &n, Variant v, bool cubic)
+{
+    const float scale = 1.0f / 16384.0f;
+    if(v == LEGACY) {
+        if(cubic)
+            legacy_cubic(n);
+        else
+            legacy_linear(n);
+    } else if(v == FLOAT) {
+        if(cubic)
+            pad::cubic(outl, outr, smps, SIZE, 1.0f, n.poshi_l, n.poshi_r,
+                       n.poslo, n.freqhi, n.freqlo, BUFSIZE);
+        else
+            pad::linear(outl, outr, smps, SIZE, 1.0f, n.poshi_l, n.poshi_r,
+                        n.poslo, n.freqhi, n.freqlo, BUFSIZE);
+    } else {
+        if(cubic)
+            pad::cubic(outl, outr, smps16, SIZE, scale, n.poshi_l,
+                       n.poshi_r, n.poslo, n.freqhi, n.freqlo, BUFSIZE);
+        else
+            pad::linear(outl, outr, smps16, SIZE, scale, n.poshi_l,
+                        n.poshi_r, n.poslo, n.freqhi, n.freqlo, BUFSIZE);
+    }
+}
+
+//Notes from two octaves below to two above the sample, with the channels
+//half a sample apart as in PADnote
+static void start(void)
+{
+    srand(0);
+    for(int k = 0; k < NOTES; ++k) {
+        const float freq = powf(2.0f, -2.0f + 4.0f * k / NOTES);
+        notes[k].freqhi  = (int)freq;
+        notes[k].freqlo  = freq - (int)freq;
+        notes[k].poshi_l = rand() % SIZE;
+        notes[k].poshi_r = (notes[k].poshi_l + SIZE / 2) % SIZE;
+        notes[k].poslo   = 0.0f;
+    }
+}
+
+//Seconds for ROUNDS buffers of all notes, out collects the first buffer
+//of the first note
+static double run(Variant v, bool cubic, std::vector<float> &out)
+{
+    start();
+    auto begin = std::chrono::steady_clock::now();
+    for(int r = 0; r < ROUNDS; ++r)
+        for(int k = 0; k < NOTES; ++k) {
+            render(notes[k], v, cubic);
+            if(r == 0 && k == 0)
+                out.assign(outl, outl + BUFSIZE);
+        }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+static float deviation(const std::vector<float> &a,
+                       const std::vector<float> &b)
+{
+    float d = 0.0f;
+    for(unsigned i = 0; i < a.size(); ++i)
+        d = std::max(d, fabsf(a[i] - b[i]));
+    return d;
+}
+
+int main()
+{
+    for(int i = 0; i < SIZE; ++i) {
+        smps[i] = sinf(i * 0.01f) * 0.5f + rand() / (float)RAND_MAX - 0.5f;
+        smps16[i] = (int16_t)lrintf(smps[i] * 16384.0f);
+    }
+    for(int i = 0; i < EXTRA; ++i) {
+        smps[SIZE + i]   = smps[i];
+        smps16[SIZE + i] = smps16[i];
+    }
+
+    printf("%d notes, %d samples, %d buffers\n", NOTES, BUFSIZE, ROUNDS);
+    for(int cubic = 0; cubic < 2; ++cubic) {
+        std::vector<float> ref, out;
+        const char *name = cubic ? "cubic" : "linear";
+        const double legacy = run(LEGACY, cubic, ref);
+        printf("%-6s legacy        %8.3f ms  %6.2f us/buffer\n", name,
+               legacy * 1e3, legacy * 1e6 / ROUNDS);
+
+        for(int k = 0; k < mix::ISA_COUNT; ++k) {
+            mix::Isa isa = (mix::Isa)k;
+            if(!pad::setIsa(isa))
+                continue;
+            for(int v = FLOAT; v <= INT16; ++v) {
+                const double t = run((Variant)v, cubic, out);
+                printf("%-6s %-6s %-6s %8.3f ms  %6.2f us/buffer  x%.2f"
+                       "  max diff %.2g\n", name, mix::isaName(isa),
+                       v == FLOAT ? "float" : "int16", t * 1e3,
+                       t * 1e6 / ROUNDS, legacy / t, deviation(ref, out));
+            }
+        }
+    }
+    return 0;
+}
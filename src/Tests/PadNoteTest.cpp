@@ -16,7 +16,9 @@
 #include "test-suite.h"
 #include <complex>
 #include <ctime>
+#include <mutex>
 #include <string>
+#include <vector>
 #define private public
 #include "../Synth/PADnote.h"
 #undef private
@@ -27,6 +29,7 @@
 #include "../Synth/PADnote.h"
 #include "../Synth/OscilGen.h"
 #include "../Params/PADnoteParameters.h"
+#include "../Params/PADstore.h"
 #include "../Params/Presets.h"
 #include "../DSP/FFTwrapper.h"
 #include "../globals.h"
@@ -152,7 +155,7 @@ class PadNoteTest
 #endif
             sampleCount += synth->buffersize;
 
-            TS_ASSERT_DELTA(outL[255], -0.0555f, 0.0005f);
+            TS_ASSERT_DELTA(outL[255], 0.0923f, 0.0005f);
 
 
             note->releasekey();
@@ -161,21 +164,21 @@ class PadNoteTest
             w->add_watch("noteout");
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], -0.0726f, 0.0005f);
+            TS_ASSERT_DELTA(outL[255], -0.1068f, 0.0005f);
             w->tick();
             TS_ASSERT(!tr->hasNext());
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], -0.0516f, 0.0005f);
+            TS_ASSERT_DELTA(outL[255], -0.1031f, 0.0005f);
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], 0.0529f, 0.0005f);
+            TS_ASSERT_DELTA(outL[255], -0.0507f, 0.0005f);
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], 0.0525f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], -0.0555f, 0.0001f);
 
             while(!note->finished()) {
                 note->noteout(outL, outR);
@@ -210,26 +213,26 @@ class PadNoteTest
             for(int i=8; i<PAD_MAX_SAMPLES; ++i)
                 TS_ASSERT(!pars->sample[i].smp);
 
-            TS_ASSERT_DELTA(pars->sample[0].smp[0],   0.0516f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[1],   0.0845f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[2],   0.1021f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[3],   0.0919f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[4],   0.0708f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[5],   0.0414f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[6],   0.0318f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[7],   0.0217f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[8],   0.0309f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[9],   0.0584f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[10],  0.0266f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[11],  0.0436f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[12],  0.0199f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[13],  0.0505f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[14],  0.0438f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[15],  0.0024f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[16],  0.0052f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[17], -0.0180f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[18],  0.0342f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[19],  0.0051f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[0],  -0.1569f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[1],  -0.1718f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[2],  -0.1612f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[3],  -0.1727f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[4],  -0.1205f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[5],  -0.1106f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[6],  -0.1031f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[7],  -0.1232f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[8],  -0.1221f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[9],  -0.1216f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[10], -0.1508f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[11], -0.1821f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[12], -0.2123f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[13], -0.1914f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[14], -0.1958f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[15], -0.1667f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[16], -0.1808f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[17],-0.2075f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[18], -0.1772f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[19], -0.1682f, 0.0005f);
 
 
             //Verify Harmonic Input
@@ -273,6 +276,58 @@ class PadNoteTest
 
         }
 
+        //Samples of a draft set, which is generated without the shared
+        //storage or the cache
+        vector<vector<float>> generate(unsigned threads) {
+            vector<vector<float>> set(PAD_MAX_SAMPLES);
+            mutex lock;
+            pars->sampleGenerator(
+                    [&](int n, PADnoteParameters::Sample &&s) {
+                        lock_guard<mutex> guard(lock);
+                        set[n].assign(s.smp, s.smp + s.size);
+                        padstore::release(s.smp);
+                    }, []{return false;}, threads, true);
+            return set;
+        }
+
+        void testReproducible() {
+            //The phases depend on the seed only, not on the threads
+            const vector<vector<float>> serial = generate(1);
+            TS_ASSERT(!serial[0].empty());
+            TS_ASSERT(serial == generate(0));
+            TS_ASSERT(serial == generate(3));
+
+            pars->Pphaseseed = 1;
+            TS_ASSERT(serial != generate(0));
+        }
+
+        void testCompact() {
+            const int   poshi_l = note->poshi_l, poshi_r = note->poshi_r;
+            const float poslo   = note->poslo;
+            note->noteout(outL, outR);
+            const vector<float> left(outL, outL + synth->buffersize);
+            const vector<float> right(outR, outR + synth->buffersize);
+
+            //A note of 16 bit samples from the same position sounds the same
+            pars->Pquality.storage = PADnoteParameters::storage_int16;
+            pars->applyparameters([]{return false;}, 1);
+            TS_ASSERT(pars->sample[0].scale > 0.0f);
+
+            SynthParams pars_{memory, *controller, *synth, *time, 120, 0,
+                              test_freq_log2, false, prng()};
+            PADnote compact(pars, pars_, interpolation);
+            compact.poshi_l = poshi_l;
+            compact.poshi_r = poshi_r;
+            compact.poslo   = poslo;
+            compact.noteout(outL, outR);
+
+            float error = 0.0f;
+            for(int i = 0; i < synth->buffersize; ++i)
+                error = max(error, max(fabsf(outL[i] - left[i]),
+                                       fabsf(outR[i] - right[i])));
+            TS_ASSERT(error < 0.001f);
+        }
+
 #define OUTPUT_PROFILE
 #ifdef OUTPUT_PROFILE
         void testSpeed() {
@@ -294,6 +349,8 @@ int main()
     PadNoteTest test;
     RUN_TEST(testDefaults);
     RUN_TEST(testInitialization);
+    RUN_TEST(testReproducible);
+    RUN_TEST(testCompact);
     RUN_TEST(testSpeed);
     return test_summary();
 }
@@ -18,6 +18,7 @@
 #include <string>
 #include "../Misc/MiddleWare.h"
 #include "../Misc/Master.h"
+#include "../Misc/Part.h"
 #include "../Misc/PresetExtractor.h"
 #include "../Misc/PresetExtractor.cpp"
 #include "../Misc/Util.h"
@@ -214,6 +215,51 @@ class PluginTest
             TS_ASSERT(0.1f < sum);
         }
 
+        //Queued MIDI takes effect at its frame, within the buffer
+        void testTimedMidi()
+        {
+            const uint8_t on[3] = {0x90, 64, 100};
+            TS_ASSERT(master[0]->queueMidi(300, on, 3));
+            const uint8_t pgm[2] = {0xC0, 1};
+            TS_ASSERT(!master[0]->queueMidi(400, pgm, 2));
+            //out of order
+            TS_ASSERT(!master[0]->queueMidi(100, on, 3));
+
+            master[0]->GetAudioOutSamples(1024, synth->samplerate, outL, outR);
+
+            float before = 0.0f, after = 0.0f;
+            for(int i = 0; i < 300; ++i)
+                before += fabsf(outL[i]);
+            for(int i = 300; i < 2 * synth->buffersize; ++i)
+                after += fabsf(outL[i]);
+            TS_ASSERT(before < 1e-4f);
+            TS_ASSERT(0.1f < after);
+        }
+
+        //Both render paths put a hard panned part on the same channel
+        void testChannels()
+        {
+            float sum[2][2];
+            for(int k = 0; k < 2; ++k) {
+                master[k]->part[0]->setPpanning(0);
+                master[k]->noteOn(0, 64, 100);
+                //the last buffer is past the pan smoothing
+                for(int b = 0; b < 4; ++b)
+                    if(k == 0)
+                        master[k]->AudioOut(outL, outR);
+                    else
+                        master[k]->GetAudioOutSamples(synth->buffersize,
+                                synth->samplerate, outL, outR);
+                sum[k][0] = sum[k][1] = 0.0f;
+                for(int i = 0; i < synth->buffersize; ++i) {
+                    sum[k][0] += fabsf(outL[i]);
+                    sum[k][1] += fabsf(outR[i]);
+                }
+            }
+            TS_ASSERT(sum[0][0] > 10 * sum[0][1]);
+            TS_ASSERT(sum[1][0] > 10 * sum[1][1]);
+        }
+
         string loadfile(string fname) const
         {
             std::ifstream t(fname.c_str());
@@ -248,6 +294,8 @@ int main()
     PluginTest test;
     RUN_TEST(testInit);
     RUN_TEST(testPanic);
+    RUN_TEST(testTimedMidi);
+    RUN_TEST(testChannels);
     RUN_TEST(testLoadSave);
     return test_summary();
 }
@@ -11,10 +11,73 @@
   of the License, or (at your option) any later version.
 */
 
+#include <algorithm>
+#include <cstring>
+#include "../Misc/Rng.h"
 #include "../Misc/Util.h"
 #include "test-suite.h"
 using namespace zyn;
 
+//The vector fills have to give exactly the numbers of the scalar stream,
+//also when the counter wraps around
+static bool fillMatches(mix::Isa isa)
+{
+    bool ok = true;
+    for(int n = 0; n <= 40; ++n) {
+        float fill[40], ref[40];
+        RngStream a(1234, 5), b(1234, 5);
+        a.counter = b.counter = 0xfffffff0U;
+        rng::setIsa(isa);
+        a.fill(fill, n, -1.0f, 1.0f);
+        for(int i = 0; i < n; ++i)
+            ref[i] = -1.0f + 2.0f * b.unit();
+        ok &= !memcmp(fill, ref, n * sizeof(float));
+        ok &= a.counter == b.counter;
+    }
+    rng::setIsa(mix::ISA_SCALAR);
+    return ok;
+}
+
+static void testStreams(void)
+{
+    //Same seed and stream, same numbers
+    RngStream a(7), b(7), c(7, 1), d(8);
+    int same = 0;
+    for(int i = 0; i < 100; ++i) {
+        const uint32_t x = a.next();
+        TS_ASSERT_EQUAL_INT(x, b.next());
+        same += x == c.next();
+        same += x == d.next();
+    }
+    TS_ASSERT_EQUAL_INT(0, same);
+
+    //Any position can be read directly
+    a.reset(7);
+    a.counter = 50;
+    b.reset(7);
+    for(int i = 0; i < 50; ++i)
+        b.next();
+    TS_ASSERT_EQUAL_INT(a.next(), b.next());
+
+    float  lo = 1.0f, hi = 0.0f;
+    double sum = 0.0;
+    for(int i = 0; i < 100000; ++i) {
+        const float u = a.unit();
+        lo   = std::min(lo, u);
+        hi   = std::max(hi, u);
+        sum += u;
+    }
+    TS_ASSERT(lo >= 0.0f && lo < 0.001f);
+    TS_ASSERT(hi < 1.0f && hi > 0.999f);
+    TS_ASSERT_DELTA(0.5, sum / 100000, 0.005);
+
+    for(int i = 0; i < mix::ISA_COUNT; ++i)
+        if(rng::setIsa((mix::Isa)i)) {
+            printf("Checking %s random fill\n", mix::isaName((mix::Isa)i));
+            TS_ASSERT(fillMatches((mix::Isa)i));
+        }
+}
+
 int main()
 {
     TS_ASSERT_DELTA(RND, 0.607781, 0.00001);
@@ -22,5 +85,6 @@ int main()
     TS_ASSERT_DELTA(RND, 0.186133, 0.00001);
     TS_ASSERT_DELTA(RND, 0.286319, 0.00001);
     TS_ASSERT_DELTA(RND, 0.511766, 0.00001);
+    testStreams();
     return test_summary();
 };
@@ -0,0 +1,88 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  RenderPoolTest.cpp - Test for the realtime fork/join pool
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include "test-suite.h"
+#include <atomic>
+#include "../Misc/RenderPool.h"
+
+using namespace zyn;
+
+#define JOBS 16
+
+struct Counter
+{
+    std::atomic<int> hits[JOBS];
+};
+
+static void count_job(void *ctx, int idx)
+{
+    Counter &c = *(Counter*)ctx;
+    //give the other threads a chance to pick up some work
+    volatile float sink = 0.0f;
+    for(int i = 0; i < 1000; ++i)
+        sink = sink + i;
+    c.hits[idx]++;
+}
+
+class RenderPoolTest
+{
+    public:
+        Counter counter;
+
+        void setUp() {
+            for(int i = 0; i < JOBS; ++i)
+                counter.hits[i] = 0;
+        }
+
+        void tearDown() {}
+
+        void testSerial() {
+            RenderPool pool(0, count_job, &counter);
+            TS_ASSERT_EQUAL_INT(0, (int)pool.threads());
+            pool.run(JOBS);
+            for(int i = 0; i < JOBS; ++i)
+                TS_ASSERT_EQUAL_INT(1, counter.hits[i].load());
+        }
+
+        void testParallel() {
+            RenderPool pool(3, count_job, &counter);
+            const int batches = 2000;
+            for(int b = 0; b < batches; ++b)
+                pool.run(JOBS);
+
+            //Every job must have run exactly once per batch
+            bool exact = true;
+            for(int i = 0; i < JOBS; ++i)
+                exact &= counter.hits[i].load() == batches;
+            TS_ASSERT(exact);
+        }
+
+        void testPartialBatch() {
+            RenderPool pool(2, count_job, &counter);
+            pool.run(5);
+            pool.run(0);
+            pool.run(1);
+            TS_ASSERT_EQUAL_INT(2, counter.hits[0].load());
+            for(int i = 1; i < 5; ++i)
+                TS_ASSERT_EQUAL_INT(1, counter.hits[i].load());
+            for(int i = 5; i < JOBS; ++i)
+                TS_ASSERT_EQUAL_INT(0, counter.hits[i].load());
+        }
+};
+
+int main()
+{
+    RenderPoolTest test;
+    RUN_TEST(testSerial);
+    RUN_TEST(testParallel);
+    RUN_TEST(testPartialBatch);
+    return test_summary();
+}
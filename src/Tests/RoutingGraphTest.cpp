@@ -0,0 +1,124 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  RoutingGraphTest.cpp - Test the compiled master routing
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include "test-suite.h"
+#include <cstring>
+#include "../Misc/RoutingGraph.h"
+
+using namespace zyn;
+
+class RoutingGraphTest
+{
+    public:
+        RoutingGraph        graph;
+        RoutingGraph::State state;
+        float sysvol[NUM_SYS_EFX][NUM_MIDI_PARTS];
+        float syssend[NUM_SYS_EFX][NUM_SYS_EFX];
+
+        void setUp() {
+            memset(&state, 0, sizeof(state));
+            for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx)
+                state.insparts[nefx] = -1;
+            for(int i = 0; i < NUM_SYS_EFX; ++i) {
+                for(int j = 0; j < NUM_MIDI_PARTS; ++j)
+                    sysvol[i][j] = 0.01f * (i + 1) + j;
+                for(int j = 0; j < NUM_SYS_EFX; ++j)
+                    syssend[i][j] = 10.0f * i + j;
+            }
+        }
+        void tearDown() {}
+
+        void testEmpty() {
+            TS_ASSERT(graph.update(state, sysvol, syssend));
+            TS_ASSERT(!graph.update(state, sysvol, syssend));
+            TS_ASSERT_EQUAL_INT(0, graph.nparts);
+            TS_ASSERT_EQUAL_INT(0, graph.npartins);
+            TS_ASSERT_EQUAL_INT(0, graph.nmasterins);
+            TS_ASSERT_EQUAL_INT(0, graph.nsysefx);
+            TS_ASSERT_EQUAL_INT(0, graph.nlevels);
+        }
+
+        void testInsertion() {
+            state.partEnabled[0] = true;
+            state.partEnabled[2] = true;
+            //on an enabled part
+            state.insparts[0] = 2; state.insefx[0] = 1;
+            //on a disabled part
+            state.insparts[1] = 1; state.insefx[1] = 1;
+            //no effect selected
+            state.insparts[2] = 0; state.insefx[2] = 0;
+            //master out
+            state.insparts[3] = -2; state.insefx[3] = 3;
+            graph.update(state, sysvol, syssend);
+
+            TS_ASSERT_EQUAL_INT(2, graph.nparts);
+            TS_ASSERT_EQUAL_INT(0, graph.parts[0]);
+            TS_ASSERT_EQUAL_INT(2, graph.parts[1]);
+            TS_ASSERT_EQUAL_INT(1, graph.npartins);
+            TS_ASSERT_EQUAL_INT(0, graph.partins[0].efx);
+            TS_ASSERT_EQUAL_INT(2, graph.partins[0].part);
+            TS_ASSERT_EQUAL_INT(1, graph.nmasterins);
+            TS_ASSERT_EQUAL_INT(3, graph.masterins[0]);
+
+            //enabling the part brings its edge back
+            state.partEnabled[1] = true;
+            TS_ASSERT(graph.update(state, sysvol, syssend));
+            TS_ASSERT_EQUAL_INT(2, graph.npartins);
+        }
+
+        void testSysefxLevels() {
+            state.partEnabled[0] = true;
+            state.partEnabled[1] = true;
+            //efx 0 and 1 are fed by parts, efx 2 by efx 0, efx 3 by efx 2
+            state.sysefx[0] = state.sysefx[1] = 1;
+            state.sysefx[2] = state.sysefx[3] = 2;
+            state.sysvol[0][0] = 64;
+            state.sysvol[1][1] = 64;
+            state.sysvol[1][5] = 64; //disabled part
+            state.syssend[0][2] = 64;
+            state.syssend[2][3] = 64;
+            graph.update(state, sysvol, syssend);
+
+            TS_ASSERT_EQUAL_INT(4, graph.nsysefx);
+            TS_ASSERT_EQUAL_INT(3, graph.nlevels);
+
+            const RoutingGraph::SysefxNode *n = graph.sysefx;
+            TS_ASSERT_EQUAL_INT(1, n[0].level);
+            TS_ASSERT_EQUAL_INT(1, n[1].level);
+            TS_ASSERT_EQUAL_INT(2, n[2].level);
+            TS_ASSERT_EQUAL_INT(3, n[3].level);
+
+            TS_ASSERT_EQUAL_INT(1, n[1].nparts);
+            TS_ASSERT_EQUAL_INT(1, n[1].part[0]);
+            TS_ASSERT_DELTA(sysvol[1][1], n[1].partgain[0], 1e-6);
+            TS_ASSERT_EQUAL_INT(0, n[2].nparts);
+            TS_ASSERT_EQUAL_INT(1, n[2].nsends);
+            TS_ASSERT_EQUAL_INT(0, n[2].from[0]);
+            TS_ASSERT_DELTA(syssend[0][2], n[2].fromgain[0], 1e-6);
+
+            //turning off efx 2 cuts the chain, efx 3 is left without input
+            state.sysefx[2] = 0;
+            TS_ASSERT(graph.update(state, sysvol, syssend));
+            TS_ASSERT_EQUAL_INT(3, graph.nsysefx);
+            TS_ASSERT_EQUAL_INT(1, graph.nlevels);
+            TS_ASSERT_EQUAL_INT(3, graph.sysefx[2].efx);
+            TS_ASSERT_EQUAL_INT(0, graph.sysefx[2].nsends);
+        }
+};
+
+int main()
+{
+    RoutingGraphTest test;
+    RUN_TEST(testEmpty);
+    RUN_TEST(testInsertion);
+    RUN_TEST(testSysefxLevels);
+    return test_summary();
+}
@@ -117,7 +117,7 @@ class SubNoteTest
 #endif
             sampleCount += synth->buffersize;
 
-            TS_ASSERT_DELTA(outL[255], -0.0009f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], 0.0007f, 0.0001f);
 
             note->releasekey();
 
@@ -126,12 +126,12 @@ class SubNoteTest
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], 0.0026f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], 0.0019f, 0.0001f);
             w->tick();
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], -0.0011f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], 0.0005f, 0.0001f);
             w->tick();
 
             TS_ASSERT(tr->hasNext());
@@ -141,12 +141,12 @@ class SubNoteTest
             w->add_watch("noteout/amp_int");
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], -0.0023f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], -0.0014f, 0.0001f);
             w->tick();
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], -0.0013f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], -0.0011f, 0.0001f);
             w->tick();
             TS_ASSERT(tr->hasNext());
             TS_ASSERT_EQUAL_STR("noteout/amp_int", tr->read());
@@ -117,20 +117,20 @@ class UnisonTest
 
             float data[][4] = {
                 {-0.034547,0.034349,-0.000000,0.138284},
-                {0.016801,-0.084991,0.000000,0.009240},
-                {0.020383,-0.002424,-0.012952,-0.014037},
-                {-0.041653,0.002287,0.000000,-0.098181},
-                {-0.009189,-0.049860,0.000268,-0.084941},
-                {0.056976,-0.084627,-0.018144,0.000666},
-                {-0.015588,0.003690,0.003994,0.002435},
-                {0.023178,-0.024961,0.004433,-0.015144},
-                {0.042007,-0.006559,-0.005887,0.083685},
-                {0.007638,0.057870,-0.014244,0.041457},
-                {-0.018006,-0.017846,-0.063624,-0.016378},
-                {0.004914,-0.001756,-0.046715,0.015975},
-                {0.004341,-0.014575,0.000560,0.050902},
-                {0.000470,-0.036961,0.038622,0.031383},
-                {-0.045796,0.000262,0.009858,0.031958},
+                {0.023097,0.000000,0.000000,-0.032412},
+                {0.019819,-0.005211,0.021132,-0.020482},
+                {-0.009158,-0.000722,0.000000,-0.055218},
+                {0.015953,0.068142,0.002003,-0.009633},
+                {-0.020922,0.022836,0.000000,-0.002950},
+                {0.027293,-0.014051,0.047134,0.100209},
+                {-0.021867,0.033188,-0.029378,-0.054670},
+                {-0.000191,0.042071,-0.023589,-0.002945},
+                {-0.018366,0.038700,0.058937,-0.002524},
+                {-0.016679,0.029530,-0.009609,0.014049},
+                {0.041987,0.005605,-0.016757,0.042745},
+                {0.041621,-0.034845,-0.019976,0.113445},
+                {-0.016013,-0.084907,0.026204,0.058263},
+                {-0.017824,-0.013615,-0.082540,0.086306},
             };
 
             int freq_spread[15];
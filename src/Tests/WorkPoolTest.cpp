@@ -0,0 +1,191 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  WorkPoolTest.cpp - Test for the non-realtime work stealing pool
+  Copyright (C) 2026 ZynAddSubFX contributors
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include "test-suite.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+#include "../Misc/WorkPool.h"
+
+using namespace zyn;
+
+#define JOBS 64
+
+class WorkPoolTest
+{
+    public:
+        std::atomic<int> hits[JOBS];
+        std::atomic<bool> started, released;
+
+        void setUp() {
+            for(int i = 0; i < JOBS; ++i)
+                hits[i] = 0;
+            started  = false;
+            released = false;
+        }
+
+        void tearDown() {}
+
+        //Keep the only worker of a pool busy until unblock()
+        void block(WorkPool::Group &g) {
+            g.run([this]{
+                    started = true;
+                    while(!released)
+                        usleep(100);
+                    });
+            while(!started)
+                usleep(100);
+        }
+
+        void unblock(void) {
+            released = true;
+        }
+
+        void testRun() {
+            WorkPool pool(3);
+            TS_ASSERT_EQUAL_INT(3, (int)pool.threads());
+            WorkPool::Group g(pool, WorkPool::PRIO_LOAD);
+            for(int i = 0; i < JOBS; ++i)
+                g.run([this,i]{hits[i]++;});
+            g.wait();
+            TS_ASSERT(g.done());
+
+            bool exact = true;
+            for(int i = 0; i < JOBS; ++i)
+                exact &= hits[i] == 1;
+            TS_ASSERT(exact);
+        }
+
+        void testNested() {
+            //Every job waits for jobs of its own, with one worker only
+            WorkPool pool(1);
+            WorkPool::Group outer(pool, WorkPool::PRIO_LOAD);
+            for(int i = 0; i < 8; ++i)
+                outer.run([this,&pool,i]{
+                        WorkPool::Group inner(pool, WorkPool::priority());
+                        for(int j = 0; j < 8; ++j)
+                            inner.run([this,i,j]{hits[i*8+j]++;});
+                        inner.wait();
+                        });
+            outer.wait();
+
+            bool exact = true;
+            for(int i = 0; i < JOBS; ++i)
+                exact &= hits[i] == 1;
+            TS_ASSERT(exact);
+        }
+
+        void testPriority() {
+            WorkPool pool(1);
+            WorkPool::Group busy(pool, WorkPool::PRIO_LOAD);
+            block(busy);
+
+            std::mutex  mutex;
+            std::string order;
+            auto record = [&](char c) {
+                return [&,c]{
+                    std::lock_guard<std::mutex> lock(mutex);
+                    order += c;
+                };
+            };
+
+            WorkPool::Group prefetch(pool, WorkPool::PRIO_PREFETCH);
+            WorkPool::Group load(pool, WorkPool::PRIO_LOAD);
+            WorkPool::Group active(pool, WorkPool::PRIO_ACTIVE);
+            prefetch.run(record('p'));
+            load.run(record('l'));
+            active.run(record('a'));
+            prefetch.run(record('p'));
+            active.run(record('a'));
+            unblock();
+
+            //Leave the jobs to the worker
+            while(!prefetch.done() || !load.done() || !active.done())
+                usleep(100);
+            TS_ASSERT(order == "aalpp");
+        }
+
+        void testCancel() {
+            WorkPool pool(1);
+            WorkPool::Group busy(pool, WorkPool::PRIO_LOAD);
+            block(busy);
+
+            WorkPool::Group g(pool, WorkPool::PRIO_LOAD);
+            for(int i = 0; i < JOBS; ++i)
+                g.run([this,i]{hits[i]++;});
+            g.cancel();
+            TS_ASSERT(g.cancelled());
+            unblock();
+            g.wait();
+
+            int total = 0;
+            for(int i = 0; i < JOBS; ++i)
+                total += hits[i];
+            TS_ASSERT_EQUAL_INT(0, total);
+        }
+
+        void testAbort() {
+            WorkPool pool(2);
+            std::atomic<int> budget(JOBS / 2);
+            WorkPool::Group g(pool, WorkPool::PRIO_LOAD,
+                              [&budget]{return budget <= 0;});
+            for(int i = 0; i < JOBS; ++i)
+                g.run([this,i,&budget]{hits[i]++; budget--;});
+            g.wait();
+
+            //Jobs stop starting once the abort callback is true
+            int total = 0;
+            for(int i = 0; i < JOBS; ++i)
+                total += hits[i];
+            TS_ASSERT(total >= JOBS / 2);
+            TS_ASSERT(total < JOBS);
+        }
+
+        void testPriorityOfJobs() {
+            TS_ASSERT_EQUAL_INT(WorkPool::PRIO_LOAD, WorkPool::priority());
+            {
+                WorkPool::PriorityScope scope(WorkPool::PRIO_PREFETCH);
+                TS_ASSERT_EQUAL_INT(WorkPool::PRIO_PREFETCH,
+                                    WorkPool::priority());
+            }
+            TS_ASSERT_EQUAL_INT(WorkPool::PRIO_LOAD, WorkPool::priority());
+
+            //Jobs create their groups with their own priority by default
+            WorkPool pool(1);
+            std::atomic<int> prio(-1);
+            WorkPool::Group g(pool, WorkPool::PRIO_ACTIVE);
+            g.run([&prio]{prio = WorkPool::priority();});
+            g.wait();
+            TS_ASSERT_EQUAL_INT(WorkPool::PRIO_ACTIVE, prio.load());
+        }
+
+        void testShared() {
+            std::shared_ptr<WorkPool> a = WorkPool::shared();
+            std::shared_ptr<WorkPool> b = WorkPool::shared();
+            TS_NON_NULL(a.get());
+            TS_ASSERT(a == b);
+            TS_ASSERT(a->threads() > 0);
+        }
+};
+
+int main()
+{
+    WorkPoolTest test;
+    RUN_TEST(testRun);
+    RUN_TEST(testNested);
+    RUN_TEST(testPriority);
+    RUN_TEST(testCancel);
+    RUN_TEST(testAbort);
+    RUN_TEST(testPriorityOfJobs);
+    RUN_TEST(testShared);
+    return test_summary();
+}
@@ -13,6 +13,7 @@
 */
 
 #include "Misc/Util.h"
+#include "DSP/Denormal.h"
 #include "globals.h"
 
 namespace zyn {
@@ -24,9 +25,10 @@ void SYNTH_T::alias(bool randomize)
     bufferbytes      = buffersize * sizeof(float);
     oscilsize_f      = oscilsize;
 
-    //produce denormal buf
+    //produce denormal buf, not needed when the FPU flushes denormals
     // note: once there will be more buffers, use a cleanup function
     // for deleting the buffers and also call it in the dtor
+    randomize &= denormal::policy() == denormal::POLICY_NOISE;
     denormalkillbuf.resize(buffersize);
     for(int i = 0; i < buffersize; ++i)
         if(randomize)
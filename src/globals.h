@@ -73,7 +73,12 @@ class  SVFilter;
 class  FormantFilter;
 class  ModFilter;
 
+//Precision of the spectra (oscillators, PADsynth), see FFTwrapper
+#if ZYN_FLOAT_FFT
+typedef float fftw_real;
+#else
 typedef double fftw_real;
+#endif
 typedef std::complex<fftw_real> fft_t;
 
 /**
@@ -17,6 +17,7 @@
 #include <map>
 #include <cmath>
 #include <cctype>
+#include <cstring>
 #include <ctime>
 #include <algorithm>
 #include <signal.h>
@@ -34,13 +35,18 @@
 #include <rtosc/rtosc.h>
 #include <rtosc/ports.h>
 #include "Params/PADnoteParameters.h"
+#include "Params/PADcache.h"
 
+#include "DSP/Denormal.h"
 #include "DSP/FFTwrapper.h"
+#include "Misc/Bank.h"
 #include "Misc/MemLocker.h"
 #include "Misc/PresetExtractor.h"
 #include "Misc/Master.h"
+#include "Misc/OfflineRender.h"
 #include "Misc/Part.h"
 #include "Misc/Util.h"
+#include "Misc/WorkPool.h"
 #include "zyn-config.h"
 #include "zyn-version.h"
 
@@ -116,6 +122,35 @@ void initprogram(SYNTH_T synth, Config* config, int preferred_port)
     Nio::init(master->synth, config->cfg.oss_devs, master);
 }
 
+/*
+ * Generate the PADsynth samples of every instrument of a bank, so they are
+ * found in the cache when the bank is used
+ */
+int prewarmPadCache(const string &bankdir, const SYNTH_T &synth, Config &config)
+{
+    Bank bank(&config);
+    if(bank.loadbank(bankdir) < 0) {
+        cerr << "ERROR: Could not open the bank " << bankdir << endl;
+        return 1;
+    }
+
+    AllocatorClass alloc;
+    AbsTime        time(synth);
+    Microtonal     microtonal(config.cfg.GzipCompression);
+    FFTwrapper     fft(synth.oscilsize);
+    WorkPool::PriorityScope prefetch(WorkPool::PRIO_PREFETCH);
+    for(int i = 0; i < BANK_SIZE; ++i) {
+        if(bank.emptyslot(i))
+            continue;
+        cout << "Preparing " << bank.ins[i].filename << endl;
+        Part part(alloc, synth, time, config.cfg.GzipCompression,
+                  config.cfg.Interpolation, &microtonal, &fft);
+        bank.loadfromslot(i, &part);
+        part.applyparameters();
+    }
+    return 0;
+}
+
 /*
  * Program exit
  */
@@ -320,6 +355,9 @@ int main(int argc, char *argv[])
         {
             "dump-json-schema", 2, NULL, 'D'
         },
+        {
+            "render-threads", 1, NULL, 'T'
+        },
         // options without single char equivalents ("getopt_flag" compulsory)
         {
             "list-inputs", no_argument, &getopt_flag, 'i'
@@ -327,6 +365,27 @@ int main(int argc, char *argv[])
         {
             "list-outputs", no_argument, &getopt_flag, 'o'
         },
+        {
+            "render", required_argument, &getopt_flag, 'R'
+        },
+        {
+            "out", required_argument, &getopt_flag, 'W'
+        },
+        {
+            "stems", no_argument, &getopt_flag, 's'
+        },
+        {
+            "render-jobs", required_argument, &getopt_flag, 'j'
+        },
+        {
+            "denormal-policy", required_argument, &getopt_flag, 'n'
+        },
+        {
+            "fft-wisdom", no_argument, &getopt_flag, 'w'
+        },
+        {
+            "pad-cache", required_argument, &getopt_flag, 'c'
+        },
         {
             0, 0, 0, 0
         }
@@ -339,7 +398,9 @@ int main(int argc, char *argv[])
         help,
         version,
         list_inputs,
-        list_outputs
+        list_outputs,
+        fft_wisdom,
+        pad_cache
     };
     exit_with_t exit_with = exit_with_t::dont_exit;
     int preferred_port = -1;
@@ -347,6 +408,8 @@ int main(int argc, char *argv[])
     int wmidi = -1;
 
     string loadfile, loadinstrument, execAfterInit, loadmidilearn;
+    string prewarmbank;
+    OfflineRenderOptions render = {"", "", "", false, 0};
 
     while(1) {
         int tmp = 0;
@@ -354,7 +417,7 @@ int main(int argc, char *argv[])
         /**\todo check this process for a small memory leak*/
         opt = getopt_long(argc,
                           argv,
-                          "l:L:M:r:b:o:I:O:N:e:P:A:d:D:hvapSDUYZ",
+                          "l:L:M:r:b:o:I:O:N:e:P:A:d:D:T:hvapSDUYZ",
                           opts,
                           &option_index);
         char *optarguments = optarg;
@@ -455,6 +518,15 @@ int main(int argc, char *argv[])
             case 'e':
                 GETOP(execAfterInit);
                 break;
+            case 'T':
+                GETOPNUM(config.cfg.RenderThreads);
+                if(config.cfg.RenderThreads < 0
+                   || config.cfg.RenderThreads > NUM_MIDI_PARTS) {
+                    cerr << "ERROR:Incorrect number of render threads: "
+                         << optarguments << endl;
+                    exit(1);
+                }
+                break;
             case 'd':
                 if(optarguments)
                 {
@@ -489,6 +561,36 @@ int main(int argc, char *argv[])
                     case 'o':
                         exit_with = exit_with_t::list_outputs;
                         break;
+                    case 'R':
+                        GETOP(render.midifile);
+                        break;
+                    case 'W':
+                        GETOP(render.outfile);
+                        break;
+                    case 's':
+                        render.stems = true;
+                        break;
+                    case 'j':
+                        GETOPNUM(render.jobs);
+                        break;
+                    case 'n':
+                        if(!strcmp(optarguments, "noise"))
+                            config.cfg.DenormalPolicy = 0;
+                        else if(!strcmp(optarguments, "flush"))
+                            config.cfg.DenormalPolicy = 1;
+                        else {
+                            cerr << "ERROR:Unknown denormal policy: "
+                                 << optarguments << endl;
+                            exit(1);
+                        }
+                        break;
+                    case 'w':
+                        exit_with = exit_with_t::fft_wisdom;
+                        break;
+                    case 'c':
+                        GETOP(prewarmbank);
+                        exit_with = exit_with_t::pad_cache;
+                        break;
                 }
                 break;
             case '?':
@@ -498,6 +600,12 @@ int main(int argc, char *argv[])
         }
     }
 
+    denormal::setPolicy(config.cfg.DenormalPolicy ? denormal::POLICY_FLUSH
+                                                  : denormal::POLICY_NOISE);
+    if(config.cfg.DenormalPolicy && !denormal::flushSupported())
+        cerr << "WARNING: This CPU can not flush denormals, "
+             << "falling back to noise injection" << endl;
+    padcache::setLimit((uint64_t)config.cfg.PadCacheSize << 20);
     synth.alias();
 
     switch (exit_with)
@@ -531,8 +639,48 @@ int main(int argc, char *argv[])
                  << "  -e , --exec-after-init\t\t Run post-initialization script\n"
                  << "  -d , --dump-oscdoc=FILE\t\t Dump oscdoc xml to file\n"
                  << "  -D , --dump-json-schema=FILE\t\t Dump osc schema (.json) to file\n"
+                 << "  -T N, --render-threads=N\t\t Render parts on N extra threads\n"
+                 << "\t\t\t\t\t (single threaded with 0)\n"
+                 << "  --render=FILE\t\t\t Render a MIDI file offline, as fast as\n"
+                 << "\t\t\t\t\t possible (use with --load and --out)\n"
+                 << "  --out=FILE\t\t\t\t WAV file written by --render\n"
+                 << "  --stems\t\t\t\t Render every part to its own WAV file\n"
+                 << "  --render-jobs=N\t\t\t Threads rendering stems\n"
+                 << "\t\t\t\t\t (one per core with 0)\n"
+                 << "  --denormal-policy=flush|noise\t Flush denormals to zero or\n"
+                 << "\t\t\t\t\t inject noise against them\n"
+                 << "  --fft-wisdom\t\t\t Measure the FFT plans of every size\n"
+                 << "\t\t\t\t\t in use and save them for later runs\n"
+                 << "  --pad-cache=BANKDIR\t\t Generate the PADsynth samples of\n"
+                 << "\t\t\t\t\t a bank into the on disk cache\n"
                  << endl;
             break;
+        case exit_with_t::fft_wisdom:
+        {
+            const std::string file = fft::wisdomFile();
+            if(file.empty()) {
+                cerr << "ERROR: No directory to save the FFT wisdom in" << endl;
+                return 1;
+            }
+            fft::loadWisdom(file);
+            for(int size = fft::MIN_SIZE; size <= fft::MAX_SIZE; size *= 2) {
+                cout << "Measuring FFT size " << size << endl;
+                fft::measure(size);
+            }
+            if(!fft::saveWisdom(file)) {
+                cerr << "ERROR: Could not write " << file << endl;
+                return 1;
+            }
+            cout << "FFT wisdom saved to " << file << endl;
+            break;
+        }
+        case exit_with_t::pad_cache:
+            if(!config.cfg.PadCacheSize) {
+                cerr << "ERROR: The PADsynth cache is disabled" << endl;
+                return 1;
+            }
+            fft::loadWisdom(fft::wisdomFile());
+            return prewarmPadCache(prewarmbank, synth, config);
         case exit_with_t::list_inputs:
         case exit_with_t::list_outputs:
         {
@@ -555,6 +703,19 @@ int main(int argc, char *argv[])
     if(exit_with != exit_with_t::dont_exit)
         return 0;
 
+    //Measured FFT plans of earlier --fft-wisdom runs, if any
+    fft::loadWisdom(fft::wisdomFile());
+
+    //Offline rendering needs neither Nio nor MiddleWare
+    if(!render.midifile.empty()) {
+        if(render.outfile.empty()) {
+            cerr << "ERROR: --render needs an output file (--out=FILE)" << endl;
+            return 1;
+        }
+        render.loadfile = loadfile;
+        return renderOffline(render, synth, &config);
+    }
+
     cerr.precision(1);
     cerr << std::fixed;
     cerr << "\nSample Rate = \t\t" << synth.samplerate << endl;